@@ -0,0 +1,183 @@
+#include <core/replay_log.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+
+/**
+ * Records replay logs of the default gas and verifies them against this build, reporting
+ * the first step and Particles that differ. Logs recorded by one build (compiler, flags,
+ * platform) and verified by another check cross-build reproducibility, and logs recorded
+ * and verified with different thread counts check that threading leaves trajectories alone.
+ *
+ * A recorded run adds, removes and heats Particles and shrinks the box partway through.
+ * A 2D run also has a circle obstacle, a wall and a piston. Verifying replays all of it.
+ *
+ * Usage: replay-verifier record <log> <steps> [seed] [options]
+ *        replay-verifier verify <log> [options]
+ * Options: --threads <n>       Run the per-particle passes on n threads, 0 for one per
+ *                              hardware thread. Serial without it.
+ *          --dimensions <2|3>  Record a 2D or 3D gas, 2 by default
+ *          --particles <n>     Record n Particles at the default density instead of 40,
+ *                              e.g. 20000 to run the parallel passes
+ *          --skin <s>          Verify with neighbor skin s, 0 for brute force
+ */
+
+namespace {
+
+struct Options {
+  std::unique_ptr<idealgas::ThreadPool> thread_pool;
+  int dimensions = 2;
+  size_t particle_count = 40;
+  const char* skin = nullptr;
+};
+
+/**
+ * Reads the options after the positional arguments
+ * @return True if every option was known and had a value
+ */
+bool ParseOptions(int argc, char** argv, int first, Options& options) {
+  for (int i = first; i < argc; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    if (std::strcmp(argv[i], "--threads") == 0) {
+      options.thread_pool.reset(new idealgas::ThreadPool(std::strtoul(argv[i + 1], nullptr, 10)));
+    } else if (std::strcmp(argv[i], "--dimensions") == 0) {
+      options.dimensions = int(std::strtol(argv[i + 1], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--particles") == 0) {
+      options.particle_count = std::strtoul(argv[i + 1], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--skin") == 0) {
+      options.skin = argv[i + 1];
+    } else {
+      return false;
+    }
+  }
+  return options.dimensions == 2 || options.dimensions == 3;
+}
+
+/**
+ * Adds a circle obstacle in the middle of a 2D box, a wall across its top left corner
+ * and a piston pushing in from its right wall
+ */
+void AddStaticGeometry(idealgas::GasContainer& container) {
+  glm::dvec2 corner(container.GetTopLeftCorner());
+  glm::dvec2 size(container.GetBoxSize());
+  idealgas::StaticGeometry static_geometry;
+  static_geometry.AddCircle(corner + size * 0.5, size.x * 0.05);
+  static_geometry.AddSegment(corner + glm::dvec2(size.x * 0.1, 0),
+                             corner + glm::dvec2(0, size.y * 0.1));
+  idealgas::Piston piston;
+  piston.start = corner + glm::dvec2(size.x * 0.95, size.y * 0.25);
+  piston.end = corner + glm::dvec2(size.x * 0.95, size.y * 0.75);
+  piston.velocity = glm::dvec2(-0.5, 0);
+  piston.travel = size.x * 0.2;
+  static_geometry.AddPiston(piston);
+  container.SetStaticGeometry(static_geometry);
+}
+
+template <int D>
+int Record(const char* path, size_t steps, unsigned int seed, const Options& options) {
+  // The default gas scaled to the particle count, with the box scaled to keep its density
+  double scale = double(options.particle_count) / 40;
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 20, 100, size_t(std::round(20 * scale))),
+          idealgas::ParticleConfig(1, "blue", 10, 50, size_t(std::round(10 * scale))),
+          idealgas::ParticleConfig(2, "green", 10, 500, size_t(std::round(5 * scale))),
+          idealgas::ParticleConfig(3, "yellow", 20, 500, size_t(std::round(5 * scale)))};
+  glm::vec<D, double> box_size(600 * std::pow(scale, 1.0 / D));
+  idealgas::BasicGasContainer<D> container(particle_configs, glm::vec<D, float>(100),
+                                           box_size, seed, options.thread_pool.get());
+  if constexpr (D == 2) {
+    AddStaticGeometry(container);
+  }
+
+  idealgas::BasicReplayRecorder<D> recorder(path, container);
+  for (size_t step = 1; step <= steps; step++) {
+    std::vector<idealgas::BasicReplayEdit<D>> edits;
+    if (step == steps / 4) {
+      idealgas::ParticleConfig added = particle_configs[1];
+      added.amount = added.amount / 4 + 1;
+      edits.push_back(idealgas::BasicReplayEdit<D>::AddParticles(added));
+    } else if (step == steps / 2) {
+      edits.push_back(idealgas::BasicReplayEdit<D>::ScaleVelocities(1.1));
+      edits.push_back(idealgas::BasicReplayEdit<D>::RemoveParticles(
+              0, particle_configs[0].amount / 8 + 1));
+    } else if (step == steps * 3 / 4) {
+      edits.push_back(idealgas::BasicReplayEdit<D>::ResizeBox(box_size * 0.9));
+    }
+    for (const idealgas::BasicReplayEdit<D>& edit : edits) {
+      if (edit.Apply(container)) {
+        recorder.RecordEdit(edit);
+      }
+    }
+
+    container.Update();
+    recorder.RecordStep(container.GetParticles());
+  }
+  if (!recorder.IsGood()) {
+    std::fprintf(stderr, "could not write %s\n", path);
+    return 1;
+  }
+  std::printf("recorded %zu steps of %zu particles in %dD with seed %u\n", steps,
+              container.GetParticles().size(), D, seed);
+  return 0;
+}
+
+template <int D>
+int Verify(const idealgas::BasicReplayLog<D>& log, const Options& options) {
+  idealgas::BasicGasContainer<D> container = log.CreateContainer(options.thread_pool.get());
+  if (options.skin != nullptr) {
+    container.SetNeighborSkin(std::strtod(options.skin, nullptr));
+  }
+  idealgas::ReplayDivergence divergence = log.Verify(container);
+  if (!divergence.diverged) {
+    std::printf("reproduced all %zu steps and %zu edits in %dD\n", log.GetStepCount() - 1,
+                log.GetEditCount(), D);
+    return 0;
+  }
+
+  std::printf("diverged at step %zu, particles %zu to %zu: %s\n", divergence.step,
+              divergence.first_particle, divergence.last_particle, divergence.reason.c_str());
+  return 2;
+}
+
+int Verify(const char* path, const Options& options) {
+  idealgas::ReplayLog log;
+  if (log.Read(path)) {
+    return Verify(log, options);
+  }
+  idealgas::ReplayLog3D log_3d;
+  if (log_3d.Read(path)) {
+    return Verify(log_3d, options);
+  }
+  std::fprintf(stderr, "could not read %s\n", path);
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (argc >= 4 && std::strcmp(argv[1], "record") == 0) {
+    bool has_seed = argc > 4 && std::strncmp(argv[4], "--", 2) != 0;
+    unsigned int seed = has_seed ? unsigned(std::strtoul(argv[4], nullptr, 10))
+                                 : unsigned(time(0));
+    size_t steps = std::strtoul(argv[3], nullptr, 10);
+    if (ParseOptions(argc, argv, has_seed ? 5 : 4, options)) {
+      return options.dimensions == 3 ? Record<3>(argv[2], steps, seed, options)
+                                     : Record<2>(argv[2], steps, seed, options);
+    }
+  } else if (argc >= 3 && std::strcmp(argv[1], "verify") == 0 &&
+             ParseOptions(argc, argv, 3, options)) {
+    return Verify(argv[2], options);
+  }
+
+  std::fprintf(stderr, "usage: %s record <log> <steps> [seed] [--threads n] [--dimensions 2|3]"
+                       " [--particles n]\n"
+                       "       %s verify <log> [--threads n] [--skin s]\n", argv[0], argv[0]);
+  return 1;
+}
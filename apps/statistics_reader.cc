@@ -0,0 +1,85 @@
+#include <core/statistics_log.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * Prints the schema and row groups of a statistics log, or dumps its rows as CSV.
+ * List columns are spread over one CSV column per value, named column[i].
+ *
+ * Usage: statistics-reader <log> [csv]
+ */
+
+namespace {
+
+const char* GetTypeName(idealgas::ColumnSchema::Type type) {
+  return type == idealgas::ColumnSchema::kUInt64 ? "uint64" : "float64";
+}
+
+void PrintSummary(const idealgas::StatisticsReader& reader) {
+  std::printf("%zu rows in %zu row groups\n", reader.GetRowCount(), reader.GetRowGroupCount());
+  for (const idealgas::ColumnSchema& column : reader.GetSchema()) {
+    if (column.width == 1) {
+      std::printf("  %-24s %s\n", column.name.c_str(), GetTypeName(column.type));
+    } else {
+      std::printf("  %-24s %s[%u]\n", column.name.c_str(), GetTypeName(column.type),
+                  column.width);
+    }
+  }
+}
+
+void PrintCsv(const idealgas::StatisticsReader& reader) {
+  const std::vector<idealgas::ColumnSchema>& schema = reader.GetSchema();
+  const char* separator = "";
+  for (const idealgas::ColumnSchema& column : schema) {
+    for (uint32_t i = 0; i < column.width; i++) {
+      if (column.width == 1) {
+        std::printf("%s%s", separator, column.name.c_str());
+      } else {
+        std::printf("%s%s[%u]", separator, column.name.c_str(), i);
+      }
+      separator = ",";
+    }
+  }
+  std::printf("\n");
+
+  for (size_t group = 0; group < reader.GetRowGroupCount(); group++) {
+    for (size_t row = 0; row < reader.GetRowCount(group); row++) {
+      separator = "";
+      for (size_t column = 0; column < schema.size(); column++) {
+        for (uint32_t i = 0; i < schema[column].width; i++) {
+          size_t index = row * schema[column].width + i;
+          if (schema[column].type == idealgas::ColumnSchema::kUInt64) {
+            std::printf("%s%" PRIu64, separator, reader.GetUInt64Column(group, column)[index]);
+          } else {
+            std::printf("%s%.17g", separator, reader.GetFloat64Column(group, column)[index]);
+          }
+          separator = ",";
+        }
+      }
+      std::printf("\n");
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2 || (argc > 2 && std::strcmp(argv[2], "csv") != 0)) {
+    std::fprintf(stderr, "usage: %s <log> [csv]\n", argv[0]);
+    return 1;
+  }
+
+  idealgas::StatisticsReader reader;
+  if (!reader.Read(argv[1])) {
+    std::fprintf(stderr, "could not read %s\n", argv[1]);
+    return 1;
+  }
+  if (argc > 2) {
+    PrintCsv(reader);
+  } else {
+    PrintSummary(reader);
+  }
+  return 0;
+}
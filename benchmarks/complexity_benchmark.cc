@@ -0,0 +1,109 @@
+#include <core/gas_container.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+/**
+ * Scaling curve of the step time over systems of 1e3 particles up to a maximum, growing
+ * tenfold, at constant density in 2D and 3D. The exponent b of the step time growing as
+ * N^b is fitted between each pair of neighbouring sizes, and the run fails if any exceeds
+ * kMaxExponent, halfway between the near linear neighbour list and a quadratic search.
+ *
+ * Usage: complexity-benchmark [max particles] [csv path]
+ */
+
+namespace {
+
+const double kMaxExponent = 1.5;
+const size_t kMinParticleCount = 1000;
+const size_t kTimedSteps = 9;
+
+struct ScalingPoint {
+  size_t particle_count;
+  // Median of the timed steps, which all follow a first step that builds the neighbour list
+  double step_microseconds;
+  double candidate_checks_per_particle;
+};
+
+template <int D>
+ScalingPoint MeasureStep(size_t particle_count) {
+  // Ten radii between neighbours along each axis
+  double box_size = 10 * std::pow(double(particle_count), 1.0 / D);
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, ci::Color(1, 0, 0), 1, 100, particle_count / 2),
+          idealgas::ParticleConfig(1, ci::Color(0, 0, 1), 1, 50, particle_count / 2)};
+  idealgas::BasicGasContainer<D> container(particle_configs, glm::vec<D, float>(0),
+                                           glm::vec<D, double>(box_size), 0);
+  container.Update();
+
+  std::vector<double> step_microseconds;
+  for (size_t step = 0; step < kTimedSteps; step++) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    container.Update();
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    step_microseconds.push_back(elapsed.count());
+  }
+  std::sort(step_microseconds.begin(), step_microseconds.end());
+
+  ScalingPoint point;
+  point.particle_count = particle_count;
+  point.step_microseconds = step_microseconds[kTimedSteps / 2];
+  point.candidate_checks_per_particle =
+          double(container.GetNeighborListStats().candidate_checks) / particle_count;
+  return point;
+}
+
+/**
+ * Measures and prints the curve of one dimension
+ * @return False if the step time grew faster than N^kMaxExponent between two sizes
+ */
+template <int D>
+bool MeasureCurve(size_t max_particle_count, std::ofstream& csv) {
+  std::printf("%dD\n%10s %14s %12s %10s\n", D, "particles", "us/step", "checks/N", "exponent");
+  bool near_linear = true;
+  ScalingPoint previous {};
+  for (size_t particle_count = kMinParticleCount; particle_count <= max_particle_count;
+       particle_count *= 10) {
+    ScalingPoint point = MeasureStep<D>(particle_count);
+    if (previous.particle_count == 0) {
+      std::printf("%10zu %14.1f %12.2f\n", point.particle_count, point.step_microseconds,
+                  point.candidate_checks_per_particle);
+    } else {
+      double exponent = std::log(point.step_microseconds / previous.step_microseconds) /
+                        std::log(double(point.particle_count) / previous.particle_count);
+      near_linear = near_linear && exponent <= kMaxExponent;
+      std::printf("%10zu %14.1f %12.2f %10.2f%s\n", point.particle_count,
+                  point.step_microseconds, point.candidate_checks_per_particle, exponent,
+                  exponent <= kMaxExponent ? "" : "  regressed");
+    }
+    if (csv.is_open()) {
+      csv << D << "," << point.particle_count << "," << point.step_microseconds << ","
+          << point.candidate_checks_per_particle << "\n";
+    }
+    previous = point;
+  }
+  return near_linear;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t max_particle_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  std::ofstream csv;
+  if (argc > 2) {
+    csv.open(argv[2]);
+    csv << "dimensions,particles,step_microseconds,candidate_checks_per_particle\n";
+  }
+
+  bool near_linear = MeasureCurve<2>(max_particle_count, csv);
+  near_linear = MeasureCurve<3>(max_particle_count, csv) && near_linear;
+  if (!near_linear) {
+    std::printf("step time grew faster than N^%.1f\n", kMaxExponent);
+    return 1;
+  }
+  return 0;
+}
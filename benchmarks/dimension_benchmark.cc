@@ -0,0 +1,58 @@
+#include <core/gas_container.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Step time of the same dilute gas in 2D and in 3D, with the neighbour list and with the
+ * brute force pair loop. Both boxes are sized for the same mean spacing between Particles.
+ *
+ * Usage: dimension-benchmark [particles] [steps]
+ */
+
+namespace {
+
+template <int D>
+double MeasureStepMicroseconds(size_t particle_count, size_t step_count, double skin) {
+  // Ten radii between neighbours along each axis
+  double box_size = 10 * std::pow(double(particle_count), 1.0 / D);
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, ci::Color(1, 0, 0), 1, 100, particle_count / 2),
+          idealgas::ParticleConfig(1, ci::Color(0, 0, 1), 1, 50, particle_count / 2)};
+  idealgas::BasicGasContainer<D> container(particle_configs, glm::vec<D, float>(0),
+                                           glm::vec<D, double>(box_size), 0);
+  container.SetNeighborSkin(skin);
+  container.SetTiledKernelThreshold(0);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < step_count; step++) {
+    container.Update();
+  }
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / step_count;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t particle_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  size_t step_count = std::max<size_t>(1, argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50);
+
+  std::printf("%zu particles, %zu steps, Particle is %zu bytes in 2D and %zu bytes in 3D\n",
+              particle_count, step_count, sizeof(idealgas::Particle),
+              sizeof(idealgas::Particle3D));
+  std::printf("%10s %14s %14s\n", "", "2D us/step", "3D us/step");
+  std::printf("%10s %14.1f %14.1f\n", "neighbors",
+              MeasureStepMicroseconds<2>(particle_count, step_count, 2),
+              MeasureStepMicroseconds<3>(particle_count, step_count, 2));
+
+  // The pair loop is quadratic, so it only runs on a slice of the gas
+  size_t brute_force_count = std::min<size_t>(particle_count, 4000);
+  std::printf("%10s %14.1f %14.1f  (%zu particles)\n", "brute",
+              MeasureStepMicroseconds<2>(brute_force_count, step_count, 0),
+              MeasureStepMicroseconds<3>(brute_force_count, step_count, 0),
+              brute_force_count);
+  return 0;
+}
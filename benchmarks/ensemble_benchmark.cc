@@ -0,0 +1,72 @@
+#include <core/ensemble.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Steps an ensemble of default sized replicas and reports replica steps per second
+ * for an increasing number of threads, against the same replicas as separate GasContainers
+ * each owning its Particles and scratch
+ *
+ * Usage: ensemble-benchmark [replicas] [steps]
+ */
+
+namespace {
+
+/**
+ * Steps one GasContainer per replica, each on its own chunk of a ThreadPool
+ * @return Replica steps per second
+ */
+double StepSeparateContainers(const std::vector<idealgas::ParticleConfig>& particle_configs,
+                              size_t replica_count, size_t steps, size_t thread_count) {
+  idealgas::ThreadPool thread_pool(thread_count);
+  std::vector<idealgas::GasContainer> replicas;
+  replicas.reserve(replica_count);
+  for (size_t i = 0; i < replica_count; i++) {
+    replicas.emplace_back(particle_configs, glm::vec2(0, 0), 600, 600, (unsigned int) i);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  thread_pool.ParallelFor(0, replica_count, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      for (size_t step = 0; step < steps; step++) {
+        replicas[i].Update();
+      }
+    }
+  });
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() > 0 ? replica_count * steps / elapsed.count() : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t replica_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  size_t steps = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+
+  // The default Simulation particle settings
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 20, 100, 20),
+          idealgas::ParticleConfig(1, "blue", 10, 50, 10),
+          idealgas::ParticleConfig(2, "green", 10, 500, 5),
+          idealgas::ParticleConfig(3, "yellow", 20, 500, 5)};
+
+  std::printf("%zu replicas, %zu steps\n", replica_count, steps);
+  std::printf("%8s %20s %20s %16s %18s\n", "threads", "replica steps/sec",
+              "separate containers", "mean energy", "standard error");
+
+  size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+    idealgas::Ensemble ensemble(particle_configs, 600, 600, replica_count, 0, thread_count);
+    ensemble.Update(steps);
+    idealgas::EnsembleObservables observables = ensemble.Aggregate(8, 0.5);
+    double separate_steps_per_second = StepSeparateContainers(particle_configs, replica_count,
+                                                              steps, thread_count);
+    std::printf("%8zu %20.1f %20.1f %16.3f %18.3f\n", thread_count,
+                ensemble.GetReplicaStepsPerSecond(), separate_steps_per_second,
+                observables.mean_kinetic_energy, observables.kinetic_energy_standard_error);
+  }
+  return 0;
+}
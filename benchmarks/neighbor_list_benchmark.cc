@@ -0,0 +1,53 @@
+#include <core/gas_container.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Compares brute force pair checks with Verlet neighbour lists of several skins,
+ * reporting steps per second and how often the list was rebuilt
+ *
+ * Usage: neighbor-list-benchmark [steps]
+ */
+
+namespace {
+
+double MeasureStepsPerSecond(idealgas::GasContainer& container, size_t steps) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < steps; step++) {
+    container.Update();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return steps / elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t steps = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  const double kSkins[] = {0, 5, 10, 20, 40};
+
+  std::printf("%10s %8s %14s %14s %18s\n", "particles", "skin", "steps/sec",
+              "rebuild rate", "pairs per particle");
+  for (size_t particle_count : {100, 1000, 4000}) {
+    // Keep the default density of 40 particles in a 600x600 box
+    double box_size = 600 * std::sqrt(particle_count / 40.0);
+    std::vector<idealgas::ParticleConfig> particle_configs {
+            idealgas::ParticleConfig(0, "red", 20, 100, particle_count / 2),
+            idealgas::ParticleConfig(1, "blue", 10, 50, particle_count / 2)};
+
+    for (double skin : kSkins) {
+      idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), box_size, box_size, 0);
+      container.SetNeighborSkin(skin);
+      container.SetTiledKernelThreshold(0);
+      double steps_per_second = MeasureStepsPerSecond(container, steps);
+
+      const idealgas::NeighborListStats& stats = container.GetNeighborListStats();
+      std::printf("%10zu %8.1f %14.1f %14.3f %18.2f\n", particle_count, skin, steps_per_second,
+                  stats.GetRebuildRate(), double(stats.pair_count) / particle_count);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,73 @@
+#include <core/gas_container.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Step time of the tiled brute force kernel and of the neighbour list over growing gases
+ * at the density of the default Simulation, 40 Particles in a 600 wide box, and the first
+ * size at which the neighbour list is faster. GasContainer uses the tiled kernel below
+ * that crossover.
+ *
+ * Usage: pair-kernel-benchmark [steps]
+ */
+
+namespace {
+
+// Finer around the crossover
+const std::vector<size_t> kParticleCounts {100, 200, 400, 560, 640, 720, 800, 1600, 3200};
+
+template <int D>
+double MeasureStepMicroseconds(size_t particle_count, size_t step_count, bool tiled) {
+  // The default particle types, in the same proportions
+  double box_size = 600 * std::pow(particle_count / 40.0, 1.0 / D);
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 20, 100, particle_count / 2),
+          idealgas::ParticleConfig(1, "blue", 10, 50, particle_count / 4),
+          idealgas::ParticleConfig(2, "green", 10, 500, particle_count / 8),
+          idealgas::ParticleConfig(3, "yellow", 20, 500, particle_count / 8)};
+  idealgas::BasicGasContainer<D> container(particle_configs, glm::vec<D, float>(0),
+                                           glm::vec<D, double>(box_size), 0);
+  container.SetTiledKernelThreshold(tiled ? particle_count + 1 : 0);
+
+  // The first steps settle the neighbour list's rebuild rate
+  for (size_t step = 0; step < step_count / 10; step++) {
+    container.Update();
+  }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < step_count; step++) {
+    container.Update();
+  }
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / step_count;
+}
+
+template <int D>
+void MeasureCrossover(size_t step_count) {
+  std::printf("%dD\n%10s %14s %14s\n", D, "particles", "tiled us/step", "list us/step");
+  size_t crossover = 0;
+  for (size_t particle_count : kParticleCounts) {
+    double tiled = MeasureStepMicroseconds<D>(particle_count, step_count, true);
+    double listed = MeasureStepMicroseconds<D>(particle_count, step_count, false);
+    std::printf("%10zu %14.1f %14.1f\n", particle_count, tiled, listed);
+    if (crossover == 0 && listed < tiled) {
+      crossover = particle_count;
+    }
+  }
+  if (crossover == 0) {
+    std::printf("the tiled kernel is faster up to %zu particles\n", kParticleCounts.back());
+  } else {
+    std::printf("the neighbour list is faster from %zu particles\n", crossover);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t step_count = std::max<size_t>(10, argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200);
+  MeasureCrossover<2>(step_count);
+  MeasureCrossover<3>(step_count);
+  return 0;
+}
@@ -0,0 +1,69 @@
+#include <core/neighbor_list.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * Builds neighbour lists for mixtures of radius 1 Particles with a few large ones, for
+ * increasing radius ratios, comparing a single uniform grid with the multi-level grid.
+ * Small and large Particles each cover a tenth of the box.
+ *
+ * Usage: polydisperse-benchmark [small particles] [builds]
+ */
+
+namespace {
+
+const double kSkin = 2;
+
+double MeasureBuildMilliseconds(idealgas::NeighborList& neighbor_list,
+                                const std::vector<idealgas::Particle>& particles,
+                                size_t builds) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t build = 0; build < builds; build++) {
+    neighbor_list.Build(particles);
+  }
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / builds;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t small_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  size_t builds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+  const double kPi = 3.14159265358979323846;
+  double box_size = std::sqrt(small_count * kPi / 0.1);
+
+  std::printf("%zu small particles, box %.0f, skin %.0f\n", small_count, box_size, kSkin);
+  std::printf("%8s %8s %8s %14s %16s %14s %16s\n", "ratio", "large", "levels", "uniform ms",
+              "uniform checks", "multi ms", "multi checks");
+
+  for (double ratio : {1.0, 4.0, 16.0, 64.0, 200.0}) {
+    size_t large_count = std::max<size_t>(1, size_t(0.1 * box_size * box_size /
+                                                    (kPi * ratio * ratio)));
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> coordinate(0, box_size);
+    std::vector<idealgas::Particle> particles;
+    for (size_t i = 0; i < small_count + large_count; i++) {
+      double radius = i < small_count ? 1 : ratio;
+      particles.emplace_back(i < small_count ? 0 : 1,
+                             glm::vec2(coordinate(generator), coordinate(generator)),
+                             glm::vec2(0, 0), radius, radius * radius);
+    }
+
+    idealgas::NeighborList uniform(kSkin, 1);
+    idealgas::NeighborList multi_level(kSkin);
+    double uniform_milliseconds = MeasureBuildMilliseconds(uniform, particles, builds);
+    double multi_level_milliseconds = MeasureBuildMilliseconds(multi_level, particles, builds);
+
+    std::printf("%8.0f %8zu %8zu %14.2f %16zu %14.2f %16zu\n", ratio, large_count,
+                multi_level.GetStats().level_count, uniform_milliseconds,
+                uniform.GetStats().candidate_checks, multi_level_milliseconds,
+                multi_level.GetStats().candidate_checks);
+  }
+  return 0;
+}
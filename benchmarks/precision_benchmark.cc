@@ -0,0 +1,104 @@
+#include <core/observables.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * Compares float and double particle state on the same brute-force workload,
+ * reporting throughput alongside the energy and momentum error of each
+ *
+ * Usage: precision-benchmark [particles] [steps]
+ */
+
+namespace {
+
+const double kBoxSize = 600;
+const double kMaxSpeedFactor = 0.2;
+const unsigned int kSeed = 2020;
+
+struct BenchmarkResult {
+  double steps_per_second;
+  double energy_drift;
+  double momentum_error;
+};
+
+template <typename T>
+std::vector<idealgas::BasicParticle<T>> GenerateParticles(size_t count) {
+  typedef typename idealgas::BasicParticle<T>::Vec Vec;
+
+  // Same seed for every precision, so both runs start from the same state
+  std::mt19937 generator(kSeed);
+  std::uniform_real_distribution<double> position(0, kBoxSize);
+  std::vector<idealgas::BasicParticle<T>> particles;
+  particles.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    // Alternate between the default small and large particle types
+    double radius = (i % 2 == 0) ? 10 : 20;
+    double mass = (i % 2 == 0) ? 50 : 100;
+    std::uniform_real_distribution<double> velocity(-radius * kMaxSpeedFactor,
+                                                    radius * kMaxSpeedFactor);
+    particles.emplace_back(i % 2, Vec(position(generator), position(generator)),
+                           Vec(velocity(generator), velocity(generator)),
+                           T(radius), T(mass));
+  }
+  return particles;
+}
+
+template <typename T>
+BenchmarkResult RunBenchmark(size_t count, size_t steps) {
+  std::vector<idealgas::BasicParticle<T>> particles = GenerateParticles<T>(count);
+  T initial_energy = idealgas::ComputeKineticEnergy(particles);
+  double momentum_error = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < steps; step++) {
+    for (idealgas::BasicParticle<T>& particle : particles) {
+      particle.ProcessMovement();
+      particle.ProcessXWallCollision(0);
+      particle.ProcessXWallCollision(T(kBoxSize));
+      particle.ProcessYWallCollision(0);
+      particle.ProcessYWallCollision(T(kBoxSize));
+    }
+
+    // Walls do not conserve momentum, so only the pair collisions are measured
+    glm::vec<2, T> momentum_before = idealgas::ComputeMomentum(particles);
+    for (size_t i = 0; i < particles.size(); i++) {
+      for (size_t j = i + 1; j < particles.size(); j++) {
+        if (idealgas::CheckCollision(particles[i], particles[j])) {
+          idealgas::CollideParticles(particles[i], particles[j]);
+        }
+      }
+    }
+    glm::vec<2, T> momentum_after = idealgas::ComputeMomentum(particles);
+    momentum_error += glm::length(glm::vec<2, double>(momentum_after - momentum_before));
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  BenchmarkResult result;
+  result.steps_per_second = steps / elapsed.count();
+  result.energy_drift = std::abs(double(idealgas::ComputeKineticEnergy(particles)) -
+                                 initial_energy) / initial_energy;
+  result.momentum_error = momentum_error;
+  return result;
+}
+
+void PrintResult(const char* precision, const BenchmarkResult& result) {
+  std::printf("%-8s %14.1f %22.3e %24.3e\n", precision, result.steps_per_second,
+              result.energy_drift, result.momentum_error);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  size_t steps = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+
+  std::printf("%zu particles, %zu steps\n", count, steps);
+  std::printf("%-8s %14s %22s %24s\n", "scalar", "steps/sec",
+              "relative energy drift", "pair momentum error");
+  PrintResult("float", RunBenchmark<float>(count, steps));
+  PrintResult("double", RunBenchmark<double>(count, steps));
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <core/gas_container.h>
+#include <core/speed_distribution.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Strong scaling of the per-particle passes: a fixed system stepped and its speeds counted
+ * on an increasing number of threads, reporting throughput and speedup over one thread.
+ * The full step includes the serial pair collisions, so it scales less than the passes.
+ *
+ * Usage: scaling-benchmark [particles] [steps]
+ */
+
+namespace {
+
+template <typename Function>
+double MeasurePerSecond(size_t repetitions, Function function) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repetitions; i++) {
+    function();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return repetitions / elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t particle_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+  size_t steps = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+
+  // A dilute gas, so the serial pair pass does not hide the scaling of the rest
+  double box_size = 10 * std::sqrt(double(particle_count));
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 1, 100, particle_count / 2),
+          idealgas::ParticleConfig(1, "blue", 1, 50, particle_count / 2)};
+
+  std::printf("%zu particles, %zu steps\n", particle_count, steps);
+  std::printf("%8s %12s %10s %14s %10s\n", "threads", "steps/sec", "speedup",
+              "counts/sec", "speedup");
+
+  double serial_steps_per_second = 0;
+  double serial_counts_per_second = 0;
+  size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+    idealgas::ThreadPool thread_pool(thread_count);
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), box_size, box_size, 0);
+    container.SetThreadPool(&thread_pool);
+    container.Update();
+
+    double steps_per_second = MeasurePerSecond(steps, [&]() { container.Update(); });
+    std::vector<idealgas::SpeedDistribution> distributions(
+            particle_configs.size(), idealgas::SpeedDistribution(8, 0.5));
+    double counts_per_second = MeasurePerSecond(steps, [&]() {
+      idealgas::CountSpeeds(container.GetParticles(), distributions, &thread_pool);
+    });
+
+    if (thread_count == 1) {
+      serial_steps_per_second = steps_per_second;
+      serial_counts_per_second = counts_per_second;
+    }
+    std::printf("%8zu %12.1f %10.2f %14.1f %10.2f\n", thread_count, steps_per_second,
+                steps_per_second / serial_steps_per_second, counts_per_second,
+                counts_per_second / serial_counts_per_second);
+  }
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <core/gas_container.h>
+#include <core/speed_distribution.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Time to first step of a large system, broken down by startup stage, serially and on
+ * one thread per hardware thread. The first step includes the first neighbour list build.
+ * Each run is checked against kTargetMilliseconds, which holds for up to
+ * kTargetParticleCount particles, and the benchmark fails if the run on every hardware
+ * thread misses it.
+ *
+ * Usage: startup-benchmark [particles] [types]
+ */
+
+namespace {
+
+const double kTargetMilliseconds = 200;
+const size_t kTargetParticleCount = 1000000;
+
+double MillisecondsSince(std::chrono::steady_clock::time_point* start) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = now - *start;
+  *start = now;
+  return elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t particle_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  size_t type_count = std::max<size_t>(1, argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4);
+
+  // The same dilute gas as the scaling benchmark, split evenly over the types
+  double box_size = 10 * std::sqrt(double(particle_count));
+  std::vector<idealgas::ParticleConfig> particle_configs;
+  for (size_t type = 0; type < type_count; type++) {
+    particle_configs.emplace_back(type, ci::Color(1, 1, 1), 1, 100,
+                                  particle_count / type_count);
+  }
+
+  bool has_target = particle_count <= kTargetParticleCount;
+  std::printf("%zu particles, %zu types\n", particle_count, type_count);
+  std::printf("%8s %10s %12s %12s %12s %12s %8s\n", "threads", "pool ms", "particles ms",
+              "first step ms", "speeds ms", "total ms", "target");
+
+  bool target_met = true;
+  for (size_t thread_count : {size_t(1), size_t(0)}) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point stage_start = start;
+
+    idealgas::ThreadPool thread_pool(thread_count);
+    double pool_milliseconds = MillisecondsSince(&stage_start);
+
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), box_size, box_size, 0,
+                                     &thread_pool);
+    double particle_milliseconds = MillisecondsSince(&stage_start);
+
+    container.Update();
+    double step_milliseconds = MillisecondsSince(&stage_start);
+
+    std::vector<idealgas::SpeedDistribution> distributions(
+            type_count, idealgas::SpeedDistribution(8, 0.5));
+    idealgas::CountSpeeds(container.GetParticles(), distributions, &thread_pool);
+    double speed_milliseconds = MillisecondsSince(&stage_start);
+
+    // Time to first step leaves out the speed histograms, which the first frame draws after it
+    double first_step_milliseconds = pool_milliseconds + particle_milliseconds +
+                                     step_milliseconds;
+    const char* target = "-";
+    if (has_target) {
+      target = first_step_milliseconds <= kTargetMilliseconds ? "met" : "missed";
+    }
+    std::printf("%8zu %10.1f %12.1f %12.1f %12.1f %12.1f %8s\n", thread_pool.GetThreadCount(),
+                pool_milliseconds, particle_milliseconds, step_milliseconds,
+                speed_milliseconds, MillisecondsSince(&start), target);
+    if (thread_count == 0) {
+      target_met = !has_target || first_step_milliseconds <= kTargetMilliseconds;
+    }
+  }
+
+  if (!target_met) {
+    std::printf("time to first step on every hardware thread exceeded %.0f ms\n",
+                kTargetMilliseconds);
+    return 1;
+  }
+  return 0;
+}
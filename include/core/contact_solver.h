@@ -0,0 +1,105 @@
+#pragma once
+
+#include <core/particle_span.h>
+
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * Limits of the iterative ContactSolver
+ */
+struct ContactSolverSettings {
+  // Iteration caps for the velocity and position passes
+  size_t max_velocity_iterations = 16;
+  size_t max_position_iterations = 8;
+  // Stop once no contact changes its relative normal velocity by more than this
+  double velocity_tolerance = 1e-4;
+  // Stop once no pair overlaps by more than this
+  double overlap_tolerance = 0.01;
+  // Fraction of each overlap removed per position iteration
+  double overlap_correction = 0.8;
+};
+
+/**
+ * How the last ContactSolver step went
+ */
+struct ContactSolverStats {
+  size_t contact_count = 0;
+  size_t velocity_iterations = 0;
+  size_t position_iterations = 0;
+  // Largest relative normal velocity change in the final velocity iteration
+  double velocity_residual = 0;
+  // Largest overlap found by the final position iteration
+  double max_overlap = 0;
+};
+
+/**
+ * Resolves every contact of a step together, for dense gases where a Particle
+ * touches several others at once. Elastic impulses are applied contact by contact
+ * (Gauss-Seidel) until they settle, then overlapping pairs are pushed apart.
+ */
+template <int D>
+class BasicContactSolver {
+ public:
+  typedef BasicParticle<Scalar, D> Particle;
+
+  /**
+   * Constructs a ContactSolver
+   * @param settings The iteration limits and tolerances
+   */
+  explicit BasicContactSolver(const ContactSolverSettings& settings = ContactSolverSettings());
+
+  /**
+   * Resolves the contacts among candidate pairs of Particles
+   * @param particles The Particles
+   * @param pairs Candidate pairs of Particle indices; those not touching are ignored
+   */
+  void Solve(ParticleSpan<Particle> particles,
+             const std::vector<std::pair<size_t, size_t>>& pairs);
+
+  /**
+   * @return The bytes allocated for the contacts
+   */
+  size_t GetMemoryUsage() const;
+
+  // Getters
+  const ContactSolverSettings& GetSettings() const;
+  const ContactSolverStats& GetStats() const;
+
+ private:
+  struct Contact {
+    size_t index_a;
+    size_t index_b;
+    // Unit vector from b to a
+    typename Particle::Vec normal;
+    // Share of a relative velocity change taken by a and by b
+    Scalar share_a;
+    Scalar share_b;
+    // Relative normal velocity the contact should end the step with
+    Scalar target_velocity;
+    // Total relative normal velocity change applied so far, never negative
+    Scalar accumulated_change;
+  };
+
+  ContactSolverSettings settings_;
+  ContactSolverStats stats_;
+  std::vector<Contact> contacts_;
+
+  /**
+   * Applies impulses until every contact reaches its target or the cap is hit
+   * @param particles The Particles
+   */
+  void SolveVelocities(ParticleSpan<Particle> particles);
+
+  /**
+   * Pushes overlapping pairs apart until the overlap is within tolerance or the cap is hit
+   * @param particles The Particles
+   */
+  void SolvePositions(ParticleSpan<Particle> particles);
+};
+
+typedef BasicContactSolver<2> ContactSolver;
+typedef BasicContactSolver<3> ContactSolver3D;
+
+}  // namespace idealgas
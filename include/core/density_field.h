@@ -0,0 +1,76 @@
+#pragma once
+
+#include <core/particle.h>
+#include <core/thread_pool.h>
+
+namespace idealgas {
+
+/**
+ * Particle counts and kinetic energy binned over a grid covering the container,
+ * for drawing systems too large to draw one circle per Particle
+ */
+class DensityField {
+ public:
+  /**
+   * Constructs an empty DensityField
+   * @param columns The number of cells across
+   * @param rows The number of cells down
+   * @param type_count The number of particle types
+   */
+  DensityField(size_t columns, size_t rows, size_t type_count);
+
+  /**
+   * Bins every Particle into the cell holding its center. Particles outside
+   * the container are binned into the nearest edge cell, and 3D Particles are
+   * binned by their x and y coordinates.
+   * @param particles The Particles, of 2 or 3 dimensions
+   * @param top_left_corner The coordinate of the top left corner of the container
+   * @param box_width The width of the container
+   * @param box_height The height of the container
+   * @param thread_pool The pool binning chunks of Particles into partial grids
+   */
+  template <int D>
+  void Build(const std::vector<BasicParticle<Scalar, D>>& particles,
+             const glm::vec2& top_left_corner, double box_width, double box_height,
+             ThreadPool& thread_pool);
+
+  // Getters
+  size_t GetColumns() const;
+  size_t GetRows() const;
+  size_t GetTypeCount() const;
+  size_t GetCount(size_t column, size_t row) const;
+  size_t GetTypeCount(size_t column, size_t row, size_t type) const;
+  size_t GetMaxCount() const;
+
+  /**
+   * @return The temperature kT of the Particles in a cell, their mean kinetic energy over D / 2
+   */
+  double GetTemperature(size_t column, size_t row) const;
+
+  /**
+   * @return The temperature kT of every Particle binned, the reference for cell temperatures
+   */
+  double GetMeanTemperature() const;
+
+  /**
+   * @return The bytes allocated for the cells and the partial grids
+   */
+  size_t GetMemoryUsage() const;
+
+ private:
+  size_t columns_;
+  size_t rows_;
+  size_t type_count_;
+  size_t max_count_;
+  double mean_temperature_;
+  std::vector<size_t> counts_;
+  // Count of each type in a cell at [cell * type_count_ + type]
+  std::vector<size_t> type_counts_;
+  // Kinetic energy over D / 2, summed over the Particles of each cell
+  std::vector<double> energies_;
+  // One partial grid per chunk of Particles, chunk after chunk, kept between builds
+  std::vector<size_t> partial_type_counts_;
+  std::vector<double> partial_energies_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <core/gas_container.h>
+#include <core/particle_span.h>
+#include <core/speed_distribution.h>
+#include <core/thread_pool.h>
+
+namespace idealgas {
+
+/**
+ * Observables merged over every replica of an Ensemble
+ */
+struct EnsembleObservables {
+  // One merged speed distribution per particle type
+  std::vector<SpeedDistribution> speed_distributions;
+  double mean_kinetic_energy;
+  double kinetic_energy_standard_error;
+};
+
+/**
+ * Many independent gases with the same settings and different seeds, stepped together on a
+ * work stealing ThreadPool.
+ *
+ * The Particles of every replica are packed into one array owned by the Ensemble, each
+ * replica an offset and count into it, so stepping them walks memory in order instead of
+ * chasing one allocation per replica. Replicas are split into chunks of neighbouring ranges,
+ * and each chunk is stepped by its own scratch GasContainer, which holds no Particles and
+ * reuses one neighbour list and set of kernel buffers for every replica in the chunk.
+ * A replica steps exactly as a GasContainer constructed with its seed would.
+ */
+class Ensemble {
+ public:
+  /**
+   * Constructs an Ensemble of replicas seeded base_seed, base_seed + 1, ...
+   * @param particle_configs The settings and amount of each type of Particle
+   * @param box_width The width of every gas container
+   * @param box_height The height of every gas container
+   * @param replica_count The number of replicas
+   * @param base_seed The seed of the first replica
+   * @param thread_count The number of worker threads, 0 for one per hardware thread
+   */
+  Ensemble(const std::vector<ParticleConfig>& particle_configs,
+           double box_width, double box_height,
+           size_t replica_count, unsigned int base_seed, size_t thread_count = 0);
+
+  /**
+   * Advances every replica by a number of steps
+   * @param steps The number of steps
+   */
+  void Update(size_t steps);
+
+  /**
+   * Merges the current state of every replica
+   * @param speed_ticks The number of speed bins
+   * @param speed_interval The width of each speed bin
+   * @return The merged observables
+   */
+  EnsembleObservables Aggregate(size_t speed_ticks, double speed_interval) const;
+
+  /**
+   * @param replica The index of the replica
+   * @return The Particles of the replica, valid until the next Update
+   */
+  ParticleSpan<const Particle> GetReplicaParticles(size_t replica) const;
+
+  // Getters
+  size_t GetReplicaCount() const;
+  size_t GetThreadCount() const;
+
+  /**
+   * @return The throughput of the last Update, in replica steps per second
+   */
+  double GetReplicaStepsPerSecond() const;
+
+ private:
+  size_t particle_type_count_;
+  // Every replica's Particles, replica r spanning replica_offsets_[r] to replica_offsets_[r + 1]
+  std::vector<Particle> particles_;
+  std::vector<size_t> replica_offsets_;
+  mutable ThreadPool thread_pool_;
+  size_t replicas_per_chunk_;
+  // One scratch GasContainer per chunk of replicas, stepping them on borrowed spans
+  std::vector<GasContainer> workers_;
+  double replica_steps_per_second_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <core/contact_solver.h>
+#include <core/memory_report.h>
+#include <core/neighbor_list.h>
+#include <core/particle.h>
+#include <core/static_geometry.h>
+#include <core/thread_pool.h>
+#include <core/tiled_pair_kernel.h>
+
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+
+#include "cinder/Color.h"
+
+namespace idealgas {
+
+/**
+ * Settings for one type of Particle in a GasContainer
+ */
+struct ParticleConfig {
+  size_t type;
+  ci::Color color;
+  float radius;
+  double mass;
+  size_t amount;
+
+  ParticleConfig(size_t type, ci::Color color, float radius, double mass, size_t amount) :
+          type(type), color(color), radius(radius), mass(mass), amount(amount) {};
+};
+
+/**
+ * Running totals of the collisions resolved by a GasContainer
+ */
+struct CollisionCounts {
+  // Pairs resolved, or contacts solved in dense gas mode
+  size_t particle_collisions = 0;
+  size_t wall_bounces = 0;
+  // Bounces off obstacles and pistons
+  size_t obstacle_bounces = 0;
+};
+
+/**
+ * Headless state of an ideal gas experiment: a set of Particles in a rectangular container
+ * of D dimensions, a box in three dimensions
+ */
+template <int D>
+class BasicGasContainer {
+ public:
+  typedef BasicParticle<Scalar, D> Particle;
+
+  /**
+   * Constructs a GasContainer filled with randomly placed Particles
+   * @param particle_configs The settings and amount of each type of Particle, with types
+   *                         below Particle::kMaxTypeCount
+   * @param top_left_corner The corner of the container with the smallest coordinates
+   * @param box_size The extent of the container along each axis
+   * @param seed The seed of the random initial positions and velocities
+   * @param thread_pool The ThreadPool that initialises and moves large sets of Particles,
+   *                    or nullptr to run serially. See SetThreadPool.
+   * @throws std::invalid_argument If a type is not below Particle::kMaxTypeCount
+   */
+  BasicGasContainer(const std::vector<ParticleConfig>& particle_configs,
+                    const glm::vec<D, float>& top_left_corner,
+                    const glm::vec<D, double>& box_size, unsigned int seed,
+                    ThreadPool* thread_pool = nullptr);
+
+  /**
+   * Constructs a two dimensional GasContainer filled with randomly placed Particles
+   * @param particle_configs The settings and amount of each type of Particle
+   * @param top_left_corner The coordinate of the top left corner of the container
+   * @param box_width The width of the gas container
+   * @param box_height The height of the gas container
+   * @param seed The seed of the random initial positions and velocities
+   * @param thread_pool The ThreadPool that initialises and moves large sets of Particles,
+   *                    or nullptr to run serially. See SetThreadPool.
+   */
+  template <int E = D, typename = typename std::enable_if<E == 2>::type>
+  BasicGasContainer(const std::vector<ParticleConfig>& particle_configs,
+                    const glm::vec2& top_left_corner,
+                    double box_width, double box_height, unsigned int seed,
+                    ThreadPool* thread_pool = nullptr)
+      : BasicGasContainer(particle_configs, top_left_corner,
+                          glm::dvec2(box_width, box_height), seed, thread_pool) {}
+
+  /**
+   * Advances every Particle by one step
+   */
+  void Update();
+
+  /**
+   * Advances Particles stored outside the container by one step, as if they were its own,
+   * with its box, settings and static geometry. Its own Particles are left alone, and its
+   * neighbour list and kernel buffers are reused, so one container can step many sets of
+   * Particles in turn. The neighbour list is rebuilt whenever the set changes.
+   * @param particles The Particles, which must stay inside the box
+   */
+  void Update(ParticleSpan<Particle> particles);
+
+  /**
+   * Sets the skin of the Verlet neighbour list used to find colliding pairs at or above the
+   * tiled kernel threshold, which is left unchanged. A larger skin rebuilds less often but
+   * keeps more pairs in the list.
+   * @param skin The skin distance, or 0 to check every pair with the tiled kernel instead
+   */
+  void SetNeighborSkin(double skin);
+
+  /**
+   * Sets the number of Particles below which every pair is checked by the tiled brute force
+   * kernel instead of the neighbour list. Both resolve the same pairs in the same order.
+   * Independent of the skin, but a skin of 0 always selects the tiled kernel.
+   * @param particle_count The threshold, 0 to always use the neighbour list
+   */
+  void SetTiledKernelThreshold(size_t particle_count);
+
+  /**
+   * @return True if the next step checks every pair with the tiled kernel
+   */
+  bool UsesTiledKernel() const;
+
+  /**
+   * @return How often the neighbour list has been rebuilt
+   */
+  const NeighborListStats& GetNeighborListStats() const;
+
+  /**
+   * Switches between resolving collisions pair by pair as they are found, and
+   * dense gas mode, which collects every contact of a step and resolves them
+   * together with a ContactSolver that also removes overlaps
+   * @param enabled True for dense gas mode
+   * @param settings The iteration limits and tolerances of the ContactSolver
+   */
+  void SetDenseGasMode(bool enabled,
+                       const ContactSolverSettings& settings = ContactSolverSettings());
+
+  /**
+   * Runs the per-particle pass of each step, moving Particles and bouncing them off the
+   * walls, on a ThreadPool. Pair collisions stay serial, so trajectories are identical
+   * for every thread count.
+   * @param thread_pool The ThreadPool, which must outlive its use here, or nullptr to run serially
+   */
+  void SetThreadPool(ThreadPool* thread_pool);
+
+  /**
+   * Adds internal walls, obstacles and pistons, replacing any set before.
+   * Static geometry is two dimensional, so a three dimensional container ignores it.
+   * @param static_geometry The geometry, in container coordinates
+   */
+  void SetStaticGeometry(const StaticGeometry& static_geometry);
+
+  /**
+   * Adds randomly placed Particles between steps, indexing them into the neighbour list
+   * without rebuilding it
+   * @param particle_config The settings and amount of the new Particles
+   * @return True if they were added, false if the type is not below Particle::kMaxTypeCount
+   */
+  bool AddParticles(const ParticleConfig& particle_config);
+
+  /**
+   * Removes the last Particles of a type between steps, keeping the order of the rest
+   * @param type The type of the Particles
+   * @param amount The most Particles to remove
+   * @return The number of Particles removed
+   */
+  size_t RemoveParticles(size_t type, size_t amount);
+
+  /**
+   * Multiplies every velocity by a factor, which multiplies the temperature by its square
+   * @param factor The factor, above 1 to heat the gas and below 1 to cool it
+   */
+  void ScaleVelocities(double factor);
+
+  /**
+   * Moves the walls opposite the top left corner, pushing any Particle left outside
+   * back in against them and cutting static geometry at them. Geometry cut away is
+   * not restored when the box grows again.
+   * @param box_size The new extent of the container along each axis
+   * @return True if the box was resized, false if it would be narrower than the largest
+   *         Particle along some axis
+   */
+  bool ResizeBox(const glm::vec<D, double>& box_size);
+
+  /**
+   * Clears the momentum transferred to every piston, starting a new pressure measurement
+   */
+  void ResetPistonImpulses();
+
+  /**
+   * @return Iteration counts and residuals of the last dense gas step
+   */
+  const ContactSolverStats& GetContactSolverStats() const;
+
+  /**
+   * @return The collisions and wall bounces of every step so far
+   */
+  const CollisionCounts& GetCollisionCounts() const;
+
+  /**
+   * @return The bytes held by the Particles and by each collision subsystem
+   */
+  MemoryReport GetMemoryReport() const;
+
+  // Getters
+  const std::vector<Particle>& GetParticles() const;
+  const StaticGeometry& GetStaticGeometry() const;
+  // The configs the container was constructed from, before any Particles were added or removed
+  const std::vector<ParticleConfig>& GetParticleConfigs() const;
+  unsigned int GetSeed() const;
+  double GetNeighborSkin() const;
+  size_t GetTiledKernelThreshold() const;
+  bool IsDenseGasMode() const;
+  const ContactSolverSettings& GetContactSolverSettings() const;
+  const glm::vec<D, float>& GetTopLeftCorner() const;
+  const glm::vec<D, double>& GetBoxSize() const;
+  double GetBoxWidth() const;
+  double GetBoxHeight() const;
+
+  /**
+   * @return The total kinetic energy of every Particle in the container
+   */
+  Scalar GetKineticEnergy() const;
+
+ private:
+  std::vector<Particle> particles_;
+  std::vector<ParticleConfig> particle_configs_;
+
+  glm::vec<D, float> top_left_corner_;
+  glm::vec<D, double> box_size_;
+  unsigned int seed_;
+  BasicNeighborList<D> neighbor_list_;
+  BasicTiledPairKernel<D> tiled_pair_kernel_;
+  size_t tiled_kernel_threshold_ = 0;
+  bool dense_gas_mode_ = false;
+  BasicContactSolver<D> contact_solver_;
+  std::vector<std::pair<size_t, size_t>> contact_pairs_;
+  CollisionCounts collision_counts_;
+  ThreadPool* thread_pool_ = nullptr;
+  StaticGeometry static_geometry_;
+  // Batches of Particles added since construction, each drawn from its own generator
+  unsigned int added_batch_count_ = 0;
+  // The first of the Particles stepped outside the container that the neighbour list
+  // indexes, or nullptr for its own Particles
+  const Particle* listed_particles_ = nullptr;
+
+  // Below this many Particles a single thread moves them faster than the pool can split the work
+  const size_t kParallelParticleThreshold = 16384;
+  // Particles initialised from each random generator
+  const size_t kInitializationBlockSize = 65536;
+
+  // Below this many Particles the tiled kernel steps faster than the neighbour list.
+  // Measured with pair-kernel-benchmark at the density of the default Simulation.
+  const size_t kTiledKernelThreshold = 640;
+
+  const double kMaxSpeedFactor = 0.2;
+
+  /**
+   * Initialises a random set of Particles within the container
+   * @param particle_configs The settings and amount of each type of Particle
+   */
+  void InitializeParticles(const std::vector<ParticleConfig>& particle_configs);
+
+  /**
+   * Draws a Particle at a random position within the container, with a random velocity
+   * @param particle_config The settings of the Particle
+   * @param generator The random generator
+   * @return The Particle
+   */
+  Particle GenerateParticle(const ParticleConfig& particle_config,
+                            std::mt19937& generator) const;
+
+  /**
+   * Fits the static geometry to the container and the largest Particle
+   */
+  void BakeStaticGeometry();
+
+  /**
+   * Rebuilds the neighbour list on its next update if it indexes other Particles
+   * @param particles The first of the Particles about to be stepped or edited,
+   *                  nullptr for the container's own
+   */
+  void UseNeighborListFor(const Particle* particles);
+
+  /**
+   * @param particle_count The number of Particles stepped
+   * @return True if the step checks every pair with the tiled kernel
+   */
+  bool UsesTiledKernel(size_t particle_count) const;
+
+  /**
+   * Updates the position of every Particle, then bounces it off the walls and any
+   * static geometry
+   * @param particles The Particles
+   */
+  void ProcessParticleMovement(ParticleSpan<Particle> particles);
+
+  /**
+   * Updates the velocity of every Particle based on collisions
+   * @param particles The Particles
+   */
+  void ProcessParticleCollision(ParticleSpan<Particle> particles);
+
+  /**
+   * Resolves every pair contact together
+   * @param particles The Particles
+   */
+  void ProcessDenseParticleCollision(ParticleSpan<Particle> particles);
+
+  /**
+   * Updates the velocity of a Particle if it collides with any wall of the container
+   * @param particle The Particle
+   * @return The number of walls it bounced off
+   */
+  size_t ProcessWallCollision(Particle& particle) const;
+
+  /**
+   * Generates a random double value in a given range
+   * @param generator The random generator
+   * @param min The minimum possible value
+   * @param max The maximum possible value
+   * @return A random double value
+   */
+  static double GenerateRandomDouble(std::mt19937& generator, double min, double max);
+};
+
+typedef BasicGasContainer<2> GasContainer;
+typedef BasicGasContainer<3> GasContainer3D;
+
+}  // namespace idealgas
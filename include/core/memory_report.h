@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * The bytes held by each subsystem of a simulation. Bytes per Particle are what scale with
+ * the size of a run, so a report on a small run sizes a large one before it is launched.
+ */
+class MemoryReport {
+ public:
+  /**
+   * Constructs an empty MemoryReport
+   * @param particle_count The number of Particles the memory is held for
+   */
+  explicit MemoryReport(size_t particle_count);
+
+  /**
+   * Adds the memory of a subsystem
+   * @param subsystem The name of the subsystem
+   * @param bytes The bytes it holds
+   */
+  void Add(const std::string& subsystem, size_t bytes);
+
+  /**
+   * Adds every subsystem of another report
+   * @param report The report
+   */
+  void Add(const MemoryReport& report);
+
+  /**
+   * @return The bytes held by every subsystem
+   */
+  size_t GetTotalBytes() const;
+
+  /**
+   * @param bytes Bytes held for every Particle
+   * @return The bytes per Particle, or 0 without Particles
+   */
+  double GetBytesPerParticle(size_t bytes) const;
+
+  /**
+   * Formats the report as a table of each subsystem's bytes and bytes per Particle
+   * @return The table, ending in a newline
+   */
+  std::string Format() const;
+
+  // Getters
+  size_t GetParticleCount() const;
+  const std::vector<std::pair<std::string, size_t>>& GetSubsystems() const;
+
+ private:
+  size_t particle_count_;
+  std::vector<std::pair<std::string, size_t>> subsystems_;
+};
+
+/**
+ * @param vector A vector
+ * @return The bytes allocated by the vector, which may exceed the bytes in use
+ */
+template <typename T>
+size_t GetAllocatedBytes(const std::vector<T>& vector) {
+  return vector.capacity() * sizeof(T);
+}
+
+}  // namespace idealgas
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <core/gas_container.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace idealgas {
+
+/**
+ * Live counters and gauges of a running simulation, written by the simulation thread and
+ * read by any number of scrapers. Every value is a relaxed atomic, so updates never block
+ * and cost a few stores per step whether or not anyone is scraping.
+ */
+class SimulationMetrics {
+ public:
+  /**
+   * Constructs SimulationMetrics with every value zero
+   * @param phase_names The names of the timed phases of a step
+   * @param type_count The number of particle types
+   */
+  SimulationMetrics(const std::vector<std::string>& phase_names, size_t type_count);
+
+  /**
+   * Adds to the total time spent in a phase
+   * @param phase The index of the phase in phase_names
+   * @param duration The time spent in this step
+   */
+  void AddPhaseTime(size_t phase, std::chrono::nanoseconds duration);
+
+  /**
+   * Counts a finished step and updates the smoothed steps per second
+   * @param step The number of steps finished so far
+   * @param counts The collisions and wall bounces so far
+   */
+  void RecordStep(size_t step, const CollisionCounts& counts);
+
+  /**
+   * Records how long the simulation took to start
+   * @param construction The time to set up the simulation state
+   * @param first_step The time to run the first step
+   */
+  void SetStartupTimes(std::chrono::nanoseconds construction, std::chrono::nanoseconds first_step);
+
+  // Setters of the gauges
+  void SetKineticEnergy(double kinetic_energy);
+  void SetTemperature(size_t type, double temperature);
+  void SetParticleMemory(size_t bytes);
+
+  /**
+   * Formats every value in the Prometheus text exposition format
+   * @return The exposition, ending in a newline
+   */
+  std::string FormatExposition() const;
+
+ private:
+  std::vector<std::string> phase_names_;
+
+  std::atomic<size_t> step_count_;
+  std::atomic<double> steps_per_second_;
+  std::atomic<size_t> particle_collisions_;
+  std::atomic<size_t> wall_bounces_;
+  std::atomic<double> kinetic_energy_;
+  std::atomic<size_t> particle_memory_;
+  std::atomic<double> construction_seconds_;
+  std::atomic<double> first_step_seconds_;
+  std::vector<std::atomic<uint64_t>> phase_nanoseconds_;
+  std::vector<std::atomic<double>> temperatures_;
+
+  // Only touched by the simulation thread
+  std::chrono::steady_clock::time_point last_step_time_;
+  bool has_last_step_ = false;
+
+  // Weight of the newest step in the smoothed steps per second
+  const double kRateSmoothing = 0.05;
+};
+
+}  // namespace idealgas
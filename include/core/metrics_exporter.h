@@ -0,0 +1,91 @@
+#pragma once
+
+#include <core/metrics.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace idealgas {
+
+/**
+ * Serves SimulationMetrics to local scrapers from a background thread.
+ * HTTP GET requests for / or /metrics get the exposition with HTTP headers, so Prometheus
+ * or curl can scrape it; clients that send anything else, or nothing, get the bare
+ * exposition. The thread sleeps in poll between scrapes, so serving costs nothing until
+ * a client connects. Not supported on Windows, where Start fails.
+ */
+class MetricsExporter {
+ public:
+  /**
+   * Constructs a stopped MetricsExporter
+   * @param metrics The metrics served, which must outlive the MetricsExporter
+   */
+  explicit MetricsExporter(const SimulationMetrics& metrics);
+
+  /**
+   * Stops serving
+   */
+  ~MetricsExporter();
+
+  MetricsExporter(const MetricsExporter&) = delete;
+  MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+  /**
+   * Starts serving on a TCP port of the loopback interface
+   * @param port The port, or 0 for any free port
+   * @return True if the endpoint is listening
+   */
+  bool StartTcp(uint16_t port);
+
+  /**
+   * Starts serving on a Unix domain socket, replacing any socket file at the path
+   * @param path The path of the socket
+   * @return True if the endpoint is listening
+   */
+  bool StartUnix(const std::string& path);
+
+  /**
+   * Stops serving and closes the endpoint
+   */
+  void Stop();
+
+  // Getters
+  bool IsRunning() const;
+  uint16_t GetPort() const;
+  size_t GetScrapeCount() const;
+
+ private:
+  const SimulationMetrics& metrics_;
+  int listen_socket_;
+  uint16_t port_;
+  std::string unix_path_;
+  std::atomic<bool> running_;
+  std::atomic<size_t> scrape_count_;
+  std::thread thread_;
+
+  // How long the serving thread sleeps before checking whether it was stopped
+  const int kPollMilliseconds = 100;
+  // How long a connected client has to send its request
+  const int kRequestMilliseconds = 200;
+
+  /**
+   * Starts the serving thread on a bound socket
+   * @return True if the socket is listening
+   */
+  bool Listen();
+
+  /**
+   * Accepts and answers clients until stopped
+   */
+  void Serve();
+
+  /**
+   * Reads a client's request, if any, and sends the exposition
+   * @param client The connected socket
+   */
+  void Respond(int client);
+};
+
+}  // namespace idealgas
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <core/particle_span.h>
+#include <core/thread_pool.h>
+
+#include <array>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * How often a NeighborList has been rebuilt
+ */
+struct NeighborListStats {
+  size_t updates = 0;
+  size_t rebuilds = 0;
+  // Particles inserted or removed without a rebuild
+  size_t incremental_updates = 0;
+  size_t pair_count = 0;
+  // Grid levels and pair distance checks of the last build
+  size_t level_count = 0;
+  size_t candidate_checks = 0;
+
+  /**
+   * @return The fraction of updates that rebuilt the list
+   */
+  double GetRebuildRate() const {
+    return updates > 0 ? double(rebuilds) / double(updates) : 0;
+  }
+};
+
+/**
+ * Verlet neighbour list: every pair of Particles within (sum of radii + skin) of each other.
+ * While no Particle has moved more than half the skin since the last build, no pair outside
+ * the list can be touching, so the list is reused instead of searching all pairs every step.
+ *
+ * Candidate pairs come from a multi-level grid whose cell size doubles at each level.
+ * Each Particle is stored at the finest level whose cells are at least as wide as its own
+ * reach (diameter + skin), so a few large Particles do not force large cells on many small
+ * ones, and a Particle only searches its own level and the coarser ones.
+ *
+ * The grid has D dimensions, so a Particle searches the 3^D cells around its own.
+ *
+ * Cells keep copies of the positions and radii of their Particles, and builds scan the grid
+ * cell by cell, so the search streams through memory instead of jumping between Particles.
+ * Given a ThreadPool, a build bins the Particles and scans the cells in chunks, each
+ * collecting its own pairs. The pairs are then sorted, so the list is the same either way.
+ */
+template <int D>
+class BasicNeighborList {
+ public:
+  typedef BasicParticle<Scalar, D> Particle;
+
+  /**
+   * Constructs an empty NeighborList
+   * @param skin The extra distance beyond the sum of radii kept in the list
+   * @param max_level_count The most grid levels, 1 for a single uniform grid
+   */
+  explicit BasicNeighborList(double skin, size_t max_level_count = 16);
+
+  /**
+   * Rebuilds the list if any Particle has moved more than half the skin since the last build
+   * @param particles The Particles, in the same order as every previous call, apart from
+   *                  those added by Insert and removed by Remove
+   * @param thread_pool The ThreadPool running a rebuild, or nullptr to rebuild serially
+   */
+  void Update(ParticleSpan<const Particle> particles, ThreadPool* thread_pool = nullptr);
+
+  /**
+   * Rebuilds the list from scratch, using the multi-level grid to find candidate pairs
+   * @param particles The Particles
+   * @param thread_pool The ThreadPool running the chunks of the build, or nullptr to run
+   *                    them serially
+   */
+  void Build(ParticleSpan<const Particle> particles, ThreadPool* thread_pool = nullptr);
+
+  /**
+   * Adds the pairs of Particles appended since the last call, searching the grid of the last
+   * build around each new Particle only. Falls back to a rebuild if the list was never built
+   * or a new Particle is larger than the coarsest cells.
+   * @param particles The Particles, the listed ones followed by the new ones
+   * @param first The index of the first new Particle
+   */
+  void Insert(ParticleSpan<const Particle> particles, size_t first);
+
+  /**
+   * Drops removed Particles from the list, renumbering the rest in their original order
+   * @param removed For each listed Particle, true if it was removed
+   */
+  void Remove(const std::vector<bool>& removed);
+
+  /**
+   * Forgets the list, so the next Update rebuilds it, e.g. for another set of Particles
+   */
+  void Clear();
+
+  /**
+   * @param particles The Particles
+   * @return True if the list no longer covers every pair that could be touching
+   */
+  bool NeedsRebuild(ParticleSpan<const Particle> particles) const;
+
+  /**
+   * The neighbours of a Particle with a larger index, in ascending order
+   * @param index The index of the Particle
+   * @return Pointers to the first and one past the last neighbour index
+   */
+  const size_t* NeighborsBegin(size_t index) const;
+  const size_t* NeighborsEnd(size_t index) const;
+
+  /**
+   * @return The bytes allocated for the list, the grid and the buffers reused by builds
+   */
+  size_t GetMemoryUsage() const;
+
+  // Getters
+  double GetSkin() const;
+  const NeighborListStats& GetStats() const;
+
+ private:
+  typedef glm::vec<D, double> Position;
+  typedef std::array<size_t, D> Coordinates;
+
+  /**
+   * Particle indices sorted by cell, for the Particles stored at one level
+   */
+  struct GridLevel {
+    double cell_size;
+    std::array<size_t, D> cell_counts;
+    // Cells are numbered with the first axis varying fastest.
+    // Particles in cell c are cell_particles[cell_starts[c]] to cell_particles[cell_starts[c + 1]]
+    std::vector<size_t> cell_starts;
+    std::vector<size_t> cell_particles;
+    // The build positions and radii of cell_particles, in the same order
+    std::vector<typename Particle::Vec> cell_positions;
+    std::vector<Scalar> cell_radii;
+  };
+
+  /**
+   * The pairs found by one chunk of a build
+   */
+  struct PairBuffer {
+    std::vector<std::pair<size_t, size_t>> pairs;
+    size_t candidate_checks = 0;
+  };
+
+  double skin_;
+  size_t max_level_count_;
+  // The smallest corner of the Particles and the finest cell size of the last build
+  Position origin_;
+  double base_cell_size_ = 0;
+  // Neighbours of Particle i are neighbors_[offsets_[i]] to neighbors_[offsets_[i + 1]]
+  std::vector<size_t> offsets_;
+  std::vector<size_t> neighbors_;
+  std::vector<typename Particle::Vec> build_positions_;
+  std::vector<Scalar> build_radii_;
+  NeighborListStats stats_;
+
+  // Reused by every build
+  std::vector<GridLevel> levels_;
+  std::vector<size_t> particle_levels_;
+  // The cell of each Particle at its own level
+  std::vector<size_t> particle_cells_;
+  // The Particles of a level split into bands of cells, and where each chunk's part starts
+  std::vector<size_t> band_particles_;
+  std::vector<size_t> band_cells_;
+  std::vector<size_t> band_offsets_;
+  std::vector<std::pair<size_t, size_t>> pairs_;
+  std::vector<PairBuffer> pair_buffers_;
+
+  /**
+   * @param radius The radius of a Particle
+   * @return The finest level whose cells are at least as wide as the reach of the Particle
+   */
+  size_t GetLevel(double radius) const;
+
+  /**
+   * @param grid The grid level
+   * @param position A position, which is clamped to the grid
+   * @return The coordinates of the cell holding the position
+   */
+  Coordinates GetCoordinates(const GridLevel& grid, const Position& position) const;
+
+  /**
+   * @param grid The grid level
+   * @param coordinates The coordinates of a cell
+   * @return The index of the cell
+   */
+  static size_t GetCell(const GridLevel& grid, const Coordinates& coordinates);
+
+  /**
+   * Sorts the Particles into the cells of their own level, by build position
+   * @param thread_pool The ThreadPool finding the cells in chunks, or nullptr
+   */
+  void SortCells(ThreadPool* thread_pool);
+
+  /**
+   * Visits every Particle stored in the cells around a cell
+   * @param grid The grid level
+   * @param center The coordinates of the central cell
+   * @param half_width The most cells away from the central cell along each axis
+   * @param visit Called with the slot of each Particle in the cell order of the grid
+   */
+  template <typename Visit>
+  void ForEachNearbySlot(const GridLevel& grid, const Coordinates& center,
+                         size_t half_width, Visit visit) const;
+
+  /**
+   * Lists a pair if their build positions are within the sum of radii and the skin
+   * @param i The index of one Particle
+   * @param position The build position of Particle i
+   * @param radius The radius of Particle i
+   * @param grid The grid level holding the other Particle
+   * @param slot The slot of the other Particle in the cell order of the grid
+   * @param buffer The buffer collecting the pair
+   */
+  void CheckPair(size_t i, const Position& position, double radius, const GridLevel& grid,
+                 size_t slot, PairBuffer& buffer) const;
+
+  /**
+   * Moves the pairs and check counts of every PairBuffer into the build, in buffer order
+   */
+  void CollectPairs();
+
+  /**
+   * Replaces the list with the collected pairs, grouped by their smaller index
+   * @param particle_count The number of Particles
+   * @param thread_pool The ThreadPool sorting the groups in chunks, or nullptr
+   */
+  void GroupPairs(size_t particle_count, ThreadPool* thread_pool);
+};
+
+/**
+ * The neighbour lists of 2D and 3D Simulations
+ */
+typedef BasicNeighborList<2> NeighborList;
+typedef BasicNeighborList<3> NeighborList3D;
+
+}  // namespace idealgas
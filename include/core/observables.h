@@ -0,0 +1,31 @@
+#pragma once
+
+#include <core/particle_span.h>
+
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * Computes the total kinetic energy of a set of Particles using compensated summation
+ * @param particles The Particles
+ * @return The total kinetic energy
+ */
+template <typename T, int D>
+T ComputeKineticEnergy(ParticleSpan<const BasicParticle<T, D>> particles);
+
+template <typename T, int D>
+T ComputeKineticEnergy(const std::vector<BasicParticle<T, D>>& particles);
+
+/**
+ * Computes the total momentum of a set of Particles using compensated summation
+ * @param particles The Particles
+ * @return The total momentum
+ */
+template <typename T, int D>
+glm::vec<D, T> ComputeMomentum(ParticleSpan<const BasicParticle<T, D>> particles);
+
+template <typename T, int D>
+glm::vec<D, T> ComputeMomentum(const std::vector<BasicParticle<T, D>>& particles);
+
+}  // namespace idealgas
@@ -1,76 +1,117 @@
 #pragma once
 
-#include "cinder/gl/gl.h"
+#include <core/precision.h>
+
+#include <cstdint>
+
+#include "cinder/CinderGlm.h"
 
 namespace idealgas {
 
 /**
- * Representation of a Gas Particle
+ * Representation of a Gas Particle in D dimensions (2 or 3), with state stored in the scalar
+ * type T. The type is an 8-bit index into the per-type ParticleConfig table, which holds what every
+ * Particle of a type shares, such as its display color, so a 2D float Particle takes 28 bytes.
+ * Radius and mass stay in T, since every pair test reads them.
  */
-class Particle {
+template <typename T, int D = 2>
+class BasicParticle {
  public:
+   typedef glm::vec<D, T> Vec;
+   static const int kDimension = D;
+   // Types are stored in 8 bits
+   static constexpr size_t kMaxTypeCount = 256;
+
    /**
-    * Constructs a Particle with a given type, initial position, velocity, color, mass and radius
-    * @param type The type of the particle
+    * Constructs a Particle with a given type, initial position, velocity, mass and radius
+    * @param type The type of the particle, which must be below kMaxTypeCount
     * @param position The initial position
     * @param velocity The initial velocity
-    * @param color The display color
     * @param radius The radius
     * @param mass The mass
     */
-   Particle(size_t type, const glm::vec2& position, const glm::vec2& velocity,
-            const ci::Color& color, float radius, double mass);
+   BasicParticle(size_t type, const Vec& position, const Vec& velocity, T radius, T mass);
 
    /**
     * Updates the Particle's position based on its velocity
     */
    void ProcessMovement();
 
+   /**
+    * Update the Particle's velocity if it collides with a wall perpendicular to an axis
+    * @param axis The axis, 0 for X, 1 for Y and 2 for Z
+    * @param wall_pos The position of the wall along the axis
+    * @return True if the Particle bounced
+    */
+   bool ProcessWallCollision(int axis, T wall_pos);
+
+   /**
+    * Update the Particle's velocity if it touches or has crossed either wall of a box along
+    * an axis while moving outwards, so a Particle pushed past a wall still turns back
+    * @param axis The axis, 0 for X, 1 for Y and 2 for Z
+    * @param lower_wall The position of the wall with the smaller coordinate
+    * @param upper_wall The position of the wall with the larger coordinate
+    * @return True if the Particle bounced
+    */
+   bool ProcessBoxCollision(int axis, T lower_wall, T upper_wall);
+
    /**
     * Update the Particle's velocity if it collides with a vertical wall
     * @param wall_pos The X position of the vertical wall
+    * @return True if the Particle bounced
     */
-   void ProcessXWallCollision(double wall_pos);
+   bool ProcessXWallCollision(T wall_pos);
 
    /**
    * Update the Particle's velocity if it collides with a horizontal wall
    * @param wall_pos The Y position of the horizontal wall
+   * @return True if the Particle bounced
    */
-   void ProcessYWallCollision(double wall_pos);
+   bool ProcessYWallCollision(T wall_pos);
 
    // Getters
    size_t GetType() const;
-   const glm::vec2& GetPosition() const;
-   const glm::vec2& GetVelocity() const;
-   const cinder::Color& GetColor() const;
-   float GetRadius() const;
-   double GetMass() const;
+   const Vec& GetPosition() const;
+   const Vec& GetVelocity() const;
+   T GetRadius() const;
+   T GetMass() const;
 
    // Setters
-   void SetVelocity(const glm::vec2 &velocity);
+   void SetPosition(const Vec& position);
+   void SetVelocity(const Vec& velocity);
 
 private:
-   size_t type_;
-   glm::vec2 position_;
-   glm::vec2 velocity_;
-   ci::Color color_;
-   float radius_;
-   double mass_;
+   // 3D vectors are padded to four components, so each one loads as a single SIMD register
+   static constexpr size_t kVecAlignment = D == 3 ? 4 * sizeof(T) : alignof(Vec);
+
+   // Largest fields first, so the 8-bit fields pack into the tail
+   alignas(kVecAlignment) Vec position_;
+   alignas(kVecAlignment) Vec velocity_;
+   T radius_;
+   T mass_;
+   uint8_t type_;
 };
 
+/**
+ * The Particle types used by 2D and 3D Simulations
+ */
+typedef BasicParticle<Scalar> Particle;
+typedef BasicParticle<Scalar, 3> Particle3D;
+
 /**
  * Checks if two Particles collide
  * @param particle_a A Particle
  * @param particle_b A Particle
  * @return True if the two particles collide
  */
-bool CheckCollision(const Particle& particle_a, const Particle& particle_b);
+template <typename T, int D>
+bool CheckCollision(const BasicParticle<T, D>& particle_a, const BasicParticle<T, D>& particle_b);
 
 /**
  * Updates the velocities of two colliding particles
  * @param particle_a A Particle
  * @param particle_b A Particle
  */
-void CollideParticles(Particle& particle_a, Particle& particle_b);
+template <typename T, int D>
+void CollideParticles(BasicParticle<T, D>& particle_a, BasicParticle<T, D>& particle_b);
 }  // namespace idealgas
-
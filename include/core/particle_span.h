@@ -0,0 +1,78 @@
+#pragma once
+
+#include <core/particle.h>
+
+#include <type_traits>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * A run of Particles stored elsewhere, such as all of a GasContainer's own Particles or one
+ * replica's range of an Ensemble's shared array. P is a Particle type, const to only read.
+ * Vectors convert to spans, so code stepping Particles need not know who owns them.
+ */
+template <typename P>
+class ParticleSpan {
+ public:
+  typedef typename std::remove_const<P>::type Particle;
+
+  ParticleSpan() = default;
+
+  /**
+   * Constructs a span of Particles
+   * @param data The first Particle
+   * @param size The number of Particles
+   */
+  ParticleSpan(P* data, size_t size) : data_(data), size_(size) {}
+
+  /**
+   * Constructs a span of every Particle in a vector, which must outlive it
+   * @param particles The vector
+   */
+  ParticleSpan(std::vector<Particle>& particles)
+      : data_(particles.data()), size_(particles.size()) {}
+
+  template <typename Q = P, typename = typename std::enable_if<std::is_const<Q>::value>::type>
+  ParticleSpan(const std::vector<Particle>& particles)
+      : data_(particles.data()), size_(particles.size()) {}
+
+  /**
+   * Constructs a read only span from a writable one
+   * @param particles The writable span
+   */
+  template <typename Q = P, typename = typename std::enable_if<std::is_const<Q>::value>::type>
+  ParticleSpan(const ParticleSpan<Particle>& particles)
+      : data_(particles.data()), size_(particles.size()) {}
+
+  P* begin() const {
+    return data_;
+  }
+
+  P* end() const {
+    return data_ + size_;
+  }
+
+  P& operator[](size_t index) const {
+    return data_[index];
+  }
+
+  // Getters
+  P* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+ private:
+  P* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace idealgas
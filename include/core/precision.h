@@ -0,0 +1,49 @@
+#pragma once
+
+namespace idealgas {
+
+/**
+ * The scalar type used to store Particle state in the Simulation.
+ * Build with IDEALGAS_DOUBLE_PRECISION defined to switch to double.
+ */
+#ifdef IDEALGAS_DOUBLE_PRECISION
+typedef double Scalar;
+#else
+typedef float Scalar;
+#endif
+
+/**
+ * A running sum with Neumaier (improved Kahan) compensation, which keeps
+ * the rounding error of long float sums from growing with the term count
+ */
+template <typename T>
+class CompensatedSum {
+ public:
+  /**
+   * Adds a value to the sum
+   * @param value The added value
+   */
+  void Add(T value) {
+    T total = sum_ + value;
+    // Recover the low order bits lost by whichever operand was smaller
+    if ((sum_ < 0 ? -sum_ : sum_) >= (value < 0 ? -value : value)) {
+      compensation_ += (sum_ - total) + value;
+    } else {
+      compensation_ += (value - total) + sum_;
+    }
+    sum_ = total;
+  }
+
+  /**
+   * @return The compensated sum of all added values
+   */
+  T GetSum() const {
+    return sum_ + compensation_;
+  }
+
+ private:
+  T sum_ = 0;
+  T compensation_ = 0;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <core/gas_container.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace idealgas {
+
+/**
+ * Everything needed to construct the GasContainer a replay log was recorded from
+ */
+template <int D>
+struct BasicReplayHeader {
+  unsigned int seed = 0;
+  std::vector<ParticleConfig> particle_configs;
+  glm::vec<D, float> top_left_corner = glm::vec<D, float>(0);
+  glm::vec<D, double> box_size = glm::vec<D, double>(0);
+  double neighbor_skin = 0;
+  bool dense_gas_mode = false;
+  ContactSolverSettings contact_solver_settings;
+  // The obstacles and pistons when recording started, always empty in 3D
+  StaticGeometry static_geometry;
+  // Particles per block hash, 1 to pinpoint single Particles
+  size_t block_size = 1;
+  // sizeof(Scalar) of the recording build
+  size_t scalar_size = sizeof(Scalar);
+};
+
+/**
+ * A change made to a GasContainer between two steps, replayed before the same step
+ */
+template <int D>
+struct BasicReplayEdit {
+  enum Kind { kAddParticles, kRemoveParticles, kScaleVelocities, kResizeBox };
+
+  Kind kind = kScaleVelocities;
+  // The Particles added, or the type and most Particles removed
+  ParticleConfig particle_config = ParticleConfig(0, ci::Color(), 0, 0, 0);
+  double factor = 1;
+  glm::vec<D, double> box_size = glm::vec<D, double>(0);
+
+  // Factories, taking the arguments of the GasContainer method each kind replays
+  static BasicReplayEdit AddParticles(const ParticleConfig& particle_config);
+  static BasicReplayEdit RemoveParticles(size_t type, size_t amount);
+  static BasicReplayEdit ScaleVelocities(double factor);
+  static BasicReplayEdit ResizeBox(const glm::vec<D, double>& box_size);
+
+  /**
+   * Makes the change to a GasContainer
+   * @param container The GasContainer
+   * @return True if the GasContainer changed, false if the method refused the change or
+   *         found nothing to remove. Only changes need recording.
+   */
+  bool Apply(BasicGasContainer<D>& container) const;
+};
+
+/**
+ * Where a rerun first differed from its replay log
+ */
+struct ReplayDivergence {
+  bool diverged = false;
+  size_t step = 0;
+  // Index range [first_particle, last_particle] of the first differing block
+  size_t first_particle = 0;
+  size_t last_particle = 0;
+  std::string reason;
+};
+
+/**
+ * Hashes the exact bits of the positions and velocities of a range of Particles.
+ * Each component is mixed in turn, so differences in two components cannot cancel.
+ * Each Particle is mixed independently and the results summed, so the loop vectorizes.
+ * @param particles The Particles
+ * @param begin The first index hashed
+ * @param end One past the last index hashed
+ * @return The hash
+ */
+template <int D>
+uint64_t HashParticles(const std::vector<BasicParticle<Scalar, D>>& particles,
+                       size_t begin, size_t end);
+
+/**
+ * Records the header of a run, then the edits before every step and a hash of the
+ * Particles after it
+ */
+template <int D>
+class BasicReplayRecorder {
+ public:
+  typedef BasicParticle<Scalar, D> Particle;
+
+  /**
+   * Opens a log and records the header and the initial state as step 0
+   * @param path The path of the log
+   * @param container The GasContainer, freshly constructed apart from its static geometry.
+   *                  Its configs are recorded as given.
+   * @param block_size Particles per block hash, 0 to pick one giving at most 64 blocks
+   */
+  BasicReplayRecorder(const std::string& path, const BasicGasContainer<D>& container,
+                      size_t block_size = 0);
+
+  /**
+   * Records a change made since the last step, to be replayed before the next one
+   * @param edit The change
+   */
+  void RecordEdit(const BasicReplayEdit<D>& edit);
+
+  /**
+   * Records the edits since the last step and the hashes of the Particles after a step
+   * @param particles The Particles
+   */
+  void RecordStep(const std::vector<Particle>& particles);
+
+  /**
+   * @return True if the log was opened and every write so far succeeded
+   */
+  bool IsGood() const;
+
+ private:
+  std::ofstream stream_;
+  size_t block_size_;
+  std::vector<BasicReplayEdit<D>> pending_edits_;
+};
+
+/**
+ * A replay log read back from disk
+ */
+template <int D>
+class BasicReplayLog {
+ public:
+  /**
+   * Reads a log written by BasicReplayRecorder<D>
+   * @param path The path of the log
+   * @return True if the log was read, false if it is missing, malformed or of a gas with
+   *         another number of dimensions
+   */
+  bool Read(const std::string& path);
+
+  /**
+   * Constructs a GasContainer with the recorded seed, settings and static geometry
+   * @param thread_pool The ThreadPool of the GasContainer, or nullptr to run serially
+   * @return The GasContainer
+   */
+  BasicGasContainer<D> CreateContainer(ThreadPool* thread_pool = nullptr) const;
+
+  /**
+   * Reruns the recorded steps and edits on a GasContainer and compares every hash
+   * @param container A GasContainer in the recorded initial state, e.g. from CreateContainer,
+   * possibly with different settings or thread counts to compare code paths
+   * @return The first divergence, if any
+   */
+  ReplayDivergence Verify(BasicGasContainer<D>& container) const;
+
+  // Getters
+  const BasicReplayHeader<D>& GetHeader() const;
+  size_t GetStepCount() const;
+  size_t GetEditCount() const;
+
+ private:
+  BasicReplayHeader<D> header_;
+  // The state hash and Particle count of step s are at index s, the edits before it are
+  // edits_[edit_starts_[s]] up to edit_starts_[s + 1], and likewise for its block hashes
+  std::vector<uint64_t> state_hashes_;
+  std::vector<size_t> particle_counts_;
+  std::vector<BasicReplayEdit<D>> edits_;
+  std::vector<size_t> edit_starts_;
+  std::vector<uint32_t> block_hashes_;
+  std::vector<size_t> block_starts_;
+};
+
+typedef BasicReplayHeader<2> ReplayHeader;
+typedef BasicReplayHeader<3> ReplayHeader3D;
+typedef BasicReplayEdit<2> ReplayEdit;
+typedef BasicReplayEdit<3> ReplayEdit3D;
+typedef BasicReplayRecorder<2> ReplayRecorder;
+typedef BasicReplayRecorder<3> ReplayRecorder3D;
+typedef BasicReplayLog<2> ReplayLog;
+typedef BasicReplayLog<3> ReplayLog3D;
+
+}  // namespace idealgas
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <core/particle.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * An immutable copy of the Simulation state after one step
+ */
+struct SimulationSnapshot {
+  // Fixed-point positions have this many steps across the box along each axis
+  static constexpr double kQuantizationSteps = 65535;
+
+  size_t step = 0;
+  // Empty if the positions are quantized instead
+  std::vector<Particle::Vec> positions;
+  // Positions in 16-bit fixed point within the box, half the size of positions
+  std::vector<glm::vec<2, uint16_t>> quantized_positions;
+  // The box corner at 0 and the extent of one fixed-point step
+  glm::dvec2 quantization_origin;
+  glm::dvec2 quantization_step;
+  std::vector<Particle::Vec> velocities;
+  // One set of speed bin counts per particle type
+  std::vector<std::vector<size_t>> speed_frequencies;
+
+  /**
+   * @param index The index of a Particle
+   * @return The position of the Particle, decoded if quantized
+   */
+  Particle::Vec GetPosition(size_t index) const;
+};
+
+/**
+ * Publishes SimulationSnapshots from one writer thread to any number of reader threads
+ * without locks. The writer fills a free back buffer and atomically makes it current;
+ * readers pin the current buffer with a reference count, which keeps the writer from
+ * reusing it until every reader has let go.
+ */
+class SnapshotPublisher {
+ private:
+  struct Buffer {
+    SimulationSnapshot snapshot;
+    std::atomic<size_t> reader_count;
+
+    Buffer() : reader_count(0) {}
+  };
+
+ public:
+  /**
+   * A pinned, read only view of a published snapshot, released on destruction
+   */
+  class View {
+   public:
+    View();
+    View(View&& other);
+    View& operator=(View&& other);
+    ~View();
+
+    View(const View&) = delete;
+    View& operator=(const View&) = delete;
+
+    /**
+     * @return True if the View holds a snapshot
+     */
+    bool IsValid() const;
+
+    const SimulationSnapshot& operator*() const;
+    const SimulationSnapshot* operator->() const;
+
+   private:
+    friend class SnapshotPublisher;
+    explicit View(Buffer* buffer);
+
+    Buffer* buffer_;
+  };
+
+  /**
+   * Constructs a SnapshotPublisher with nothing published yet
+   * @param buffer_count The number of buffers, at least 3: one published,
+   * one being written and the rest for readers that hold on to older snapshots
+   */
+  explicit SnapshotPublisher(size_t buffer_count = 4);
+
+  SnapshotPublisher(const SnapshotPublisher&) = delete;
+  SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+  /**
+   * Writer only. Finds a back buffer no reader is using.
+   * @return The back buffer to fill, or nullptr if readers pin every buffer,
+   * in which case this step is not published
+   */
+  SimulationSnapshot* BeginPublish();
+
+  /**
+   * Writer only. Makes the buffer returned by the last BeginPublish current.
+   */
+  void EndPublish();
+
+  /**
+   * Pins the most recently published snapshot
+   * @return The View, invalid if nothing has been published yet
+   */
+  View Acquire() const;
+
+  /**
+   * @return The number of steps skipped because no back buffer was free
+   */
+  size_t GetDroppedCount() const;
+
+  /**
+   * Writer only
+   * @return The bytes allocated for every buffer, including those pinned by readers
+   */
+  size_t GetMemoryUsage() const;
+
+ private:
+  std::unique_ptr<Buffer[]> buffers_;
+  size_t buffer_count_;
+  // Index of the current buffer, or buffer_count_ before the first publish
+  std::atomic<size_t> published_index_;
+  size_t back_index_;
+  std::atomic<size_t> dropped_count_;
+};
+
+}  // namespace idealgas
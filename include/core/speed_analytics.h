@@ -0,0 +1,127 @@
+#pragma once
+
+#include <core/gas_container.h>
+
+#include <deque>
+
+namespace idealgas {
+
+/**
+ * Window sizes and thresholds of SpeedAnalytics
+ */
+struct SpeedAnalyticsSettings {
+  // Equal probability bins of the goodness-of-fit test
+  size_t fit_bin_count = 10;
+  // Number of steps averaged before judging equilibrium
+  size_t window_size = 200;
+  // Equilibrated once the windowed mean chi squared per degree of freedom is below this
+  double max_chi_squared_per_dof = 1.2;
+  // and the windowed species temperatures are within this fraction of each other
+  double max_temperature_spread = 0.25;
+  // Adaptive histograms cover speeds up to this many thermal speeds sqrt(2kT / m)
+  double speed_range_factor = 3;
+};
+
+/**
+ * The Maxwell-Boltzmann fit of one particle type
+ */
+struct SpeciesFit {
+  size_t count = 0;
+  double mean_mass = 0;
+  // Effective temperature kT: the mean kinetic energy over D / 2, its maximum likelihood estimate
+  double temperature = 0;
+  // kT averaged over the last window of steps
+  double windowed_temperature = 0;
+  double chi_squared = 0;
+  size_t degrees_of_freedom = 0;
+};
+
+/**
+ * Streaming fit of each particle type's speeds to the Maxwell-Boltzmann distribution,
+ * f(v) = (m v / kT) exp(-m v^2 / 2kT) in 2D, with equilibrium detection.
+ *
+ * In 2D the kinetic energy of a Maxwell-Boltzmann gas is exponential with mean kT, and in
+ * 3D it is gamma distributed with shape 3/2, so every Particle's energy over its type's kT
+ * is binned into equal probability bins of that distribution, and the chi squared of the
+ * counts measures goodness of fit.
+ */
+class SpeedAnalytics {
+ public:
+  /**
+   * Constructs a SpeedAnalytics with no steps seen
+   * @param type_count The number of particle types
+   * @param settings The window size and thresholds
+   */
+  SpeedAnalytics(size_t type_count,
+                 const SpeedAnalyticsSettings& settings = SpeedAnalyticsSettings());
+
+  /**
+   * Fits the current speeds and updates the equilibrium state. Particles are summed and
+   * binned in chunks of a fixed size, so the fit is the same for every thread count.
+   * @param particles The Particles after a step, of 2 or 3 dimensions
+   * @param thread_pool The ThreadPool running the chunks, or nullptr to run them serially
+   */
+  template <int D>
+  void Update(const std::vector<BasicParticle<Scalar, D>>& particles,
+              ThreadPool* thread_pool = nullptr);
+
+  /**
+   * @return True once the fit and species temperatures have stayed settled for a full window
+   */
+  bool IsEquilibrated() const;
+
+  /**
+   * @return The step at which equilibrium was first detected, counting from 1
+   */
+  size_t GetEquilibriumStep() const;
+
+  /**
+   * @return The chi squared per degree of freedom of every Particle pooled, averaged over
+   *         the window
+   */
+  double GetWindowedChiSquaredPerDof() const;
+
+  /**
+   * A speed bin width covering the Maxwell-Boltzmann range of a type in a number of bins,
+   * rounded up to a multiple of 0.1 so axis labels stay readable
+   * @param type The particle type
+   * @param speed_ticks The number of bins
+   * @return The bin width, or 0 if the type has no Particles yet
+   */
+  double GetAdaptiveSpeedInterval(size_t type, size_t speed_ticks) const;
+
+  // Getters
+  const SpeciesFit& GetFit(size_t type) const;
+  size_t GetStepCount() const;
+
+ private:
+  SpeedAnalyticsSettings settings_;
+  std::vector<SpeciesFit> fits_;
+  size_t step_count_;
+  size_t equilibrium_step_;
+
+  // Per step pooled chi squared per degree of freedom and species temperatures in the window
+  std::deque<double> window_chi_squared_;
+  std::deque<std::vector<double>> window_temperatures_;
+  double window_chi_squared_sum_;
+  std::vector<double> window_temperature_sums_;
+
+  /**
+   * Adds the latest step to the window, dropping the oldest once it is full
+   * @param pooled_chi_squared_per_dof The chi squared per degree of freedom of this step
+   */
+  void UpdateWindow(double pooled_chi_squared_per_dof);
+};
+
+/**
+ * Steps a GasContainer until its speeds reach equilibrium
+ * @param container The GasContainer
+ * @param analytics The analytics fed with every step
+ * @param max_steps The most steps to run if equilibrium is never detected
+ * @return The number of steps run
+ */
+template <int D>
+size_t RunUntilEquilibrium(BasicGasContainer<D>& container, SpeedAnalytics& analytics,
+                           size_t max_steps);
+
+}  // namespace idealgas
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <core/particle.h>
+#include <core/thread_pool.h>
+
+namespace idealgas {
+
+/**
+ * Particle counts over fixed width speed bins, the last bin also holding every faster Particle
+ */
+class SpeedDistribution {
+ public:
+  /**
+   * Constructs an empty SpeedDistribution
+   * @param speed_ticks The number of speed bins
+   * @param speed_interval The width of each speed bin
+   */
+  SpeedDistribution(size_t speed_ticks, double speed_interval);
+
+  /**
+   * Clears the particle count in every bin
+   */
+  void Reset();
+
+  /**
+   * Counts a particle towards a certain frequency bin
+   * @param particle The counted particle, in 2 or 3 dimensions
+   */
+  template <int D>
+  void CountParticle(const BasicParticle<Scalar, D>& particle);
+
+  /**
+   * Adds the counts of another distribution with the same bins to this one
+   * @param other The other distribution
+   */
+  void Merge(const SpeedDistribution& other);
+
+  /**
+   * Changes the width of the speed bins, for ranges that adapt to the temperature
+   * @param speed_interval The width of each speed bin
+   */
+  void SetSpeedInterval(double speed_interval);
+
+  // Getters
+  const std::vector<size_t>& GetFrequencies() const;
+  size_t GetTotalFrequency() const;
+  size_t GetSpeedTicks() const;
+  double GetSpeedInterval() const;
+
+ private:
+  size_t speed_ticks_;
+  double speed_interval_;
+  std::vector<size_t> frequencies_;
+};
+
+/**
+ * Counts every Particle into the SpeedDistribution of its type. With a ThreadPool, each
+ * chunk counts into its own partial distributions, merged once at the end, so threads
+ * never share a counter.
+ * @param particles The Particles
+ * @param distributions The distribution of each type, counted on top of existing counts
+ * @param thread_pool The ThreadPool, or nullptr to count serially
+ */
+template <int D>
+void CountSpeeds(const std::vector<BasicParticle<Scalar, D>>& particles,
+                 std::vector<SpeedDistribution>& distributions, ThreadPool* thread_pool);
+
+}  // namespace idealgas
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <core/particle.h>
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * A fixed obstacle: a line segment, possibly one side of a polygon, or a circle
+ */
+struct Obstacle {
+  enum Shape { kSegment, kCircle };
+
+  Shape shape;
+  // The segment endpoints, or the circle center in start
+  glm::dvec2 start;
+  glm::dvec2 end;
+  double radius = 0;
+};
+
+/**
+ * A segment moving at a constant velocity until it has travelled a set distance.
+ * Particles bounce off it as off an infinitely heavy wall moving with it.
+ */
+struct Piston {
+  glm::dvec2 start;
+  glm::dvec2 end;
+  glm::dvec2 velocity;
+  double travel = 0;
+  double moved = 0;
+  // Momentum Particles have transferred to the piston along its normal since the last reset
+  double impulse = 0;
+  size_t steps = 0;
+
+  /**
+   * @return The mean force per unit length on the piston since the last reset, the 2D pressure
+   */
+  double GetPressure() const;
+};
+
+/**
+ * Internal walls, obstacles and pistons inside a GasContainer.
+ *
+ * Obstacles are baked into a uniform grid over the container, each cell listing the
+ * obstacles within reach of a Particle centered in it, so a Particle only tests the few
+ * obstacles near it however many there are. Pistons move every step, so they are few
+ * and tested directly.
+ *
+ * Loaded from a text config with one shape per line, in container coordinates:
+ *   segment x1 y1 x2 y2
+ *   circle x y radius
+ *   polygon x1 y1 x2 y2 x3 y3 ...   (closed, at least 3 corners)
+ *   piston x1 y1 x2 y2 vx vy travel
+ * Blank lines and lines starting with # are ignored.
+ */
+class StaticGeometry {
+ public:
+  /**
+   * Reads shapes from a config, adding them to any already loaded
+   * @param stream The config
+   * @return True if every line was read, false on the first malformed line
+   */
+  bool Load(std::istream& stream);
+
+  /**
+   * Reads shapes from a config file
+   * @param path The path of the config
+   * @return True if the file was read, false if it is missing or malformed
+   */
+  bool LoadFile(const std::string& path);
+
+  // Adders
+  void AddSegment(const glm::dvec2& start, const glm::dvec2& end);
+  void AddCircle(const glm::dvec2& center, double radius);
+  void AddPiston(const Piston& piston);
+
+  /**
+   * Cuts segments and pistons at the walls of a box, and removes every shape left entirely
+   * outside it. Must be followed by Bake.
+   * @param top_left_corner The top left corner of the box
+   * @param box_width The width of the box
+   * @param box_height The height of the box
+   */
+  void Clip(const glm::dvec2& top_left_corner, double box_width, double box_height);
+
+  /**
+   * Builds the obstacle grid. Must be called after adding obstacles and before Collide.
+   * @param top_left_corner The top left corner of the container
+   * @param box_width The width of the container
+   * @param box_height The height of the container
+   * @param max_radius The largest Particle radius
+   */
+  void Bake(const glm::dvec2& top_left_corner, double box_width, double box_height,
+            double max_radius);
+
+  /**
+   * Moves every piston that has not finished its travel by one step
+   */
+  void MovePistons();
+
+  /**
+   * Bounces a Particle off every obstacle and piston it touches while moving towards it
+   * @param particle The Particle
+   * @param piston_impulses Per piston, incremented by the momentum transferred to it
+   * @return The number of bounces
+   */
+  size_t Collide(Particle& particle, double* piston_impulses) const;
+
+  /**
+   * Adds the momentum transferred in one step to each piston
+   * @param piston_impulses Per piston, the momentum transferred this step
+   */
+  void AddPistonImpulses(const std::vector<double>& piston_impulses);
+
+  /**
+   * Clears the momentum transferred to every piston, starting a new pressure measurement
+   */
+  void ResetPistonImpulses();
+
+  /**
+   * @return True if there is nothing to collide with
+   */
+  bool IsEmpty() const;
+
+  /**
+   * @return The bytes allocated for the obstacles, pistons and the baked grid
+   */
+  size_t GetMemoryUsage() const;
+
+  // Getters
+  const std::vector<Obstacle>& GetObstacles() const;
+  const std::vector<Piston>& GetPistons() const;
+
+ private:
+  std::vector<Obstacle> obstacles_;
+  std::vector<Piston> pistons_;
+
+  glm::dvec2 grid_corner_;
+  double cell_size_ = 1;
+  size_t columns_ = 0;
+  size_t rows_ = 0;
+  // Obstacles near cell c are cell_obstacles_[cell_starts_[c]] up to cell_starts_[c + 1]
+  std::vector<size_t> cell_starts_;
+  std::vector<size_t> cell_obstacles_;
+
+  // The grid has at most this many cells along each side
+  static constexpr size_t kMaxGridSide = 256;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * The observables of one step, one row of a statistics log
+ */
+struct StepStatistics {
+  uint64_t step = 0;
+  double kinetic_energy = 0;
+  uint64_t particle_collisions = 0;
+  uint64_t wall_bounces = 0;
+  uint64_t obstacle_bounces = 0;
+  // Per particle type
+  std::vector<double> temperatures;
+  std::vector<double> speed_intervals;
+  // Per particle type, the counts of each speed bin
+  std::vector<std::vector<size_t>> speed_frequencies;
+};
+
+/**
+ * One column of a statistics log. Every value is 8 bytes; a column of width w holds a
+ * fixed size list of w values per row, stored row after row.
+ */
+struct ColumnSchema {
+  enum Type { kUInt64, kFloat64 };
+
+  std::string name;
+  Type type;
+  uint32_t width;
+};
+
+/**
+ * @param type_count The number of particle types
+ * @param speed_ticks The number of speed bins of each type
+ * @return The columns of a statistics log: step, kinetic_energy, particle_collisions,
+ * wall_bounces and obstacle_bounces, then temperature_t, speed_interval_t and
+ * speed_frequencies_t for each type t
+ */
+std::vector<ColumnSchema> MakeStatisticsSchema(size_t type_count, size_t speed_ticks);
+
+/**
+ * Appends StepStatistics to a columnar log, one row per step.
+ *
+ * Rows are buffered column by column into row groups. Full row groups are handed to a
+ * background thread, so the simulation thread never waits on the disk. The file holds the
+ * schema, then each row group as one contiguous, 8 byte aligned buffer per column, then a
+ * footer indexing the row groups, so a reader can map any column of any row group in place.
+ */
+class StatisticsWriter {
+ public:
+  /**
+   * Opens a log and writes its schema
+   * @param path The path of the log
+   * @param type_count The number of particle types
+   * @param speed_ticks The number of speed bins of each type
+   * @param rows_per_group The rows buffered before a row group is written
+   */
+  StatisticsWriter(const std::string& path, size_t type_count, size_t speed_ticks,
+                   size_t rows_per_group = 4096);
+
+  /**
+   * Closes the log
+   */
+  ~StatisticsWriter();
+
+  StatisticsWriter(const StatisticsWriter&) = delete;
+  StatisticsWriter& operator=(const StatisticsWriter&) = delete;
+
+  /**
+   * Buffers one row, handing the row group to the background thread once it is full
+   * @param statistics The observables of a step, with as many types and bins as the schema
+   */
+  void Append(const StepStatistics& statistics);
+
+  /**
+   * Writes the last partial row group and the footer, then stops the background thread.
+   * Later rows are dropped.
+   */
+  void Close();
+
+  /**
+   * @return True if the log was opened and every write so far succeeded
+   */
+  bool IsGood() const;
+
+  // Getters
+  const std::vector<ColumnSchema>& GetSchema() const;
+
+ private:
+  // Values of each column, column after column
+  typedef std::vector<std::vector<uint64_t>> RowGroup;
+
+  std::vector<ColumnSchema> schema_;
+  size_t rows_per_group_;
+  RowGroup current_group_;
+  size_t current_rows_ = 0;
+  bool closed_ = false;
+
+  // Shared with the background thread
+  std::ofstream stream_;
+  std::atomic<bool> good_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_condition_;
+  std::deque<std::pair<RowGroup, size_t>> queued_groups_;
+  bool stopping_ = false;
+  // Offset and row count of each written row group, only touched by the background thread
+  std::vector<std::pair<uint64_t, uint64_t>> row_group_index_;
+  std::thread writer_thread_;
+
+  /**
+   * Hands the current row group to the background thread
+   */
+  void QueueCurrentGroup();
+
+  /**
+   * Writes queued row groups until stopped, then writes the footer
+   */
+  void WriterLoop();
+};
+
+/**
+ * A statistics log read back from disk. The file is memory mapped, so opening a log only
+ * touches its header and footer, and a column is paged in when it is first read. Where
+ * mapping is unavailable the whole file is read into one buffer instead. Either way,
+ * columns are returned as pointers into the file without decoding.
+ */
+class StatisticsReader {
+ public:
+  StatisticsReader() = default;
+
+  /**
+   * Unmaps the log
+   */
+  ~StatisticsReader();
+
+  StatisticsReader(const StatisticsReader&) = delete;
+  StatisticsReader& operator=(const StatisticsReader&) = delete;
+
+  /**
+   * Reads a log written by StatisticsWriter
+   * @param path The path of the log
+   * @return True if the log was read, false if it is missing, truncated or malformed
+   */
+  bool Read(const std::string& path);
+
+  /**
+   * @param name The name of a column
+   * @return The index of the column, or the column count if there is none by that name
+   */
+  size_t FindColumn(const std::string& name) const;
+
+  /**
+   * @param group The index of a row group
+   * @param column The index of a kUInt64 column
+   * @return The rows of the column in the group, width values per row, or nullptr if
+   * the column is not a kUInt64 column
+   */
+  const uint64_t* GetUInt64Column(size_t group, size_t column) const;
+
+  /**
+   * @param group The index of a row group
+   * @param column The index of a kFloat64 column
+   * @return The rows of the column in the group, width values per row, or nullptr if
+   * the column is not a kFloat64 column
+   */
+  const double* GetFloat64Column(size_t group, size_t column) const;
+
+  /**
+   * @return True if the log is memory mapped, false if it was read into a buffer
+   */
+  bool IsMapped() const;
+
+  // Getters
+  const std::vector<ColumnSchema>& GetSchema() const;
+  size_t GetRowGroupCount() const;
+  size_t GetRowCount(size_t group) const;
+  size_t GetRowCount() const;
+
+ private:
+  std::vector<ColumnSchema> schema_;
+  // The file, either mapped or in bytes_
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  void* mapping_ = nullptr;
+  // The fallback buffer, allocated by new, so aligned for any value
+  std::vector<char> bytes_;
+  // Byte offset of each column of each row group, and the rows of each group
+  std::vector<std::vector<size_t>> column_offsets_;
+  std::vector<size_t> row_counts_;
+
+  /**
+   * Maps a file, or reads it into the fallback buffer if it cannot be mapped
+   * @param path The path of the file
+   * @return True if the file was opened
+   */
+  bool Load(const std::string& path);
+
+  /**
+   * Unmaps the file, or frees the fallback buffer
+   */
+  void Release();
+};
+
+}  // namespace idealgas
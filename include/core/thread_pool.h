@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * A fixed set of worker threads, each with its own task queue.
+ * Idle workers steal from the front of other queues, so uneven tasks still balance out.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Constructs a ThreadPool and starts its workers
+   * @param thread_count The number of worker threads, 0 for one per hardware thread
+   */
+  explicit ThreadPool(size_t thread_count = 0);
+
+  /**
+   * Stops and joins every worker
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Runs a body over [begin, end) in chunks of at most grain_size indices,
+   * returning once every chunk has finished. The calling thread also runs chunks.
+   * @param begin The first index
+   * @param end One past the last index
+   * @param grain_size The largest number of indices in one chunk
+   * @param body Called with the [begin, end) range of each chunk
+   */
+  void ParallelFor(size_t begin, size_t end, size_t grain_size,
+                   const std::function<void(size_t, size_t)>& body);
+
+  /**
+   * Picks a ParallelFor grain size giving every thread a few chunks to balance load,
+   * rounded up to a multiple of an alignment so chunks split an array on whole cache lines
+   * @param count The number of indices
+   * @param alignment The number of indices the grain size must be a multiple of
+   * @return The grain size
+   */
+  size_t GetGrainSize(size_t count, size_t alignment) const;
+
+  /**
+   * @return The number of worker threads
+   */
+  size_t GetThreadCount() const;
+
+ private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_condition_;
+  std::atomic<size_t> queued_tasks_;
+  bool stopping_;
+
+  /**
+   * Runs tasks on a worker until the pool stops
+   * @param worker_index The index of the worker's own queue
+   */
+  void WorkerLoop(size_t worker_index);
+
+  /**
+   * Takes a task from the back of a queue, or steals from the front of another
+   * @param queue_index The index of the preferred queue
+   * @param task Set to the taken task
+   * @return True if a task was taken
+   */
+  bool TakeTask(size_t queue_index, std::function<void()>& task);
+};
+
+}  // namespace idealgas
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <core/particle_span.h>
+
+#include <array>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * Brute force search for touching pairs of Particles, for gases too small to repay a
+ * neighbour list. Instead of streaming every Particle past each one, the Particles are
+ * copied into one array per coordinate and compared a tile against a tile, two tiles
+ * fitting in the L1 cache together. Each row of a tile is a branch-free loop over squared
+ * distances that the compiler vectorises, and only rows with a hit are compacted into the
+ * list of pairs, which are resolved after the search.
+ */
+template <int D>
+class BasicTiledPairKernel {
+ public:
+  typedef BasicParticle<Scalar, D> Particle;
+
+  /**
+   * Finds every pair of Particles within the sum of their radii of each other.
+   * Pairs just beyond it may be included, so each still needs an exact check.
+   * @param particles The Particles
+   */
+  void FindPairs(ParticleSpan<const Particle> particles);
+
+  /**
+   * @return The pairs of the last search, ordered by smaller then larger index, which
+   *         visits pairs exactly as the brute force loop does
+   */
+  const std::vector<std::pair<size_t, size_t>>& GetPairs() const;
+
+  /**
+   * @return The bytes allocated for the coordinate arrays and the pairs
+   */
+  size_t GetMemoryUsage() const;
+
+ private:
+  // Particles per tile. In double precision 3D a tile of coordinates and radii is 8 KB.
+  static const size_t kTileSize = 256;
+
+  // Coordinates along each axis and radii, one array each
+  std::array<std::vector<Scalar>, D> coordinates_;
+  std::vector<Scalar> radii_;
+  std::vector<std::pair<size_t, size_t>> pairs_;
+};
+
+/**
+ * The tiled pair kernels of 2D and 3D Simulations
+ */
+typedef BasicTiledPairKernel<2> TiledPairKernel;
+typedef BasicTiledPairKernel<3> TiledPairKernel3D;
+
+}  // namespace idealgas
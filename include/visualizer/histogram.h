@@ -1,6 +1,6 @@
 #pragma once
 
-#include <core/particle.h>
+#include <core/speed_distribution.h>
 
 #include "cinder/gl/gl.h"
 
@@ -15,7 +15,7 @@ class Histogram {
  public:
   /**
    * Constructs a Histogram based on the given number of ticks on each axis
-   * The interval of the frequency bins and the background color
+   * The initial interval of the frequency bins and the background color
    * @param speed_ticks
    * @param speed_interval
    * @param frequency_ticks
@@ -39,22 +39,47 @@ class Histogram {
 
   /**
    * Counts a particle towards a certain frequency bin
-   * @param particle The incremented particle
+   * @param particle The incremented particle, of 2 or 3 dimensions
    */
-  void CountParticle(const Particle& particle);
+  template <int D>
+  void CountParticle(const BasicParticle<Scalar, D>& particle);
+
+  /**
+   * Replaces the particle counts and speed bins with ones counted elsewhere
+   * @param distribution The counted distribution
+   */
+  void SetDistribution(const SpeedDistribution& distribution);
+
+  /**
+   * Changes the width of the speed bins, relabelling the speed axis
+   * @param speed_interval The width of each speed bin
+   */
+  void SetSpeedInterval(double speed_interval);
+
+  /**
+   * @return The particle count in each frequency bin
+   */
+  const SpeedDistribution& GetDistribution() const;
 
  private:
   const size_t kSpeedTicks;
-  const double kSpeedInterval;
   const size_t kFrequencyTicks;
   const ci::Color kHistogramColor;
-  std::vector<size_t> frequencies_;
+  SpeedDistribution distribution_;
 
-  // Labels and Font setting
+  // Labels
   const std::string kXLabel = "Speed";
   const std::string kYLabel = "Frequency";
-  const ci::Font kAxisLabelFont = ci::Font("Arial", 20);
-  const ci::Font kTickLabelFont = ci::Font("Arial", 15);
+
+  /**
+   * @return The font of the axis labels, loaded on first use and shared by every Histogram
+   */
+  static const ci::Font& GetAxisLabelFont();
+
+  /**
+   * @return The font of the tick labels, loaded on first use and shared by every Histogram
+   */
+  static const ci::Font& GetTickLabelFont();
 
   /**
    * Draws the Histogram background
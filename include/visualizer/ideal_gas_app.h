@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "cinder/app/App.h"
 #include "cinder/app/RendererGl.h"
 #include "cinder/gl/gl.h"
@@ -29,13 +31,43 @@ class IdealGasApp : public ci::app::App {
    */
   void update() override;
 
+  /**
+   * Changes the gas between frames: number keys select a particle type, + and - add and
+   * remove Particles of it, h and c heat and cool the gas, and the arrow keys resize the box
+   * @param event The key pressed
+   */
+  void keyDown(ci::app::KeyEvent event) override;
+
  private:
   const double kWindowSize = 1000;
   const double kMargin = 100;
   const double kBoxWidth = 600;
   const double kBoxHeight = 600;
+  const double kMinBoxSize = 100;
+
+  // Runtime control steps
+  const size_t kParticleBatchSize = 10;
+  const double kHeatingFactor = 1.1;
+  const double kBoxResizeStep = 20;
 
-  Simulation simulation_;
+  // Exactly one is set, by the IDEALGAS_DIMENSIONS environment variable
+  std::unique_ptr<Simulation> simulation_;
+  std::unique_ptr<Simulation3D> simulation_3d_;
+
+  // The particle type added and removed by the keyboard, and the current box size
+  size_t selected_type_ = 0;
+  double box_width_ = kBoxWidth;
+  double box_height_ = kBoxHeight;
+  // The memory report is printed once, at startup
+  bool memory_reported_ = false;
+
+  /**
+   * Applies a key press to the Simulation
+   * @param simulation The Simulation
+   * @param event The key pressed
+   */
+  template <int D>
+  void ApplyKey(BasicSimulation<D>& simulation, const ci::app::KeyEvent& event);
 };
 
 }  // namespace visualizer
@@ -1,7 +1,19 @@
 #pragma once
 
-#include <core/particle.h>
+#include <core/density_field.h>
+#include <core/gas_container.h>
+#include <core/metrics_exporter.h>
+#include <core/replay_log.h>
+#include <core/snapshot_publisher.h>
+#include <core/speed_analytics.h>
+#include <core/statistics_log.h>
+#include <core/thread_pool.h>
 
+#include <ctime>
+#include <memory>
+
+#include "cinder/Surface.h"
+#include "cinder/gl/Texture.h"
 #include "cinder/gl/gl.h"
 #include "histogram.h"
 
@@ -10,18 +22,25 @@ namespace idealgas {
 namespace visualizer {
 
 /**
- * Simulation of a ideal gas experiment
+ * Simulation of a ideal gas experiment in D dimensions. A 3D gas is drawn as seen
+ * along the z axis, nearer Particles over and brighter than farther ones.
  */
-class Simulation {
+template <int D>
+class BasicSimulation {
  public:
+  typedef BasicParticle<Scalar, D> Particle;
+
   /**
    * Constructs a Simulation based on the given box size and number of particles
    * @param top_left_corner The coordinate of the top left corner of the container
    * @param box_width The width of the gas container
-   * @param box_height The height of the gas container
+   * @param box_height The height of the gas container, and its depth in 3D
+   * @param thread_count The threads running the per-particle passes, 0 for one per hardware thread
+   * @param seed The seed of the random initial Particles, the current time by default
    */
-  Simulation(const glm::vec2 &top_left_corner,
-             double box_width, double box_height);
+  BasicSimulation(const glm::vec2 &top_left_corner,
+                  double box_width, double box_height, size_t thread_count = 0,
+                  unsigned int seed = (unsigned int)time(0));
 
   /**
    * Draws the next frame of the Simulation
@@ -33,46 +52,177 @@ class Simulation {
    */
   void Update();
 
- private:
-  std::vector<Particle> particles_;
-  std::vector<Histogram> histograms_;
+  /**
+   * @return The Particles currently in the Simulation
+   */
+  const std::vector<Particle>& GetParticles() const;
 
-  // Simulation view settings
-  glm::vec2 top_left_corner_;
-  double box_width_;
-  double box_height_;
+  /**
+   * @return The total kinetic energy of every Particle in the Simulation
+   */
+  Scalar GetKineticEnergy() const;
 
-  // Default particle settings
-  const double kMaxSpeedFactor = 0.2;
-  struct ParticleConfig {
-    size_t type;
-    ci::Color color;
-    float radius;
-    double mass;
-    size_t amount;
-
-    ParticleConfig(size_t type, ci::Color color, float radius, double mass, size_t amount) :
-            type(type), color(color), radius(radius), mass(mass), amount(amount) {};
-  };
+  /**
+   * Adds randomly placed Particles of one of the default types before the next step
+   * @param type The index of the type in the default particle settings
+   * @param amount The number of Particles to add
+   * @return True if they were added, false if there is no such type
+   */
+  bool AddParticles(size_t type, size_t amount);
+
+  /**
+   * Removes the last Particles of a type before the next step
+   * @param type The type of the Particles
+   * @param amount The most Particles to remove
+   * @return The number of Particles removed
+   */
+  size_t RemoveParticles(size_t type, size_t amount);
+
+  /**
+   * Heats or cools the gas by scaling every velocity before the next step
+   * @param factor The factor of every velocity
+   */
+  void ScaleVelocities(double factor);
+
+  /**
+   * Moves the walls opposite the top left corner before the next step, cutting static
+   * geometry at them and fitting the density field to the new box
+   * @param box_width The new width of the gas container
+   * @param box_height The new height of the gas container, and its depth in 3D
+   * @return True if the box was resized, false if it would be narrower than a Particle
+   */
+  bool ResizeBox(double box_width, double box_height);
+
+  /**
+   * @return The number of default particle types
+   */
+  size_t GetParticleTypeCount() const;
+
+  /**
+   * Pins the state published after the latest step. Safe to call from any
+   * thread while Update keeps running.
+   * @return The snapshot View, invalid before the first Update
+   */
+  SnapshotPublisher::View AcquireSnapshot() const;
+
+  /**
+   * @return The Maxwell-Boltzmann fit of each particle type and the equilibrium state
+   */
+  const SpeedAnalytics& GetSpeedAnalytics() const;
+
+  /**
+   * Adds internal walls, obstacles and pistons from a config, in box coordinates
+   * relative to the top left corner
+   * @param path The path of the config, in the format read by StaticGeometry
+   * @return True if the config was read, false if it was not, in 3D, or while recording
+   *         a replay, whose header already holds the geometry
+   */
+  bool LoadStaticGeometry(const std::string& path);
+
+  /**
+   * Records the seed, settings and static geometry to a replay log, then every following
+   * edit and a hash of the Particles after each step, so that ReplayLog can rerun and
+   * verify the Simulation. Must be called before the first Update or edit.
+   * @param path The path of the log
+   * @return True if the log was opened, false if it was not or the Simulation has already
+   *         stepped or been edited
+   */
+  bool RecordReplay(const std::string& path);
+
+  /**
+   * Appends the observables of every following step, including each type's speed
+   * histogram, to a columnar statistics log, replacing any log exported to before
+   * @param path The path of the log
+   * @return True if the log was opened
+   */
+  bool ExportStatistics(const std::string& path);
+
+  /**
+   * Serves live metrics on a loopback TCP port, in the Prometheus text format
+   * @param port The port, or 0 for any free port
+   * @return True if the endpoint is listening
+   */
+  bool ServeMetrics(uint16_t port);
+
+  /**
+   * Serves live metrics on a Unix domain socket, in the Prometheus text format
+   * @param socket_path The path of the socket
+   * @return True if the endpoint is listening
+   */
+  bool ServeMetrics(const std::string& socket_path);
+
+  /**
+   * @return The counters and gauges updated every step
+   */
+  const SimulationMetrics& GetMetrics() const;
 
+  /**
+   * Publishes snapshot positions in 16-bit fixed point within the box, halving their size
+   * @param enabled True for fixed-point positions
+   */
+  void SetQuantizedSnapshots(bool enabled);
+
+  /**
+   * @return The bytes held by the Particles and each subsystem, including the snapshots
+   */
+  MemoryReport GetMemoryReport() const;
+
+ private:
+  // The timed phases of Update, indexing SimulationMetrics phase times
+  enum Phase { kPhysicsPhase, kAnalyticsPhase, kDensityPhase, kPublishPhase };
+
+  // Default particle settings
   std::vector<ParticleConfig> particle_configs_ {
           ParticleConfig(0, "red", 20, 100, 20),
           ParticleConfig(1, "blue", 10, 50, 10),
           ParticleConfig(2, "green", 10, 500, 5),
           ParticleConfig(3, "yellow", 20, 500, 5)};
 
+  // When construction started, for the startup time
+  std::chrono::steady_clock::time_point construction_start_;
+  std::chrono::nanoseconds construction_time_;
+
+  // Declared before the container, which initialises its Particles on it
+  ThreadPool thread_pool_;
+  BasicGasContainer<D> container_;
+  std::vector<Histogram> histograms_;
+  // Reused every step to count the speeds of each type in parallel
+  std::vector<SpeedDistribution> speed_distributions_;
+  SpeedAnalytics speed_analytics_;
+  size_t step_count_ = 0;
+  SnapshotPublisher snapshot_publisher_;
+  bool quantized_snapshots_ = false;
+  SimulationMetrics metrics_;
+  MetricsExporter metrics_exporter_;
+  std::unique_ptr<StatisticsWriter> statistics_writer_;
+  std::unique_ptr<BasicReplayRecorder<D>> replay_recorder_;
+  // Whether Particles, velocities or the box have changed since construction
+  bool edited_ = false;
+  // Reused every step to fill a row of the statistics log
+  StepStatistics step_statistics_;
+
   // Default histogram settings
   const size_t kSpeedTicks = 8;
   const double kSpeedInterval = 0.5;
   const size_t kFrequencyTicks = 6;
+  // Fit the speed axis to each type's temperature instead of kSpeedInterval
+  const bool kAdaptiveSpeedInterval = true;
   const float kHistogramWidth = 150;
   const float kHistogramHeight = 150;
   const float kHistogramSpacing = 90;
 
-  /**
-   * Initialises a random set of Particles within the container
-   */
-  void InitializeParticles();
+  // Above this many Particles, the box is drawn as a density heatmap instead of circles
+  const size_t kDensityFieldThreshold = 200000;
+  const float kDensityCellSize = 2;
+  // How far the hottest heatmap cells are whitened from the colors of their types
+  const float kHeatWhitening = 0.8f;
+
+  // Brightness of the farthest 3D Particles, relative to the nearest
+  const float kFarBrightness = 0.35f;
+
+  DensityField density_field_;
+  mutable ci::Surface8u density_surface_;
+  mutable ci::gl::Texture2dRef density_texture_;
 
   /**
    * Initialises a set of empty Histograms, one for each particle type
@@ -80,29 +230,87 @@ class Simulation {
   void InitializeHistograms();
 
   /**
-   * Updates the position of every Particle in the Simulation
+   * Updates the Histogram
    */
-  void ProcessParticleMovement();
+  void UpdateHistogram();
 
   /**
-   * Updates the velocity of every Particle in the Simulation based on collisions
+   * Copies the Particles and Histogram counts into a back buffer and publishes it
    */
-  void ProcessParticleCollision();
+  void PublishSnapshot();
 
   /**
-   * Updates the Histogram
+   * Adds the time since the start of a phase to the metrics
+   * @param phase The phase that just ended
+   * @param start When the phase started
+   * @return When the phase ended, the start of the next phase
    */
-  void UpdateHistogram();
+  std::chrono::steady_clock::time_point EndPhase(
+          Phase phase, std::chrono::steady_clock::time_point start);
+
+  /**
+   * Updates the metrics gauges and counters after a step
+   */
+  void UpdateMetrics();
 
   /**
-   * Generates a random double value in a given range
-   * @param min The minimum possible value
-   * @param max The maximum possible value
-   * @return A random double value
+   * Appends the observables of the step to the statistics log, if one is open
    */
-  inline double GenerateRandomDouble(double min, double max);
+  void RecordStatistics();
+
+  /**
+   * Makes an edit between steps, recording it to the replay log if one is open
+   * @param edit The edit
+   * @return True if the container changed
+   */
+  bool ApplyEdit(const BasicReplayEdit<D>& edit);
+
+  /**
+   * @param top_left_corner The 2D top left corner of the container
+   * @return The corner of the container with the smallest coordinates, at depth 0 in 3D
+   */
+  static glm::vec<D, float> GetContainerCorner(const glm::vec2& top_left_corner);
+
+  /**
+   * @param box_width The width of the container
+   * @param box_height The height of the container, and its depth in 3D
+   * @return The extent of the container along each axis
+   */
+  static glm::vec<D, double> GetContainerSize(double box_width, double box_height);
+
+  /**
+   * Draws every Particle as a circle. 3D Particles are drawn from the farthest
+   * to the nearest, dimmed with depth.
+   */
+  void DrawParticles() const;
+
+  /**
+   * Draws the obstacles and pistons
+   */
+  void DrawStaticGeometry() const;
+
+  /**
+   * @return True if there are too many Particles to draw each one
+   */
+  bool UsesDensityField() const;
+
+  /**
+   * Bins the current Particles into the density field
+   */
+  void BuildDensityField();
+
+  /**
+   * Draws the density field as a single texture over the gas box, each cell
+   * blending the colors of the particle types in it, whitening with temperature
+   * and brightening with density
+   * @param gas_box The area of the gas container
+   */
+  void DrawDensityField(const ci::Rectf& gas_box) const;
 };
 
+typedef BasicSimulation<2> Simulation;
+typedef BasicSimulation<3> Simulation3D;
+
 }  // namespace visualizer
 
 }  // namespace idealgas
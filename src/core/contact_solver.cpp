@@ -0,0 +1,126 @@
+#include <core/contact_solver.h>
+
+#include <core/memory_report.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+template <int D>
+BasicContactSolver<D>::BasicContactSolver(const ContactSolverSettings& settings)
+    : settings_(settings) {}
+
+template <int D>
+void BasicContactSolver<D>::Solve(ParticleSpan<Particle> particles,
+                                  const std::vector<std::pair<size_t, size_t>>& pairs) {
+  stats_ = ContactSolverStats();
+  contacts_.clear();
+
+  for (const std::pair<size_t, size_t>& pair : pairs) {
+    const Particle& particle_a = particles[pair.first];
+    const Particle& particle_b = particles[pair.second];
+    typename Particle::Vec displacement = particle_a.GetPosition() - particle_b.GetPosition();
+    Scalar distance = glm::length(displacement);
+    Scalar total_mass = particle_a.GetMass() + particle_b.GetMass();
+    if (distance > particle_a.GetRadius() + particle_b.GetRadius() ||
+        distance <= 0 || total_mass <= 0) {
+      continue;
+    }
+
+    Contact contact;
+    contact.index_a = pair.first;
+    contact.index_b = pair.second;
+    contact.normal = displacement / distance;
+    contact.share_a = particle_b.GetMass() / total_mass;
+    contact.share_b = particle_a.GetMass() / total_mass;
+    // Approaching pairs bounce back elastically, the rest only must not approach
+    Scalar normal_velocity = dot(particle_a.GetVelocity() - particle_b.GetVelocity(),
+                                 contact.normal);
+    contact.target_velocity = std::max(-normal_velocity, Scalar(0));
+    contact.accumulated_change = 0;
+    contacts_.push_back(contact);
+  }
+  stats_.contact_count = contacts_.size();
+
+  SolveVelocities(particles);
+  SolvePositions(particles);
+}
+
+template <int D>
+size_t BasicContactSolver<D>::GetMemoryUsage() const {
+  return GetAllocatedBytes(contacts_);
+}
+
+template <int D>
+const ContactSolverSettings& BasicContactSolver<D>::GetSettings() const {
+  return settings_;
+}
+
+template <int D>
+const ContactSolverStats& BasicContactSolver<D>::GetStats() const {
+  return stats_;
+}
+
+template <int D>
+void BasicContactSolver<D>::SolveVelocities(ParticleSpan<Particle> particles) {
+  for (size_t iteration = 0; iteration < settings_.max_velocity_iterations; iteration++) {
+    double residual = 0;
+    for (Contact& contact : contacts_) {
+      Particle& particle_a = particles[contact.index_a];
+      Particle& particle_b = particles[contact.index_b];
+      Scalar normal_velocity = dot(particle_a.GetVelocity() - particle_b.GetVelocity(),
+                                   contact.normal);
+
+      // Clamp the running total, so a contact can push but never pull
+      Scalar previous_change = contact.accumulated_change;
+      contact.accumulated_change = std::max(
+          previous_change + contact.target_velocity - normal_velocity, Scalar(0));
+      Scalar change = contact.accumulated_change - previous_change;
+
+      particle_a.SetVelocity(particle_a.GetVelocity() + contact.normal * (change * contact.share_a));
+      particle_b.SetVelocity(particle_b.GetVelocity() - contact.normal * (change * contact.share_b));
+      residual = std::max(residual, double(std::abs(change)));
+    }
+
+    stats_.velocity_iterations = iteration + 1;
+    stats_.velocity_residual = residual;
+    if (residual <= settings_.velocity_tolerance) {
+      break;
+    }
+  }
+}
+
+template <int D>
+void BasicContactSolver<D>::SolvePositions(ParticleSpan<Particle> particles) {
+  for (size_t iteration = 0; iteration < settings_.max_position_iterations; iteration++) {
+    double max_overlap = 0;
+    for (const Contact& contact : contacts_) {
+      Particle& particle_a = particles[contact.index_a];
+      Particle& particle_b = particles[contact.index_b];
+      typename Particle::Vec displacement = particle_a.GetPosition() - particle_b.GetPosition();
+      Scalar distance = glm::length(displacement);
+      Scalar overlap = particle_a.GetRadius() + particle_b.GetRadius() - distance;
+      if (overlap <= 0 || distance <= 0) {
+        continue;
+      }
+      max_overlap = std::max(max_overlap, double(overlap));
+
+      // Lighter Particles move further, as with the impulses
+      typename Particle::Vec correction = displacement *
+          (overlap * Scalar(settings_.overlap_correction) / distance);
+      particle_a.SetPosition(particle_a.GetPosition() + correction * contact.share_a);
+      particle_b.SetPosition(particle_b.GetPosition() - correction * contact.share_b);
+    }
+
+    stats_.position_iterations = iteration + 1;
+    stats_.max_overlap = max_overlap;
+    if (max_overlap <= settings_.overlap_tolerance) {
+      break;
+    }
+  }
+}
+
+template class BasicContactSolver<2>;
+template class BasicContactSolver<3>;
+
+}  // namespace idealgas
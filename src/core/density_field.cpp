@@ -0,0 +1,133 @@
+#include <core/density_field.h>
+
+#include <core/memory_report.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+DensityField::DensityField(size_t columns, size_t rows, size_t type_count) :
+        columns_(std::max<size_t>(1, columns)), rows_(std::max<size_t>(1, rows)),
+        type_count_(std::max<size_t>(1, type_count)), max_count_(0), mean_temperature_(0),
+        counts_(columns_ * rows_, 0),
+        type_counts_(columns_ * rows_ * type_count_, 0),
+        energies_(columns_ * rows_, 0) {}
+
+template <int D>
+void DensityField::Build(const std::vector<BasicParticle<Scalar, D>>& particles,
+                         const glm::vec2& top_left_corner, double box_width, double box_height,
+                         ThreadPool& thread_pool) {
+  size_t cell_count = columns_ * rows_;
+  double column_scale = columns_ / box_width;
+  double row_scale = rows_ / box_height;
+
+  // One chunk per thread, each binning into its own partial grid, so no
+  // two threads ever write the same counter
+  size_t chunk_count = std::max<size_t>(1, std::min(thread_pool.GetThreadCount(),
+                                                    particles.size() / 4096 + 1));
+  size_t grain_size = std::max<size_t>(1, (particles.size() + chunk_count - 1) / chunk_count);
+  chunk_count = std::max<size_t>(1, (particles.size() + grain_size - 1) / grain_size);
+
+  // Only allocates when the grid or the thread count grows, each chunk zeroing its own grid
+  partial_type_counts_.resize(chunk_count * cell_count * type_count_);
+  partial_energies_.resize(chunk_count * cell_count);
+  if (particles.empty()) {
+    std::fill(partial_type_counts_.begin(), partial_type_counts_.end(), 0);
+    std::fill(partial_energies_.begin(), partial_energies_.end(), 0);
+  }
+
+  thread_pool.ParallelFor(0, particles.size(), grain_size, [&](size_t begin, size_t end) {
+    size_t chunk = begin / grain_size;
+    size_t* type_counts = partial_type_counts_.data() + chunk * cell_count * type_count_;
+    double* energies = partial_energies_.data() + chunk * cell_count;
+    std::fill(type_counts, type_counts + cell_count * type_count_, 0);
+    std::fill(energies, energies + cell_count, 0);
+    for (size_t i = begin; i < end; i++) {
+      const BasicParticle<Scalar, D>& particle = particles[i];
+      double column = (particle.GetPosition().x - top_left_corner.x) * column_scale;
+      double row = (particle.GetPosition().y - top_left_corner.y) * row_scale;
+      size_t cell = size_t(glm::clamp(row, 0.0, double(rows_ - 1))) * columns_ +
+                    size_t(glm::clamp(column, 0.0, double(columns_ - 1)));
+
+      type_counts[cell * type_count_ + std::min(particle.GetType(), type_count_ - 1)]++;
+      energies[cell] += particle.GetMass() *
+                        glm::dot(particle.GetVelocity(), particle.GetVelocity()) / D;
+    }
+  });
+
+  // Merge the partial grids, rows split over the threads
+  thread_pool.ParallelFor(0, rows_, 16, [&](size_t begin, size_t end) {
+    for (size_t cell = begin * columns_; cell < end * columns_; cell++) {
+      size_t count = 0;
+      double energy = 0;
+      for (size_t type = 0; type < type_count_; type++) {
+        size_t type_count = 0;
+        for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+          type_count += partial_type_counts_[(chunk * cell_count + cell) * type_count_ + type];
+        }
+        type_counts_[cell * type_count_ + type] = type_count;
+        count += type_count;
+      }
+      for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+        energy += partial_energies_[chunk * cell_count + cell];
+      }
+      counts_[cell] = count;
+      energies_[cell] = energy;
+    }
+  });
+
+  max_count_ = counts_.empty() ? 0 : *std::max_element(counts_.begin(), counts_.end());
+  double total_energy = 0;
+  for (double energy : energies_) {
+    total_energy += energy;
+  }
+  mean_temperature_ = particles.empty() ? 0 : total_energy / particles.size();
+}
+
+size_t DensityField::GetColumns() const {
+  return columns_;
+}
+
+size_t DensityField::GetRows() const {
+  return rows_;
+}
+
+size_t DensityField::GetTypeCount() const {
+  return type_count_;
+}
+
+size_t DensityField::GetCount(size_t column, size_t row) const {
+  return counts_[row * columns_ + column];
+}
+
+size_t DensityField::GetTypeCount(size_t column, size_t row, size_t type) const {
+  return type_counts_[(row * columns_ + column) * type_count_ + type];
+}
+
+size_t DensityField::GetMemoryUsage() const {
+  return GetAllocatedBytes(counts_) + GetAllocatedBytes(type_counts_) +
+         GetAllocatedBytes(energies_) + GetAllocatedBytes(partial_type_counts_) +
+         GetAllocatedBytes(partial_energies_);
+}
+
+size_t DensityField::GetMaxCount() const {
+  return max_count_;
+}
+
+double DensityField::GetTemperature(size_t column, size_t row) const {
+  size_t count = GetCount(column, row);
+  return count > 0 ? energies_[row * columns_ + column] / count : 0;
+}
+
+double DensityField::GetMeanTemperature() const {
+  return mean_temperature_;
+}
+
+template void DensityField::Build(const std::vector<Particle>& particles,
+                                  const glm::vec2& top_left_corner, double box_width,
+                                  double box_height, ThreadPool& thread_pool);
+template void DensityField::Build(const std::vector<Particle3D>& particles,
+                                  const glm::vec2& top_left_corner, double box_width,
+                                  double box_height, ThreadPool& thread_pool);
+
+}  // namespace idealgas
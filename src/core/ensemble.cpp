@@ -0,0 +1,130 @@
+#include <core/ensemble.h>
+
+#include <core/observables.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace idealgas {
+
+Ensemble::Ensemble(const std::vector<ParticleConfig>& particle_configs,
+                   double box_width, double box_height,
+                   size_t replica_count, unsigned int base_seed, size_t thread_count)
+    : particle_type_count_(0),
+      thread_pool_(thread_count),
+      replica_steps_per_second_(0) {
+  std::vector<ParticleConfig> scratch_configs = particle_configs;
+  size_t replica_size = 0;
+  for (ParticleConfig& particle_config : scratch_configs) {
+    particle_type_count_ = std::max(particle_type_count_, particle_config.type + 1);
+    replica_size += particle_config.amount;
+    particle_config.amount = 0;
+  }
+
+  // Each replica is drawn by a GasContainer with its seed, then copied into the shared array
+  particles_.reserve(replica_count * replica_size);
+  replica_offsets_.reserve(replica_count + 1);
+  replica_offsets_.push_back(0);
+  for (size_t i = 0; i < replica_count; i++) {
+    GasContainer replica(particle_configs, glm::vec2(0, 0), box_width, box_height,
+                         base_seed + (unsigned int) i);
+    particles_.insert(particles_.end(), replica.GetParticles().begin(),
+                      replica.GetParticles().end());
+    replica_offsets_.push_back(particles_.size());
+  }
+
+  // The same configs without Particles give the same skin and kernel threshold
+  replicas_per_chunk_ = thread_pool_.GetGrainSize(replica_count, 1);
+  size_t chunk_count = (replica_count + replicas_per_chunk_ - 1) / replicas_per_chunk_;
+  workers_.reserve(chunk_count);
+  for (size_t i = 0; i < chunk_count; i++) {
+    workers_.emplace_back(scratch_configs, glm::vec2(0, 0), box_width, box_height, base_seed);
+  }
+}
+
+void Ensemble::Update(size_t steps) {
+  auto start = std::chrono::steady_clock::now();
+
+  // Chunks start at multiples of the grain size, so each has its own scratch container.
+  // A replica is stepped start to finish while its Particles are in cache.
+  size_t replica_count = GetReplicaCount();
+  thread_pool_.ParallelFor(0, replica_count, replicas_per_chunk_,
+                           [this, steps](size_t begin, size_t end) {
+    GasContainer& worker = workers_[begin / replicas_per_chunk_];
+    for (size_t i = begin; i < end; i++) {
+      ParticleSpan<Particle> particles(particles_.data() + replica_offsets_[i],
+                                       replica_offsets_[i + 1] - replica_offsets_[i]);
+      for (size_t step = 0; step < steps; step++) {
+        worker.Update(particles);
+      }
+    }
+  });
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  if (elapsed.count() > 0) {
+    replica_steps_per_second_ = replica_count * steps / elapsed.count();
+  }
+}
+
+EnsembleObservables Ensemble::Aggregate(size_t speed_ticks, double speed_interval) const {
+  std::vector<SpeedDistribution> empty_distributions(particle_type_count_,
+                                                     SpeedDistribution(speed_ticks, speed_interval));
+  size_t replica_count = GetReplicaCount();
+  std::vector<std::vector<SpeedDistribution>> replica_distributions(replica_count,
+                                                                    empty_distributions);
+  std::vector<double> replica_energies(replica_count, 0);
+
+  thread_pool_.ParallelFor(0, replica_count, replicas_per_chunk_, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      ParticleSpan<const Particle> particles = GetReplicaParticles(i);
+      for (const Particle& particle : particles) {
+        replica_distributions[i][particle.GetType()].CountParticle(particle);
+      }
+      replica_energies[i] = ComputeKineticEnergy(particles);
+    }
+  });
+
+  // Merge in replica order, so the result does not depend on scheduling
+  EnsembleObservables observables;
+  observables.speed_distributions = empty_distributions;
+  CompensatedSum<double> energy_sum;
+  for (size_t i = 0; i < replica_count; i++) {
+    for (size_t type = 0; type < particle_type_count_; type++) {
+      observables.speed_distributions[type].Merge(replica_distributions[i][type]);
+    }
+    energy_sum.Add(replica_energies[i]);
+  }
+
+  double count = double(replica_count);
+  observables.mean_kinetic_energy = count > 0 ? energy_sum.GetSum() / count : 0;
+
+  CompensatedSum<double> squared_deviation_sum;
+  for (double energy : replica_energies) {
+    double deviation = energy - observables.mean_kinetic_energy;
+    squared_deviation_sum.Add(deviation * deviation);
+  }
+  observables.kinetic_energy_standard_error = count > 1
+      ? std::sqrt(squared_deviation_sum.GetSum() / (count - 1) / count)
+      : 0;
+  return observables;
+}
+
+ParticleSpan<const Particle> Ensemble::GetReplicaParticles(size_t replica) const {
+  return ParticleSpan<const Particle>(particles_.data() + replica_offsets_[replica],
+                                      replica_offsets_[replica + 1] - replica_offsets_[replica]);
+}
+
+size_t Ensemble::GetReplicaCount() const {
+  return replica_offsets_.size() - 1;
+}
+
+size_t Ensemble::GetThreadCount() const {
+  return thread_pool_.GetThreadCount();
+}
+
+double Ensemble::GetReplicaStepsPerSecond() const {
+  return replica_steps_per_second_;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,516 @@
+#include <core/gas_container.h>
+
+#include <core/observables.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * What one chunk of the per-particle pass bounced off
+ */
+struct ChunkCounts {
+  size_t wall_bounces = 0;
+  size_t obstacle_bounces = 0;
+  std::vector<double> piston_impulses;
+
+  explicit ChunkCounts(size_t piston_count) : piston_impulses(piston_count, 0) {}
+};
+
+}  // namespace
+
+template <int D>
+BasicGasContainer<D>::BasicGasContainer(const std::vector<ParticleConfig>& particle_configs,
+                                        const glm::vec<D, float>& top_left_corner,
+                                        const glm::vec<D, double>& box_size, unsigned int seed,
+                                        ThreadPool* thread_pool)
+    : particle_configs_(particle_configs),
+      top_left_corner_(top_left_corner),
+      box_size_(box_size),
+      seed_(seed),
+      neighbor_list_(0),
+      thread_pool_(thread_pool) {
+  // A larger type would wrap around into another species in every build, not only with asserts
+  for (const ParticleConfig& particle_config : particle_configs) {
+    if (particle_config.type >= Particle::kMaxTypeCount) {
+      throw std::invalid_argument("particle type is not below Particle::kMaxTypeCount");
+    }
+  }
+  InitializeParticles(particle_configs);
+
+  // By default, rebuild once some Particle has moved the largest radius
+  double max_radius = 0;
+  for (const ParticleConfig& particle_config : particle_configs) {
+    max_radius = std::max(max_radius, double(particle_config.radius));
+  }
+  SetNeighborSkin(2 * max_radius);
+  SetTiledKernelThreshold(kTiledKernelThreshold);
+}
+
+template <int D>
+void BasicGasContainer<D>::Update() {
+  UseNeighborListFor(nullptr);
+  static_geometry_.MovePistons();
+  ProcessParticleMovement(particles_);
+  ProcessParticleCollision(particles_);
+}
+
+template <int D>
+void BasicGasContainer<D>::Update(ParticleSpan<Particle> particles) {
+  UseNeighborListFor(particles.data());
+  static_geometry_.MovePistons();
+  ProcessParticleMovement(particles);
+  ProcessParticleCollision(particles);
+}
+
+template <int D>
+void BasicGasContainer<D>::SetNeighborSkin(double skin) {
+  neighbor_list_ = BasicNeighborList<D>(skin);
+}
+
+template <int D>
+void BasicGasContainer<D>::SetTiledKernelThreshold(size_t particle_count) {
+  tiled_kernel_threshold_ = particle_count;
+}
+
+template <int D>
+bool BasicGasContainer<D>::UsesTiledKernel() const {
+  return UsesTiledKernel(particles_.size());
+}
+
+template <int D>
+const NeighborListStats& BasicGasContainer<D>::GetNeighborListStats() const {
+  return neighbor_list_.GetStats();
+}
+
+template <int D>
+void BasicGasContainer<D>::SetDenseGasMode(bool enabled, const ContactSolverSettings& settings) {
+  dense_gas_mode_ = enabled;
+  contact_solver_ = BasicContactSolver<D>(settings);
+}
+
+template <int D>
+void BasicGasContainer<D>::SetStaticGeometry(const StaticGeometry& static_geometry) {
+  if constexpr (D == 2) {
+    static_geometry_ = static_geometry;
+    BakeStaticGeometry();
+  }
+}
+
+template <int D>
+bool BasicGasContainer<D>::AddParticles(const ParticleConfig& particle_config) {
+  if (particle_config.type >= Particle::kMaxTypeCount) {
+    return false;
+  }
+
+  // Seeded apart from the initialisation blocks, so every batch draws new Particles
+  std::seed_seq batch_seed {seed_, added_batch_count_++, (unsigned int)particles_.size()};
+  std::mt19937 generator(batch_seed);
+  UseNeighborListFor(nullptr);
+  size_t first = particles_.size();
+  particles_.reserve(first + particle_config.amount);
+  for (size_t i = 0; i < particle_config.amount; i++) {
+    particles_.push_back(GenerateParticle(particle_config, generator));
+  }
+
+  if (!UsesTiledKernel()) {
+    neighbor_list_.Insert(particles_, first);
+  }
+  if (!static_geometry_.IsEmpty()) {
+    BakeStaticGeometry();
+  }
+  return true;
+}
+
+template <int D>
+size_t BasicGasContainer<D>::RemoveParticles(size_t type, size_t amount) {
+  std::vector<bool> removed(particles_.size(), false);
+  size_t removed_count = 0;
+  for (size_t i = particles_.size(); i > 0 && removed_count < amount; i--) {
+    if (particles_[i - 1].GetType() == type) {
+      removed[i - 1] = true;
+      removed_count++;
+    }
+  }
+  if (removed_count == 0) {
+    return 0;
+  }
+
+  UseNeighborListFor(nullptr);
+  neighbor_list_.Remove(removed);
+  size_t kept_count = 0;
+  for (size_t i = 0; i < particles_.size(); i++) {
+    if (!removed[i]) {
+      particles_[kept_count++] = particles_[i];
+    }
+  }
+  particles_.erase(particles_.begin() + kept_count, particles_.end());
+  return removed_count;
+}
+
+template <int D>
+void BasicGasContainer<D>::ScaleVelocities(double factor) {
+  for (Particle& particle : particles_) {
+    particle.SetVelocity(particle.GetVelocity() * Scalar(factor));
+  }
+}
+
+template <int D>
+bool BasicGasContainer<D>::ResizeBox(const glm::vec<D, double>& box_size) {
+  double max_radius = 0;
+  for (const Particle& particle : particles_) {
+    max_radius = std::max(max_radius, double(particle.GetRadius()));
+  }
+  for (int axis = 0; axis < D; axis++) {
+    if (!(box_size[axis] > 0) || box_size[axis] < 2 * max_radius) {
+      return false;
+    }
+  }
+
+  box_size_ = box_size;
+  // Particles outside move by no more than the walls did, which the neighbour list
+  // notices like any other move
+  for (Particle& particle : particles_) {
+    typename Particle::Vec position = particle.GetPosition();
+    for (int axis = 0; axis < D; axis++) {
+      double lower = top_left_corner_[axis] + particle.GetRadius();
+      double upper = std::max(lower, top_left_corner_[axis] + box_size_[axis] -
+                                     particle.GetRadius());
+      position[axis] = Scalar(std::min(std::max(double(position[axis]), lower), upper));
+    }
+    particle.SetPosition(position);
+  }
+  if (!static_geometry_.IsEmpty()) {
+    if constexpr (D == 2) {
+      static_geometry_.Clip(top_left_corner_, box_size_[0], box_size_[1]);
+    }
+    BakeStaticGeometry();
+  }
+  return true;
+}
+
+template <int D>
+void BasicGasContainer<D>::ResetPistonImpulses() {
+  static_geometry_.ResetPistonImpulses();
+}
+
+template <int D>
+const StaticGeometry& BasicGasContainer<D>::GetStaticGeometry() const {
+  return static_geometry_;
+}
+
+template <int D>
+void BasicGasContainer<D>::SetThreadPool(ThreadPool* thread_pool) {
+  thread_pool_ = thread_pool;
+}
+
+template <int D>
+const ContactSolverStats& BasicGasContainer<D>::GetContactSolverStats() const {
+  return contact_solver_.GetStats();
+}
+
+template <int D>
+const std::vector<typename BasicGasContainer<D>::Particle>&
+BasicGasContainer<D>::GetParticles() const {
+  return particles_;
+}
+
+template <int D>
+const CollisionCounts& BasicGasContainer<D>::GetCollisionCounts() const {
+  return collision_counts_;
+}
+
+template <int D>
+MemoryReport BasicGasContainer<D>::GetMemoryReport() const {
+  MemoryReport report(particles_.size());
+  report.Add("particles", GetAllocatedBytes(particles_));
+  report.Add("neighbor list", neighbor_list_.GetMemoryUsage());
+  report.Add("pair kernel", tiled_pair_kernel_.GetMemoryUsage());
+  report.Add("contact solver", contact_solver_.GetMemoryUsage() +
+                               GetAllocatedBytes(contact_pairs_));
+  report.Add("geometry", static_geometry_.GetMemoryUsage());
+  return report;
+}
+
+template <int D>
+const std::vector<ParticleConfig>& BasicGasContainer<D>::GetParticleConfigs() const {
+  return particle_configs_;
+}
+
+template <int D>
+unsigned int BasicGasContainer<D>::GetSeed() const {
+  return seed_;
+}
+
+template <int D>
+double BasicGasContainer<D>::GetNeighborSkin() const {
+  return neighbor_list_.GetSkin();
+}
+
+template <int D>
+size_t BasicGasContainer<D>::GetTiledKernelThreshold() const {
+  return tiled_kernel_threshold_;
+}
+
+template <int D>
+bool BasicGasContainer<D>::IsDenseGasMode() const {
+  return dense_gas_mode_;
+}
+
+template <int D>
+const ContactSolverSettings& BasicGasContainer<D>::GetContactSolverSettings() const {
+  return contact_solver_.GetSettings();
+}
+
+template <int D>
+const glm::vec<D, float>& BasicGasContainer<D>::GetTopLeftCorner() const {
+  return top_left_corner_;
+}
+
+template <int D>
+const glm::vec<D, double>& BasicGasContainer<D>::GetBoxSize() const {
+  return box_size_;
+}
+
+template <int D>
+double BasicGasContainer<D>::GetBoxWidth() const {
+  return box_size_[0];
+}
+
+template <int D>
+double BasicGasContainer<D>::GetBoxHeight() const {
+  return box_size_[1];
+}
+
+template <int D>
+Scalar BasicGasContainer<D>::GetKineticEnergy() const {
+  return ComputeKineticEnergy(particles_);
+}
+
+template <int D>
+void BasicGasContainer<D>::InitializeParticles(
+        const std::vector<ParticleConfig>& particle_configs) {
+  // Particles of type t are type_starts[t] up to type_starts[t + 1]
+  std::vector<size_t> type_starts(1, 0);
+  for (const ParticleConfig& particle_type : particle_configs) {
+    type_starts.push_back(type_starts.back() + particle_type.amount);
+  }
+  size_t particle_count = type_starts.back();
+
+  // Allocated once, then every Particle is overwritten in place
+  particles_.assign(particle_count, Particle(0, typename Particle::Vec(0),
+                                             typename Particle::Vec(0), 1, 1));
+
+  // Each block draws from its own generator, seeded from the container seed and the block,
+  // so the initial state depends on neither the thread count nor the scheduling
+  auto initialize_block = [&](size_t block) {
+    std::mt19937 generator(seed_);
+    if (block > 0) {
+      std::seed_seq block_seed {seed_, (unsigned int)block};
+      generator.seed(block_seed);
+    }
+
+    size_t begin = block * kInitializationBlockSize;
+    size_t end = std::min(particle_count, begin + kInitializationBlockSize);
+    size_t type = size_t(std::upper_bound(type_starts.begin(), type_starts.end(), begin) -
+                         type_starts.begin()) - 1;
+    for (size_t i = begin; i < end; i++) {
+      while (i >= type_starts[type + 1]) {
+        type++;
+      }
+      particles_[i] = GenerateParticle(particle_configs[type], generator);
+    }
+  };
+
+  size_t block_count = (particle_count + kInitializationBlockSize - 1) /
+                       kInitializationBlockSize;
+  if (thread_pool_ != nullptr && particle_count >= kParallelParticleThreshold) {
+    thread_pool_->ParallelFor(0, block_count, 1, [&](size_t begin, size_t end) {
+      for (size_t block = begin; block < end; block++) {
+        initialize_block(block);
+      }
+    });
+  } else {
+    for (size_t block = 0; block < block_count; block++) {
+      initialize_block(block);
+    }
+  }
+}
+
+template <int D>
+typename BasicGasContainer<D>::Particle BasicGasContainer<D>::GenerateParticle(
+        const ParticleConfig& particle_config, std::mt19937& generator) const {
+  // Every coordinate of the position, then every component of the velocity
+  typename Particle::Vec position;
+  for (int axis = 0; axis < D; axis++) {
+    position[axis] = Scalar(GenerateRandomDouble(
+            generator, top_left_corner_[axis], top_left_corner_[axis] + box_size_[axis]));
+  }
+
+  double max_velocity = particle_config.radius * kMaxSpeedFactor;
+  double min_velocity = -particle_config.radius * kMaxSpeedFactor;
+  typename Particle::Vec velocity;
+  for (int axis = 0; axis < D; axis++) {
+    velocity[axis] = Scalar(GenerateRandomDouble(generator, min_velocity, max_velocity));
+  }
+
+  return Particle(particle_config.type,
+                  position,
+                  velocity,
+                  particle_config.radius,
+                  particle_config.mass);
+}
+
+template <int D>
+void BasicGasContainer<D>::BakeStaticGeometry() {
+  double max_radius = 0;
+  for (const Particle& particle : particles_) {
+    max_radius = std::max(max_radius, double(particle.GetRadius()));
+  }
+  if constexpr (D == 2) {
+    static_geometry_.Bake(top_left_corner_, box_size_[0], box_size_[1], max_radius);
+  }
+}
+
+template <int D>
+void BasicGasContainer<D>::UseNeighborListFor(const Particle* particles) {
+  if (particles != listed_particles_) {
+    neighbor_list_.Clear();
+    listed_particles_ = particles;
+  }
+}
+
+template <int D>
+bool BasicGasContainer<D>::UsesTiledKernel(size_t particle_count) const {
+  return neighbor_list_.GetSkin() <= 0 || particle_count < tiled_kernel_threshold_;
+}
+
+template <int D>
+void BasicGasContainer<D>::ProcessParticleMovement(ParticleSpan<Particle> particles) {
+  // Each Particle only touches itself and the static geometry, so everything but
+  // pair collisions is handled in the same pass
+  bool has_geometry = !static_geometry_.IsEmpty();
+  auto process_range = [&](size_t begin, size_t end, ChunkCounts& counts) {
+    for (size_t i = begin; i < end; i++) {
+      particles[i].ProcessMovement();
+      counts.wall_bounces += ProcessWallCollision(particles[i]);
+      if constexpr (D == 2) {
+        if (has_geometry) {
+          counts.obstacle_bounces += static_geometry_.Collide(particles[i],
+                                                             counts.piston_impulses.data());
+        }
+      }
+    }
+  };
+
+  size_t piston_count = static_geometry_.GetPistons().size();
+  size_t grain_size = std::max<size_t>(1, particles.size());
+  if (thread_pool_ != nullptr && particles.size() >= kParallelParticleThreshold) {
+    // Chunks of whole multiples of 64 Particles start on whole cache lines
+    grain_size = thread_pool_->GetGrainSize(particles.size(), 64);
+  }
+  size_t chunk_count = std::max<size_t>(1, (particles.size() + grain_size - 1) / grain_size);
+  std::vector<ChunkCounts> chunk_counts(chunk_count, ChunkCounts(piston_count));
+  if (chunk_count == 1) {
+    process_range(0, particles.size(), chunk_counts[0]);
+  } else {
+    // Each chunk counts separately, so no counter is shared
+    thread_pool_->ParallelFor(0, particles.size(), grain_size, [&](size_t begin, size_t end) {
+      process_range(begin, end, chunk_counts[begin / grain_size]);
+    });
+  }
+
+  // Summed in chunk order, so the totals do not depend on scheduling
+  std::vector<double> piston_impulses(piston_count, 0);
+  for (const ChunkCounts& counts : chunk_counts) {
+    collision_counts_.wall_bounces += counts.wall_bounces;
+    collision_counts_.obstacle_bounces += counts.obstacle_bounces;
+    for (size_t piston = 0; piston < piston_count; piston++) {
+      piston_impulses[piston] += counts.piston_impulses[piston];
+    }
+  }
+  static_geometry_.AddPistonImpulses(piston_impulses);
+}
+
+template <int D>
+void BasicGasContainer<D>::ProcessParticleCollision(ParticleSpan<Particle> particles) {
+  if (dense_gas_mode_) {
+    ProcessDenseParticleCollision(particles);
+    return;
+  }
+
+  if (UsesTiledKernel(particles.size())) {
+    // Positions do not change while pairs are resolved, so every touching pair can be
+    // found first. Resolved in order, they collide exactly as in a loop over all pairs.
+    tiled_pair_kernel_.FindPairs(particles);
+    for (const std::pair<size_t, size_t>& pair : tiled_pair_kernel_.GetPairs()) {
+      if (CheckCollision(particles[pair.first], particles[pair.second])) {
+        CollideParticles(particles[pair.first], particles[pair.second]);
+        collision_counts_.particle_collisions++;
+      }
+    }
+    return;
+  }
+
+  // Pairs missing from the list cannot be touching, and listed neighbours come
+  // in ascending order, so this resolves collisions exactly as the tiled kernel.
+  // Large rebuilds, starting with the first step, run on the pool.
+  bool parallel = particles.size() >= kParallelParticleThreshold;
+  neighbor_list_.Update(particles, parallel ? thread_pool_ : nullptr);
+  for (size_t i = 0; i < particles.size(); i++) {
+    for (const size_t* j = neighbor_list_.NeighborsBegin(i);
+         j != neighbor_list_.NeighborsEnd(i); j++) {
+      if (CheckCollision(particles[i], particles[*j])) {
+        CollideParticles(particles[i], particles[*j]);
+        collision_counts_.particle_collisions++;
+      }
+    }
+  }
+}
+
+template <int D>
+void BasicGasContainer<D>::ProcessDenseParticleCollision(ParticleSpan<Particle> particles) {
+  // The solver ignores pairs that are not touching, so the tiled kernel's pairs stand in
+  // for every pair
+  if (UsesTiledKernel(particles.size())) {
+    tiled_pair_kernel_.FindPairs(particles);
+    contact_solver_.Solve(particles, tiled_pair_kernel_.GetPairs());
+    collision_counts_.particle_collisions += contact_solver_.GetStats().contact_count;
+    return;
+  }
+
+  contact_pairs_.clear();
+  bool parallel = particles.size() >= kParallelParticleThreshold;
+  neighbor_list_.Update(particles, parallel ? thread_pool_ : nullptr);
+  for (size_t i = 0; i < particles.size(); i++) {
+    for (const size_t* j = neighbor_list_.NeighborsBegin(i);
+         j != neighbor_list_.NeighborsEnd(i); j++) {
+      contact_pairs_.emplace_back(i, *j);
+    }
+  }
+  contact_solver_.Solve(particles, contact_pairs_);
+  collision_counts_.particle_collisions += contact_solver_.GetStats().contact_count;
+}
+
+template <int D>
+size_t BasicGasContainer<D>::ProcessWallCollision(Particle& particle) const {
+  size_t bounces = 0;
+  for (int axis = 0; axis < D; axis++) {
+    bounces += particle.ProcessBoxCollision(axis, Scalar(top_left_corner_[axis]),
+                                            Scalar(top_left_corner_[axis] + box_size_[axis]));
+  }
+  return bounces;
+}
+
+template <int D>
+double BasicGasContainer<D>::GenerateRandomDouble(std::mt19937& generator, double min, double max) {
+  std::uniform_real_distribution<double> distribution(min, max);
+  return distribution(generator);
+}
+
+template class BasicGasContainer<2>;
+template class BasicGasContainer<3>;
+
+}  // namespace idealgas
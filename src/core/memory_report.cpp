@@ -0,0 +1,53 @@
+#include <core/memory_report.h>
+
+#include <cstdio>
+
+namespace idealgas {
+
+MemoryReport::MemoryReport(size_t particle_count) : particle_count_(particle_count) {}
+
+void MemoryReport::Add(const std::string& subsystem, size_t bytes) {
+  subsystems_.emplace_back(subsystem, bytes);
+}
+
+void MemoryReport::Add(const MemoryReport& report) {
+  subsystems_.insert(subsystems_.end(), report.subsystems_.begin(), report.subsystems_.end());
+}
+
+size_t MemoryReport::GetTotalBytes() const {
+  size_t total_bytes = 0;
+  for (const std::pair<std::string, size_t>& subsystem : subsystems_) {
+    total_bytes += subsystem.second;
+  }
+  return total_bytes;
+}
+
+double MemoryReport::GetBytesPerParticle(size_t bytes) const {
+  return particle_count_ > 0 ? double(bytes) / double(particle_count_) : 0;
+}
+
+std::string MemoryReport::Format() const {
+  std::string table;
+  char line[128];
+  std::snprintf(line, sizeof(line), "%-16s %14s %14s\n", "memory", "bytes", "per particle");
+  table += line;
+  for (const std::pair<std::string, size_t>& subsystem : subsystems_) {
+    std::snprintf(line, sizeof(line), "%-16s %14zu %14.1f\n", subsystem.first.c_str(),
+                  subsystem.second, GetBytesPerParticle(subsystem.second));
+    table += line;
+  }
+  std::snprintf(line, sizeof(line), "%-16s %14zu %14.1f  (%zu particles)\n", "total",
+                GetTotalBytes(), GetBytesPerParticle(GetTotalBytes()), particle_count_);
+  table += line;
+  return table;
+}
+
+size_t MemoryReport::GetParticleCount() const {
+  return particle_count_;
+}
+
+const std::vector<std::pair<std::string, size_t>>& MemoryReport::GetSubsystems() const {
+  return subsystems_;
+}
+
+}  // namespace idealgas
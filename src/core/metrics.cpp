@@ -0,0 +1,162 @@
+#include <core/metrics.h>
+
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * Writes the HELP and TYPE lines that precede a metric
+ */
+void WriteDescription(std::ostream& stream, const char* name, const char* type,
+                      const char* help) {
+  stream << "# HELP " << name << ' ' << help << '\n'
+         << "# TYPE " << name << ' ' << type << '\n';
+}
+
+/**
+ * @return The resident set size of this process, or 0 where it cannot be read
+ */
+size_t ReadResidentMemory() {
+#ifdef _WIN32
+  return 0;
+#else
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (!(statm >> total_pages >> resident_pages)) {
+    return 0;
+  }
+  return resident_pages * size_t(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+}  // namespace
+
+SimulationMetrics::SimulationMetrics(const std::vector<std::string>& phase_names,
+                                     size_t type_count)
+    : phase_names_(phase_names), step_count_(0), steps_per_second_(0),
+      particle_collisions_(0), wall_bounces_(0), kinetic_energy_(0), particle_memory_(0),
+      construction_seconds_(0), first_step_seconds_(0),
+      phase_nanoseconds_(phase_names.size()), temperatures_(type_count) {
+  for (std::atomic<uint64_t>& nanoseconds : phase_nanoseconds_) {
+    nanoseconds.store(0);
+  }
+  for (std::atomic<double>& temperature : temperatures_) {
+    temperature.store(0);
+  }
+}
+
+void SimulationMetrics::AddPhaseTime(size_t phase, std::chrono::nanoseconds duration) {
+  // Only the simulation thread writes, so a load and store is enough
+  std::atomic<uint64_t>& nanoseconds = phase_nanoseconds_[phase];
+  nanoseconds.store(nanoseconds.load(std::memory_order_relaxed) + uint64_t(duration.count()),
+                    std::memory_order_relaxed);
+}
+
+void SimulationMetrics::RecordStep(size_t step, const CollisionCounts& counts) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (has_last_step_) {
+    std::chrono::duration<double> elapsed = now - last_step_time_;
+    if (elapsed.count() > 0) {
+      double rate = steps_per_second_.load(std::memory_order_relaxed);
+      rate = rate == 0 ? 1 / elapsed.count()
+                       : (1 - kRateSmoothing) * rate + kRateSmoothing / elapsed.count();
+      steps_per_second_.store(rate, std::memory_order_relaxed);
+    }
+  }
+  last_step_time_ = now;
+  has_last_step_ = true;
+
+  step_count_.store(step, std::memory_order_relaxed);
+  particle_collisions_.store(counts.particle_collisions, std::memory_order_relaxed);
+  wall_bounces_.store(counts.wall_bounces, std::memory_order_relaxed);
+}
+
+void SimulationMetrics::SetStartupTimes(std::chrono::nanoseconds construction,
+                                        std::chrono::nanoseconds first_step) {
+  construction_seconds_.store(construction.count() * 1e-9, std::memory_order_relaxed);
+  first_step_seconds_.store(first_step.count() * 1e-9, std::memory_order_relaxed);
+}
+
+void SimulationMetrics::SetKineticEnergy(double kinetic_energy) {
+  kinetic_energy_.store(kinetic_energy, std::memory_order_relaxed);
+}
+
+void SimulationMetrics::SetTemperature(size_t type, double temperature) {
+  temperatures_[type].store(temperature, std::memory_order_relaxed);
+}
+
+void SimulationMetrics::SetParticleMemory(size_t bytes) {
+  particle_memory_.store(bytes, std::memory_order_relaxed);
+}
+
+std::string SimulationMetrics::FormatExposition() const {
+  std::ostringstream stream;
+  stream.precision(10);
+
+  WriteDescription(stream, "idealgas_steps_total", "counter", "Simulation steps completed.");
+  stream << "idealgas_steps_total " << step_count_.load(std::memory_order_relaxed) << '\n';
+
+  WriteDescription(stream, "idealgas_steps_per_second", "gauge",
+                   "Smoothed rate of simulation steps.");
+  stream << "idealgas_steps_per_second "
+         << steps_per_second_.load(std::memory_order_relaxed) << '\n';
+
+  WriteDescription(stream, "idealgas_phase_seconds_total", "counter",
+                   "Time spent in each phase of a step.");
+  for (size_t phase = 0; phase < phase_names_.size(); phase++) {
+    stream << "idealgas_phase_seconds_total{phase=\"" << phase_names_[phase] << "\"} "
+           << phase_nanoseconds_[phase].load(std::memory_order_relaxed) * 1e-9 << '\n';
+  }
+
+  WriteDescription(stream, "idealgas_startup_seconds", "gauge",
+                   "Time to set up the simulation and to run its first step.");
+  stream << "idealgas_startup_seconds{stage=\"construction\"} "
+         << construction_seconds_.load(std::memory_order_relaxed) << '\n'
+         << "idealgas_startup_seconds{stage=\"first_step\"} "
+         << first_step_seconds_.load(std::memory_order_relaxed) << '\n';
+
+  WriteDescription(stream, "idealgas_particle_collisions_total", "counter",
+                   "Particle pair collisions resolved.");
+  stream << "idealgas_particle_collisions_total "
+         << particle_collisions_.load(std::memory_order_relaxed) << '\n';
+
+  WriteDescription(stream, "idealgas_wall_bounces_total", "counter",
+                   "Particle bounces off the container walls.");
+  stream << "idealgas_wall_bounces_total "
+         << wall_bounces_.load(std::memory_order_relaxed) << '\n';
+
+  WriteDescription(stream, "idealgas_kinetic_energy", "gauge",
+                   "Total kinetic energy of every particle.");
+  stream << "idealgas_kinetic_energy "
+         << kinetic_energy_.load(std::memory_order_relaxed) << '\n';
+
+  WriteDescription(stream, "idealgas_temperature", "gauge",
+                   "Effective temperature kT of each particle type.");
+  for (size_t type = 0; type < temperatures_.size(); type++) {
+    stream << "idealgas_temperature{type=\"" << type << "\"} "
+           << temperatures_[type].load(std::memory_order_relaxed) << '\n';
+  }
+
+  WriteDescription(stream, "idealgas_particle_memory_bytes", "gauge",
+                   "Memory held by the particle arrays.");
+  stream << "idealgas_particle_memory_bytes "
+         << particle_memory_.load(std::memory_order_relaxed) << '\n';
+
+  size_t resident_memory = ReadResidentMemory();
+  if (resident_memory > 0) {
+    WriteDescription(stream, "idealgas_resident_memory_bytes", "gauge",
+                     "Resident memory of the process.");
+    stream << "idealgas_resident_memory_bytes " << resident_memory << '\n';
+  }
+  return stream.str();
+}
+
+}  // namespace idealgas
@@ -0,0 +1,193 @@
+#include <core/metrics_exporter.h>
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Writing to a closed client must fail instead of raising SIGPIPE
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace idealgas {
+
+MetricsExporter::MetricsExporter(const SimulationMetrics& metrics)
+    : metrics_(metrics), listen_socket_(-1), port_(0), running_(false), scrape_count_(0) {}
+
+MetricsExporter::~MetricsExporter() {
+  Stop();
+}
+
+#ifdef _WIN32
+
+bool MetricsExporter::StartTcp(uint16_t) {
+  return false;
+}
+
+bool MetricsExporter::StartUnix(const std::string&) {
+  return false;
+}
+
+void MetricsExporter::Stop() {}
+
+bool MetricsExporter::Listen() {
+  return false;
+}
+
+void MetricsExporter::Serve() {}
+
+void MetricsExporter::Respond(int) {}
+
+#else
+
+bool MetricsExporter::StartTcp(uint16_t port) {
+  Stop();
+  listen_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_socket_ < 0) {
+    return false;
+  }
+  int reuse = 1;
+  setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  socklen_t length = sizeof(address);
+  if (bind(listen_socket_, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+      getsockname(listen_socket_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+    close(listen_socket_);
+    listen_socket_ = -1;
+    return false;
+  }
+  port_ = ntohs(address.sin_port);
+  return Listen();
+}
+
+bool MetricsExporter::StartUnix(const std::string& path) {
+  Stop();
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  if (path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  listen_socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_socket_ < 0) {
+    return false;
+  }
+
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size());
+  unlink(path.c_str());
+  if (bind(listen_socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    close(listen_socket_);
+    listen_socket_ = -1;
+    return false;
+  }
+  unix_path_ = path;
+  return Listen();
+}
+
+void MetricsExporter::Stop() {
+  if (running_.exchange(false)) {
+    thread_.join();
+  }
+  if (listen_socket_ >= 0) {
+    close(listen_socket_);
+    listen_socket_ = -1;
+  }
+  if (!unix_path_.empty()) {
+    unlink(unix_path_.c_str());
+    unix_path_.clear();
+  }
+  port_ = 0;
+}
+
+bool MetricsExporter::Listen() {
+  if (listen(listen_socket_, 8) != 0) {
+    Stop();
+    return false;
+  }
+  running_ = true;
+  thread_ = std::thread(&MetricsExporter::Serve, this);
+  return true;
+}
+
+void MetricsExporter::Serve() {
+  pollfd listener = {listen_socket_, POLLIN, 0};
+  while (running_.load()) {
+    if (poll(&listener, 1, kPollMilliseconds) <= 0) {
+      continue;
+    }
+    int client = accept(listen_socket_, nullptr, nullptr);
+    if (client >= 0) {
+#ifdef SO_NOSIGPIPE
+      int no_sigpipe = 1;
+      setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+      Respond(client);
+      close(client);
+    }
+  }
+}
+
+void MetricsExporter::Respond(int client) {
+  // Wait briefly for a request, since bare socket clients may send nothing
+  char request[1024] = {};
+  pollfd readable = {client, POLLIN, 0};
+  ssize_t received = 0;
+  if (poll(&readable, 1, kRequestMilliseconds) > 0) {
+    received = recv(client, request, sizeof(request) - 1, 0);
+  }
+
+  std::string body = metrics_.FormatExposition();
+  std::string response;
+  if (received > 0 && std::strncmp(request, "GET ", 4) == 0) {
+    const char* path = request + 4;
+    bool found = std::strncmp(path, "/ ", 2) == 0 || std::strncmp(path, "/metrics", 8) == 0;
+    if (found) {
+      response = "HTTP/1.0 200 OK\r\n"
+                 "Content-Type: text/plain; version=0.0.4\r\n"
+                 "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    } else {
+      response = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    }
+  } else {
+    response = body;
+  }
+
+  size_t sent = 0;
+  while (sent < response.size()) {
+    ssize_t written = send(client, response.data() + sent, response.size() - sent,
+                           MSG_NOSIGNAL);
+    if (written <= 0) {
+      return;
+    }
+    sent += size_t(written);
+  }
+  scrape_count_++;
+}
+
+#endif
+
+bool MetricsExporter::IsRunning() const {
+  return running_.load();
+}
+
+uint16_t MetricsExporter::GetPort() const {
+  return port_;
+}
+
+size_t MetricsExporter::GetScrapeCount() const {
+  return scrape_count_.load();
+}
+
+}  // namespace idealgas
@@ -0,0 +1,533 @@
+#include <core/neighbor_list.h>
+
+#include <core/memory_report.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+namespace {
+
+// Particles or cells per chunk of a build. Chunks are fixed, so every thread count
+// collects the same pairs into the same buffers.
+const size_t kChunkSize = 16384;
+
+/**
+ * @param count The number of indices
+ * @return The number of chunks covering them
+ */
+size_t GetChunkCount(size_t count) {
+  return (count + kChunkSize - 1) / kChunkSize;
+}
+
+/**
+ * Runs a body over [0, count) in chunks of kChunkSize, on a ThreadPool if there is more
+ * than one chunk
+ * @param count The number of indices
+ * @param thread_pool The ThreadPool, or nullptr to run serially
+ * @param body Called with the [begin, end) range of each chunk
+ */
+void ForEachChunk(size_t count, ThreadPool* thread_pool,
+                  const std::function<void(size_t, size_t)>& body) {
+  if (thread_pool == nullptr || count <= kChunkSize) {
+    for (size_t begin = 0; begin < count; begin += kChunkSize) {
+      body(begin, std::min(count, begin + kChunkSize));
+    }
+    return;
+  }
+  thread_pool->ParallelFor(0, count, kChunkSize, body);
+}
+
+}  // namespace
+
+template <int D>
+BasicNeighborList<D>::BasicNeighborList(double skin, size_t max_level_count)
+    : skin_(skin), max_level_count_(std::max<size_t>(1, max_level_count)) {}
+
+template <int D>
+void BasicNeighborList<D>::Update(ParticleSpan<const Particle> particles,
+                                  ThreadPool* thread_pool) {
+  stats_.updates++;
+  if (NeedsRebuild(particles)) {
+    Build(particles, thread_pool);
+  }
+}
+
+template <int D>
+void BasicNeighborList<D>::Build(ParticleSpan<const Particle> particles,
+                                 ThreadPool* thread_pool) {
+  stats_.rebuilds++;
+  stats_.candidate_checks = 0;
+  build_positions_.resize(particles.size());
+  build_radii_.resize(particles.size());
+  pairs_.clear();
+  if (particles.empty()) {
+    GroupPairs(0, thread_pool);
+    return;
+  }
+
+  // The bounds of each chunk, merged afterwards
+  struct Bounds {
+    double min_radius;
+    double max_radius;
+    Position min_corner;
+    Position max_corner;
+  };
+  std::vector<Bounds> chunk_bounds(GetChunkCount(particles.size()));
+  ForEachChunk(particles.size(), thread_pool, [&](size_t begin, size_t end) {
+    Bounds& bounds = chunk_bounds[begin / kChunkSize];
+    bounds.min_radius = double(particles[begin].GetRadius());
+    bounds.max_radius = bounds.min_radius;
+    bounds.min_corner = Position(particles[begin].GetPosition());
+    bounds.max_corner = bounds.min_corner;
+    for (size_t i = begin; i < end; i++) {
+      Position position(particles[i].GetPosition());
+      bounds.min_radius = std::min(bounds.min_radius, double(particles[i].GetRadius()));
+      bounds.max_radius = std::max(bounds.max_radius, double(particles[i].GetRadius()));
+      bounds.min_corner = glm::min(bounds.min_corner, position);
+      bounds.max_corner = glm::max(bounds.max_corner, position);
+      build_positions_[i] = particles[i].GetPosition();
+      build_radii_[i] = particles[i].GetRadius();
+    }
+  });
+  Bounds bounds = chunk_bounds[0];
+  for (const Bounds& chunk : chunk_bounds) {
+    bounds.min_radius = std::min(bounds.min_radius, chunk.min_radius);
+    bounds.max_radius = std::max(bounds.max_radius, chunk.max_radius);
+    bounds.min_corner = glm::min(bounds.min_corner, chunk.min_corner);
+    bounds.max_corner = glm::max(bounds.max_corner, chunk.max_corner);
+  }
+  origin_ = bounds.min_corner;
+
+  // A listed pair is never farther apart than the larger of the two reaches, so with
+  // cells as wide as that reach only the 3^D cells around a Particle can hold its neighbours.
+  // The top level also takes every Particle too large for the levels below it.
+  base_cell_size_ = std::max(2 * bounds.min_radius + skin_, 1e-6);
+  particle_levels_.resize(particles.size());
+  std::vector<size_t> chunk_level_counts(chunk_bounds.size(), 1);
+  ForEachChunk(particles.size(), thread_pool, [&](size_t begin, size_t end) {
+    size_t& chunk_level_count = chunk_level_counts[begin / kChunkSize];
+    for (size_t i = begin; i < end; i++) {
+      particle_levels_[i] = GetLevel(double(particles[i].GetRadius()));
+      chunk_level_count = std::max(chunk_level_count, particle_levels_[i] + 1);
+    }
+  });
+  size_t level_count = *std::max_element(chunk_level_counts.begin(), chunk_level_counts.end());
+
+  levels_.resize(level_count);
+  for (size_t level = 0; level < level_count; level++) {
+    GridLevel& grid = levels_[level];
+    grid.cell_size = base_cell_size_ * double(size_t(1) << level);
+    if (level + 1 == level_count) {
+      grid.cell_size = std::max(grid.cell_size, 2 * bounds.max_radius + skin_);
+    }
+    size_t cell_count = 1;
+    for (int axis = 0; axis < D; axis++) {
+      grid.cell_counts[axis] =
+              size_t((bounds.max_corner[axis] - bounds.min_corner[axis]) / grid.cell_size) + 1;
+      cell_count *= grid.cell_counts[axis];
+    }
+    grid.cell_starts.resize(cell_count + 1);
+  }
+  stats_.level_count = level_count;
+  SortCells(thread_pool);
+
+  // Each Particle searches its own level, where the smaller index of a pair finds it,
+  // and every coarser level, whose Particles never search its level. The Particles are
+  // visited cell by cell, so neighbouring cells are searched one after another.
+  for (size_t own_level = 0; own_level < level_count; own_level++) {
+    const GridLevel& own_grid = levels_[own_level];
+    size_t cell_count = own_grid.cell_starts.size() - 1;
+    pair_buffers_.resize(std::max(pair_buffers_.size(), GetChunkCount(cell_count)));
+    ForEachChunk(cell_count, thread_pool, [&](size_t begin, size_t end) {
+      PairBuffer& buffer = pair_buffers_[begin / kChunkSize];
+      for (size_t own_slot = own_grid.cell_starts[begin]; own_slot < own_grid.cell_starts[end];
+           own_slot++) {
+        size_t i = own_grid.cell_particles[own_slot];
+        Position position(own_grid.cell_positions[own_slot]);
+        double radius = double(own_grid.cell_radii[own_slot]);
+        for (size_t level = own_level; level < level_count; level++) {
+          const GridLevel& grid = levels_[level];
+          if (grid.cell_particles.empty()) {
+            continue;
+          }
+          bool own_level_grid = level == own_level;
+          ForEachNearbySlot(grid, GetCoordinates(grid, position), 1, [&](size_t slot) {
+            if (!own_level_grid || grid.cell_particles[slot] > i) {
+              CheckPair(i, position, radius, grid, slot, buffer);
+            }
+          });
+        }
+      }
+    });
+    CollectPairs();
+  }
+  GroupPairs(particles.size(), thread_pool);
+}
+
+template <int D>
+void BasicNeighborList<D>::Insert(ParticleSpan<const Particle> particles, size_t first) {
+  if (offsets_.size() != first + 1 || levels_.empty()) {
+    Build(particles);
+    return;
+  }
+  // A new Particle must fit the cells of the level it is stored at
+  std::vector<size_t> new_levels;
+  for (size_t i = first; i < particles.size(); i++) {
+    double radius = double(particles[i].GetRadius());
+    size_t level = GetLevel(radius);
+    if (level >= levels_.size() || 2 * radius + skin_ > levels_[level].cell_size) {
+      Build(particles);
+      return;
+    }
+    new_levels.push_back(level);
+  }
+
+  stats_.incremental_updates++;
+  pairs_.clear();
+  for (size_t i = 0; i < first; i++) {
+    for (const size_t* j = NeighborsBegin(i); j != NeighborsEnd(i); j++) {
+      pairs_.emplace_back(i, *j);
+    }
+  }
+  build_positions_.resize(particles.size());
+  build_radii_.resize(particles.size());
+  particle_levels_.resize(particles.size());
+  for (size_t i = first; i < particles.size(); i++) {
+    build_positions_[i] = particles[i].GetPosition();
+    build_radii_[i] = particles[i].GetRadius();
+    particle_levels_[i] = new_levels[i - first];
+  }
+  SortCells(nullptr);
+
+  // Listed Particles never searched for the new ones, so each new Particle searches every
+  // level. A Particle at a finer level reaches at most one of its cells, so a pair there is
+  // at most the reach of the new Particle plus half that cell apart.
+  pair_buffers_.resize(std::max<size_t>(pair_buffers_.size(), 1));
+  for (size_t i = first; i < particles.size(); i++) {
+    Position position(build_positions_[i]);
+    double radius = double(build_radii_[i]);
+    for (size_t level = 0; level < levels_.size(); level++) {
+      const GridLevel& grid = levels_[level];
+      if (grid.cell_particles.empty()) {
+        continue;
+      }
+      size_t half_width = 1;
+      if (level < particle_levels_[i]) {
+        double cutoff = radius + (grid.cell_size - skin_) / 2 + skin_;
+        half_width = size_t(cutoff / grid.cell_size) + 1;
+      }
+      // A pair of new Particles is found by the larger index
+      ForEachNearbySlot(grid, GetCoordinates(grid, position), half_width, [&](size_t slot) {
+        size_t j = grid.cell_particles[slot];
+        if (j < first || j < i) {
+          CheckPair(i, position, radius, grid, slot, pair_buffers_[0]);
+        }
+      });
+    }
+  }
+  CollectPairs();
+  GroupPairs(particles.size(), nullptr);
+}
+
+template <int D>
+void BasicNeighborList<D>::Remove(const std::vector<bool>& removed) {
+  if (offsets_.size() != removed.size() + 1) {
+    return;
+  }
+
+  stats_.incremental_updates++;
+  std::vector<size_t> new_indices(removed.size());
+  size_t kept_count = 0;
+  for (size_t i = 0; i < removed.size(); i++) {
+    new_indices[i] = kept_count;
+    if (!removed[i]) {
+      build_positions_[kept_count] = build_positions_[i];
+      build_radii_[kept_count] = build_radii_[i];
+      particle_levels_[kept_count] = particle_levels_[i];
+      kept_count++;
+    }
+  }
+  build_positions_.resize(kept_count);
+  build_radii_.resize(kept_count);
+  particle_levels_.resize(kept_count);
+
+  // Renumbering keeps the order, so every pair keeps its smaller index first
+  pairs_.clear();
+  for (size_t i = 0; i < removed.size(); i++) {
+    if (removed[i]) {
+      continue;
+    }
+    for (const size_t* j = NeighborsBegin(i); j != NeighborsEnd(i); j++) {
+      if (!removed[*j]) {
+        pairs_.emplace_back(new_indices[i], new_indices[*j]);
+      }
+    }
+  }
+  SortCells(nullptr);
+  GroupPairs(kept_count, nullptr);
+}
+
+template <int D>
+void BasicNeighborList<D>::Clear() {
+  offsets_.clear();
+  neighbors_.clear();
+}
+
+template <int D>
+bool BasicNeighborList<D>::NeedsRebuild(ParticleSpan<const Particle> particles) const {
+  if (particles.size() != build_positions_.size() || offsets_.size() != particles.size() + 1) {
+    return true;
+  }
+
+  double max_displacement = skin_ / 2;
+  for (size_t i = 0; i < particles.size(); i++) {
+    glm::vec<D, double> displacement = glm::vec<D, double>(particles[i].GetPosition()) -
+                                       glm::vec<D, double>(build_positions_[i]);
+    if (glm::dot(displacement, displacement) > max_displacement * max_displacement) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int D>
+const size_t* BasicNeighborList<D>::NeighborsBegin(size_t index) const {
+  return neighbors_.data() + offsets_[index];
+}
+
+template <int D>
+const size_t* BasicNeighborList<D>::NeighborsEnd(size_t index) const {
+  return neighbors_.data() + offsets_[index + 1];
+}
+
+template <int D>
+size_t BasicNeighborList<D>::GetMemoryUsage() const {
+  size_t bytes = GetAllocatedBytes(offsets_) + GetAllocatedBytes(neighbors_) +
+                 GetAllocatedBytes(build_positions_) + GetAllocatedBytes(build_radii_) +
+                 GetAllocatedBytes(levels_) + GetAllocatedBytes(particle_levels_) +
+                 GetAllocatedBytes(particle_cells_) + GetAllocatedBytes(band_particles_) +
+                 GetAllocatedBytes(band_offsets_) + GetAllocatedBytes(pairs_) +
+                 GetAllocatedBytes(pair_buffers_);
+  for (const GridLevel& grid : levels_) {
+    bytes += GetAllocatedBytes(grid.cell_starts) + GetAllocatedBytes(grid.cell_particles) +
+             GetAllocatedBytes(grid.cell_positions) + GetAllocatedBytes(grid.cell_radii);
+  }
+  for (const PairBuffer& buffer : pair_buffers_) {
+    bytes += GetAllocatedBytes(buffer.pairs);
+  }
+  return bytes;
+}
+
+template <int D>
+double BasicNeighborList<D>::GetSkin() const {
+  return skin_;
+}
+
+template <int D>
+const NeighborListStats& BasicNeighborList<D>::GetStats() const {
+  return stats_;
+}
+
+template <int D>
+size_t BasicNeighborList<D>::GetLevel(double radius) const {
+  double reach = 2 * radius + skin_;
+  size_t level = 0;
+  for (double cell_size = base_cell_size_;
+       cell_size < reach && level + 1 < max_level_count_; cell_size *= 2) {
+    level++;
+  }
+  return level;
+}
+
+template <int D>
+typename BasicNeighborList<D>::Coordinates BasicNeighborList<D>::GetCoordinates(
+        const GridLevel& grid, const Position& position) const {
+  Coordinates coordinates;
+  for (int axis = 0; axis < D; axis++) {
+    double offset = std::max(0.0, (position[axis] - origin_[axis]) / grid.cell_size);
+    coordinates[axis] = std::min(size_t(offset), grid.cell_counts[axis] - 1);
+  }
+  return coordinates;
+}
+
+template <int D>
+size_t BasicNeighborList<D>::GetCell(const GridLevel& grid, const Coordinates& coordinates) {
+  size_t cell = 0;
+  for (int axis = D - 1; axis >= 0; axis--) {
+    cell = cell * grid.cell_counts[axis] + coordinates[axis];
+  }
+  return cell;
+}
+
+template <int D>
+void BasicNeighborList<D>::SortCells(ThreadPool* thread_pool) {
+  // Counting sort of Particles by their cell at their own level, in two passes that both run
+  // in chunks. The Particles are first split into bands of kChunkSize consecutive cells,
+  // then each band is sorted into its own cells, whose counters fit in cache together.
+  size_t particle_count = build_positions_.size();
+  size_t chunk_count = std::max<size_t>(1, GetChunkCount(particle_count));
+  particle_cells_.resize(particle_count);
+  ForEachChunk(particle_count, thread_pool, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const GridLevel& grid = levels_[particle_levels_[i]];
+      particle_cells_[i] = GetCell(grid, GetCoordinates(grid, Position(build_positions_[i])));
+    }
+  });
+
+  for (size_t level = 0; level < levels_.size(); level++) {
+    GridLevel& grid = levels_[level];
+    size_t cell_count = grid.cell_starts.size() - 1;
+    size_t band_count = GetChunkCount(cell_count);
+
+    // band_offsets_[band * chunk_count + chunk] counts the Particles of a chunk in a band,
+    // so the prefix sum orders the Particles by band, then by index
+    band_offsets_.assign(band_count * chunk_count + 1, 0);
+    ForEachChunk(particle_count, thread_pool, [&](size_t begin, size_t end) {
+      size_t chunk = begin / kChunkSize;
+      for (size_t i = begin; i < end; i++) {
+        if (particle_levels_[i] == level) {
+          band_offsets_[particle_cells_[i] / kChunkSize * chunk_count + chunk + 1]++;
+        }
+      }
+    });
+    for (size_t k = 0; k + 1 < band_offsets_.size(); k++) {
+      band_offsets_[k + 1] += band_offsets_[k];
+    }
+    size_t level_particle_count = band_offsets_.back();
+    band_particles_.resize(level_particle_count);
+    band_cells_.resize(level_particle_count);
+    ForEachChunk(particle_count, thread_pool, [&](size_t begin, size_t end) {
+      size_t chunk = begin / kChunkSize;
+      for (size_t i = begin; i < end; i++) {
+        if (particle_levels_[i] == level) {
+          // Each chunk advances only its own offsets
+          size_t& offset = band_offsets_[particle_cells_[i] / kChunkSize * chunk_count + chunk];
+          band_particles_[offset] = i;
+          band_cells_[offset] = particle_cells_[i];
+          offset++;
+        }
+      }
+    });
+
+    // The offsets were advanced while filling, so the last chunk's offset in a band is now
+    // the start of the next band
+    grid.cell_particles.resize(level_particle_count);
+    grid.cell_positions.resize(level_particle_count);
+    grid.cell_radii.resize(level_particle_count);
+    ForEachChunk(cell_count, thread_pool, [&](size_t begin, size_t end) {
+      size_t band = begin / kChunkSize;
+      size_t band_begin = band == 0 ? 0 : band_offsets_[band * chunk_count - 1];
+      size_t band_end = band_offsets_[(band + 1) * chunk_count - 1];
+      std::fill(grid.cell_starts.begin() + begin, grid.cell_starts.begin() + end, 0);
+      for (size_t k = band_begin; k < band_end; k++) {
+        grid.cell_starts[band_cells_[k]]++;
+      }
+      // cell_starts[c] is first the end of cell c, then moved back to its start while filling
+      // in reverse, which keeps each cell in ascending index order
+      size_t cell_end = band_begin;
+      for (size_t cell = begin; cell < end; cell++) {
+        cell_end += grid.cell_starts[cell];
+        grid.cell_starts[cell] = cell_end;
+      }
+      for (size_t k = band_end; k > band_begin; k--) {
+        size_t i = band_particles_[k - 1];
+        size_t slot = --grid.cell_starts[band_cells_[k - 1]];
+        grid.cell_particles[slot] = i;
+        grid.cell_positions[slot] = build_positions_[i];
+        grid.cell_radii[slot] = build_radii_[i];
+      }
+    });
+    grid.cell_starts[cell_count] = level_particle_count;
+  }
+}
+
+template <int D>
+template <typename Visit>
+void BasicNeighborList<D>::ForEachNearbySlot(const GridLevel& grid, const Coordinates& center,
+                                             size_t half_width, Visit visit) const {
+  size_t width = 2 * half_width + 1;
+  size_t row_count = 1;
+  for (int axis = 1; axis < D; axis++) {
+    row_count *= width;
+  }
+
+  // Cells next to each other along the first axis hold consecutive slots, so each row of
+  // cells along it is a single range of slots
+  size_t first = center[0] >= half_width ? center[0] - half_width : 0;
+  size_t last = std::min(center[0] + half_width, grid.cell_counts[0] - 1);
+  for (size_t row = 0; row < row_count; row++) {
+    // Each base (2 * half_width + 1) digit of the row index moves one of the other axes
+    // by -half_width up to +half_width
+    Coordinates neighbor;
+    neighbor[0] = first;
+    bool inside_grid = true;
+    size_t digits = row;
+    for (int axis = 1; axis < D && inside_grid; axis++, digits /= width) {
+      size_t shifted = center[axis] + digits % width;
+      inside_grid = shifted >= half_width && shifted < grid.cell_counts[axis] + half_width;
+      neighbor[axis] = shifted - half_width;
+    }
+    if (!inside_grid) {
+      continue;
+    }
+
+    size_t row_cell = GetCell(grid, neighbor);
+    for (size_t slot = grid.cell_starts[row_cell];
+         slot < grid.cell_starts[row_cell + last - first + 1]; slot++) {
+      visit(slot);
+    }
+  }
+}
+
+template <int D>
+void BasicNeighborList<D>::CheckPair(size_t i, const Position& position, double radius,
+                                     const GridLevel& grid, size_t slot,
+                                     PairBuffer& buffer) const {
+  buffer.candidate_checks++;
+  Position displacement = position - Position(grid.cell_positions[slot]);
+  double cutoff = radius + grid.cell_radii[slot] + skin_;
+  if (glm::dot(displacement, displacement) <= cutoff * cutoff) {
+    size_t j = grid.cell_particles[slot];
+    buffer.pairs.emplace_back(std::min(i, j), std::max(i, j));
+  }
+}
+
+template <int D>
+void BasicNeighborList<D>::CollectPairs() {
+  for (PairBuffer& buffer : pair_buffers_) {
+    pairs_.insert(pairs_.end(), buffer.pairs.begin(), buffer.pairs.end());
+    stats_.candidate_checks += buffer.candidate_checks;
+    buffer.pairs.clear();
+    buffer.candidate_checks = 0;
+  }
+}
+
+template <int D>
+void BasicNeighborList<D>::GroupPairs(size_t particle_count, ThreadPool* thread_pool) {
+  // Group the pairs by their smaller index, in ascending order within each group,
+  // which visits pairs exactly as the brute force loop does whatever order they were found in
+  offsets_.assign(particle_count + 1, 0);
+  for (const std::pair<size_t, size_t>& pair : pairs_) {
+    offsets_[pair.first + 1]++;
+  }
+  for (size_t i = 0; i < particle_count; i++) {
+    offsets_[i + 1] += offsets_[i];
+  }
+  neighbors_.resize(pairs_.size());
+  std::vector<size_t> fill(offsets_.begin(), offsets_.end() - 1);
+  for (const std::pair<size_t, size_t>& pair : pairs_) {
+    neighbors_[fill[pair.first]++] = pair.second;
+  }
+  ForEachChunk(particle_count, thread_pool, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      std::sort(neighbors_.begin() + offsets_[i], neighbors_.begin() + offsets_[i + 1]);
+    }
+  });
+  stats_.pair_count = neighbors_.size();
+}
+
+template class BasicNeighborList<2>;
+template class BasicNeighborList<3>;
+
+}  // namespace idealgas
@@ -0,0 +1,57 @@
+#include <core/observables.h>
+
+namespace idealgas {
+
+template <typename T, int D>
+T ComputeKineticEnergy(ParticleSpan<const BasicParticle<T, D>> particles) {
+  CompensatedSum<T> energy;
+  for (const BasicParticle<T, D>& particle : particles) {
+    const typename BasicParticle<T, D>::Vec& velocity = particle.GetVelocity();
+    energy.Add(T(0.5) * particle.GetMass() * dot(velocity, velocity));
+  }
+  return energy.GetSum();
+}
+
+template <typename T, int D>
+T ComputeKineticEnergy(const std::vector<BasicParticle<T, D>>& particles) {
+  return ComputeKineticEnergy(ParticleSpan<const BasicParticle<T, D>>(particles));
+}
+
+template <typename T, int D>
+glm::vec<D, T> ComputeMomentum(ParticleSpan<const BasicParticle<T, D>> particles) {
+  CompensatedSum<T> momentum[D];
+  for (const BasicParticle<T, D>& particle : particles) {
+    for (int axis = 0; axis < D; axis++) {
+      momentum[axis].Add(particle.GetMass() * particle.GetVelocity()[axis]);
+    }
+  }
+  glm::vec<D, T> total;
+  for (int axis = 0; axis < D; axis++) {
+    total[axis] = momentum[axis].GetSum();
+  }
+  return total;
+}
+
+template <typename T, int D>
+glm::vec<D, T> ComputeMomentum(const std::vector<BasicParticle<T, D>>& particles) {
+  return ComputeMomentum(ParticleSpan<const BasicParticle<T, D>>(particles));
+}
+
+template float ComputeKineticEnergy(ParticleSpan<const BasicParticle<float>>);
+template double ComputeKineticEnergy(ParticleSpan<const BasicParticle<double>>);
+template float ComputeKineticEnergy(ParticleSpan<const BasicParticle<float, 3>>);
+template double ComputeKineticEnergy(ParticleSpan<const BasicParticle<double, 3>>);
+template float ComputeKineticEnergy(const std::vector<BasicParticle<float>>&);
+template double ComputeKineticEnergy(const std::vector<BasicParticle<double>>&);
+template float ComputeKineticEnergy(const std::vector<BasicParticle<float, 3>>&);
+template double ComputeKineticEnergy(const std::vector<BasicParticle<double, 3>>&);
+template glm::vec<2, float> ComputeMomentum(ParticleSpan<const BasicParticle<float>>);
+template glm::vec<2, double> ComputeMomentum(ParticleSpan<const BasicParticle<double>>);
+template glm::vec<3, float> ComputeMomentum(ParticleSpan<const BasicParticle<float, 3>>);
+template glm::vec<3, double> ComputeMomentum(ParticleSpan<const BasicParticle<double, 3>>);
+template glm::vec<2, float> ComputeMomentum(const std::vector<BasicParticle<float>>&);
+template glm::vec<2, double> ComputeMomentum(const std::vector<BasicParticle<double>>&);
+template glm::vec<3, float> ComputeMomentum(const std::vector<BasicParticle<float, 3>>&);
+template glm::vec<3, double> ComputeMomentum(const std::vector<BasicParticle<double, 3>>&);
+
+}  // namespace idealgas
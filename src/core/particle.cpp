@@ -1,62 +1,93 @@
 #include <core/particle.h>
 
+#include <cassert>
+
 namespace idealgas {
-using glm::vec2;
 
-Particle::Particle(size_t type, const glm::vec2& position, const glm::vec2& velocity,
-                   const ci::Color& color, float radius, double mass) :
-        type_(type), position_(position), velocity_(velocity), color_(color), radius_(radius), mass_(mass) {}
+template <typename T, int D>
+BasicParticle<T, D>::BasicParticle(size_t type, const Vec& position, const Vec& velocity,
+                                T radius, T mass) :
+        position_(position), velocity_(velocity), radius_(radius), mass_(mass),
+        type_(uint8_t(type)) {
+  // A larger type would wrap around into another species
+  assert(type < kMaxTypeCount);
+}
 
-void Particle::ProcessMovement() {
+template <typename T, int D>
+void BasicParticle<T, D>::ProcessMovement() {
   position_ += velocity_;
 }
 
-void Particle::ProcessXWallCollision(double wall_pos) {
+template <typename T, int D>
+bool BasicParticle<T, D>::ProcessWallCollision(int axis, T wall_pos) {
   // Check that the Particle is within (radius) distance of the wall
   // and is moving towards the wall
-  if (abs(position_.x - wall_pos) <= radius_
-  && (position_.x - wall_pos) * (velocity_.x) < 0) {
-    velocity_.x *= -1;
+  if (std::abs(position_[axis] - wall_pos) <= radius_
+  && (position_[axis] - wall_pos) * (velocity_[axis]) < 0) {
+    velocity_[axis] *= -1;
+    return true;
   }
+  return false;
 }
 
-void Particle::ProcessYWallCollision(double wall_pos) {
-  // Check that the Particle is within (radius) distance of the wall
-  // and is moving towards the wall
-  if (abs(position_.y - wall_pos) <= radius_
-  && (position_.y - wall_pos) * (velocity_.y) < 0) {
-    velocity_.y *= -1;
+template <typename T, int D>
+bool BasicParticle<T, D>::ProcessBoxCollision(int axis, T lower_wall, T upper_wall) {
+  // The inside of the box is known, so unlike a lone wall there is no distance limit
+  if ((position_[axis] - radius_ <= lower_wall && velocity_[axis] < 0) ||
+      (position_[axis] + radius_ >= upper_wall && velocity_[axis] > 0)) {
+    velocity_[axis] *= -1;
+    return true;
   }
+  return false;
 }
 
-size_t Particle::GetType() const {
+template <typename T, int D>
+bool BasicParticle<T, D>::ProcessXWallCollision(T wall_pos) {
+  return ProcessWallCollision(0, wall_pos);
+}
+
+template <typename T, int D>
+bool BasicParticle<T, D>::ProcessYWallCollision(T wall_pos) {
+  return ProcessWallCollision(1, wall_pos);
+}
+
+template <typename T, int D>
+size_t BasicParticle<T, D>::GetType() const {
   return type_;
 }
 
-const glm::vec2& Particle::GetPosition() const {
+template <typename T, int D>
+const typename BasicParticle<T, D>::Vec& BasicParticle<T, D>::GetPosition() const {
   return position_;
 }
 
-const glm::vec2& Particle::GetVelocity() const {
+template <typename T, int D>
+const typename BasicParticle<T, D>::Vec& BasicParticle<T, D>::GetVelocity() const {
   return velocity_;
 }
 
-const cinder::Color& Particle::GetColor() const {
-  return color_;
-}
-
-float Particle::GetRadius() const {
+template <typename T, int D>
+T BasicParticle<T, D>::GetRadius() const {
   return radius_;
 }
 
-double Particle::GetMass() const {
+template <typename T, int D>
+T BasicParticle<T, D>::GetMass() const {
   return mass_;
 }
-void Particle::SetVelocity(const vec2& velocity) {
+
+template <typename T, int D>
+void BasicParticle<T, D>::SetPosition(const Vec& position) {
+  position_ = position;
+}
+
+template <typename T, int D>
+void BasicParticle<T, D>::SetVelocity(const Vec& velocity) {
   velocity_ = velocity;
 }
 
-bool CheckCollision(const Particle& particle_a, const Particle& particle_b) {
+template <typename T, int D>
+bool CheckCollision(const BasicParticle<T, D>& particle_a, const BasicParticle<T, D>& particle_b) {
   // Check that the Particles are with (sum of radius) distance with each other
   // and is moving towards each other
   return (distance(particle_a.GetPosition(), particle_b.GetPosition())
@@ -65,20 +96,36 @@ bool CheckCollision(const Particle& particle_a, const Particle& particle_b) {
              (particle_a.GetPosition() - particle_b.GetPosition())) < 0);
 }
 
-void CollideParticles(Particle &particle_a, Particle &particle_b) {
-  vec2 old_velocity = particle_a.GetVelocity();
-  particle_a.SetVelocity(old_velocity -
-            (particle_a.GetPosition() - particle_b.GetPosition()) *
-            float (dot((old_velocity - particle_b.GetVelocity()),
-                       (particle_a.GetPosition() - particle_b.GetPosition())) /
-            pow(distance(particle_a.GetPosition(), particle_b.GetPosition()), 2) *
-            (2 * particle_b.GetMass() / (particle_a.GetMass() + particle_b.GetMass()))));
-
-  particle_b.SetVelocity(particle_b.GetVelocity() -
-            (particle_b.GetPosition() - particle_a.GetPosition()) *
-            float (dot((particle_b.GetVelocity() - old_velocity),
-                       (particle_b.GetPosition() - particle_a.GetPosition())) /
-            pow(distance(particle_b.GetPosition(), particle_a.GetPosition()), 2) *
-            (2 * particle_a.GetMass() / (particle_a.GetMass() + particle_b.GetMass()))));
+template <typename T, int D>
+void CollideParticles(BasicParticle<T, D>& particle_a, BasicParticle<T, D>& particle_b) {
+  typedef typename BasicParticle<T, D>::Vec Vec;
+
+  // Every term is evaluated in T, so float and double runs each stay in their
+  // own precision instead of rounding through mixed casts
+  Vec old_velocity = particle_a.GetVelocity();
+  Vec displacement = particle_a.GetPosition() - particle_b.GetPosition();
+  T distance_squared = dot(displacement, displacement);
+  T total_mass = particle_a.GetMass() + particle_b.GetMass();
+
+  particle_a.SetVelocity(old_velocity - displacement *
+            (dot((old_velocity - particle_b.GetVelocity()), displacement) /
+            distance_squared * (2 * particle_b.GetMass() / total_mass)));
+
+  particle_b.SetVelocity(particle_b.GetVelocity() + displacement *
+            (dot((particle_b.GetVelocity() - old_velocity), -displacement) /
+            distance_squared * (2 * particle_a.GetMass() / total_mass)));
 }
-}  // namespace idealgas
\ No newline at end of file
+
+template class BasicParticle<float>;
+template class BasicParticle<double>;
+template class BasicParticle<float, 3>;
+template class BasicParticle<double, 3>;
+template bool CheckCollision(const BasicParticle<float>&, const BasicParticle<float>&);
+template bool CheckCollision(const BasicParticle<double>&, const BasicParticle<double>&);
+template bool CheckCollision(const BasicParticle<float, 3>&, const BasicParticle<float, 3>&);
+template bool CheckCollision(const BasicParticle<double, 3>&, const BasicParticle<double, 3>&);
+template void CollideParticles(BasicParticle<float>&, BasicParticle<float>&);
+template void CollideParticles(BasicParticle<double>&, BasicParticle<double>&);
+template void CollideParticles(BasicParticle<float, 3>&, BasicParticle<float, 3>&);
+template void CollideParticles(BasicParticle<double, 3>&, BasicParticle<double, 3>&);
+}  // namespace idealgas
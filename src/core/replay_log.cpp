@@ -0,0 +1,481 @@
+#include <core/replay_log.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace idealgas {
+
+namespace {
+
+const char kMagic[8] = {'I', 'G', 'R', 'E', 'P', 'L', 'A', 'Y'};
+// 2 added the dimensions, static geometry, edits and per step Particle counts
+const uint32_t kVersion = 2;
+
+template <typename T>
+void WriteValue(std::ostream& stream, const T& value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(std::istream& stream, T& value) {
+  return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <int L, typename T>
+void WriteVector(std::ostream& stream, const glm::vec<L, T>& vector) {
+  for (int axis = 0; axis < L; axis++) {
+    WriteValue(stream, vector[axis]);
+  }
+}
+
+template <int L, typename T>
+bool ReadVector(std::istream& stream, glm::vec<L, T>& vector) {
+  for (int axis = 0; axis < L; axis++) {
+    if (!ReadValue(stream, vector[axis])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void WriteParticleConfig(std::ostream& stream, const ParticleConfig& particle_config) {
+  WriteValue(stream, uint64_t(particle_config.type));
+  WriteValue(stream, particle_config.color.r);
+  WriteValue(stream, particle_config.color.g);
+  WriteValue(stream, particle_config.color.b);
+  WriteValue(stream, particle_config.radius);
+  WriteValue(stream, particle_config.mass);
+  WriteValue(stream, uint64_t(particle_config.amount));
+}
+
+bool ReadParticleConfig(std::istream& stream, ParticleConfig& particle_config) {
+  uint64_t type = 0;
+  uint64_t amount = 0;
+  if (!(ReadValue(stream, type) && ReadValue(stream, particle_config.color.r) &&
+        ReadValue(stream, particle_config.color.g) &&
+        ReadValue(stream, particle_config.color.b) &&
+        ReadValue(stream, particle_config.radius) && ReadValue(stream, particle_config.mass) &&
+        ReadValue(stream, amount)) || type >= Particle::kMaxTypeCount) {
+    return false;
+  }
+  particle_config.type = size_t(type);
+  particle_config.amount = size_t(amount);
+  return true;
+}
+
+void WriteStaticGeometry(std::ostream& stream, const StaticGeometry& static_geometry) {
+  WriteValue(stream, uint64_t(static_geometry.GetObstacles().size()));
+  for (const Obstacle& obstacle : static_geometry.GetObstacles()) {
+    WriteValue(stream, uint8_t(obstacle.shape));
+    WriteVector(stream, obstacle.start);
+    WriteVector(stream, obstacle.end);
+    WriteValue(stream, obstacle.radius);
+  }
+  // Impulses only measure pressure, so they do not affect trajectories and are not recorded
+  WriteValue(stream, uint64_t(static_geometry.GetPistons().size()));
+  for (const Piston& piston : static_geometry.GetPistons()) {
+    WriteVector(stream, piston.start);
+    WriteVector(stream, piston.end);
+    WriteVector(stream, piston.velocity);
+    WriteValue(stream, piston.travel);
+    WriteValue(stream, piston.moved);
+  }
+}
+
+bool ReadStaticGeometry(std::istream& stream, StaticGeometry& static_geometry) {
+  uint64_t obstacle_count = 0;
+  if (!ReadValue(stream, obstacle_count)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < obstacle_count; i++) {
+    uint8_t shape = 0;
+    Obstacle obstacle;
+    if (!(ReadValue(stream, shape) && ReadVector(stream, obstacle.start) &&
+          ReadVector(stream, obstacle.end) && ReadValue(stream, obstacle.radius))) {
+      return false;
+    }
+    if (shape == Obstacle::kSegment) {
+      static_geometry.AddSegment(obstacle.start, obstacle.end);
+    } else if (shape == Obstacle::kCircle) {
+      static_geometry.AddCircle(obstacle.start, obstacle.radius);
+    } else {
+      return false;
+    }
+  }
+
+  uint64_t piston_count = 0;
+  if (!ReadValue(stream, piston_count)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < piston_count; i++) {
+    Piston piston;
+    if (!(ReadVector(stream, piston.start) && ReadVector(stream, piston.end) &&
+          ReadVector(stream, piston.velocity) && ReadValue(stream, piston.travel) &&
+          ReadValue(stream, piston.moved))) {
+      return false;
+    }
+    static_geometry.AddPiston(piston);
+  }
+  return true;
+}
+
+template <int D>
+void WriteEdit(std::ostream& stream, const BasicReplayEdit<D>& edit) {
+  WriteValue(stream, uint8_t(edit.kind));
+  WriteParticleConfig(stream, edit.particle_config);
+  WriteValue(stream, edit.factor);
+  WriteVector(stream, edit.box_size);
+}
+
+template <int D>
+bool ReadEdit(std::istream& stream, BasicReplayEdit<D>& edit) {
+  uint8_t kind = 0;
+  if (!(ReadValue(stream, kind) && ReadParticleConfig(stream, edit.particle_config) &&
+        ReadValue(stream, edit.factor) && ReadVector(stream, edit.box_size)) ||
+      kind > BasicReplayEdit<D>::kResizeBox) {
+    return false;
+  }
+  edit.kind = typename BasicReplayEdit<D>::Kind(kind);
+  return true;
+}
+
+/**
+ * @return The bits of a Scalar, zero extended
+ */
+inline uint64_t ScalarBits(Scalar value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(Scalar));
+  return bits;
+}
+
+/**
+ * The splitmix64 finalizer, a cheap mix where every input bit affects every output bit
+ */
+inline uint64_t Mix(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+/**
+ * @return The 32 bits of a block hash kept in a log
+ */
+inline uint32_t FoldHash(uint64_t hash) {
+  return uint32_t(hash ^ (hash >> 32));
+}
+
+size_t BlockCount(size_t particle_count, size_t block_size) {
+  return (particle_count + block_size - 1) / block_size;
+}
+
+}  // namespace
+
+template <int D>
+uint64_t HashParticles(const std::vector<BasicParticle<Scalar, D>>& particles,
+                       size_t begin, size_t end) {
+  uint64_t hash = 0;
+  for (size_t i = begin; i < end; i++) {
+    const typename BasicParticle<Scalar, D>::Vec& position = particles[i].GetPosition();
+    const typename BasicParticle<Scalar, D>::Vec& velocity = particles[i].GetVelocity();
+    // Salting with the index makes swapping two Particles change the hash
+    uint64_t particle_hash = Mix(i * 0x9e3779b97f4a7c15ULL);
+    for (int axis = 0; axis < D; axis++) {
+      particle_hash = Mix(particle_hash ^ ScalarBits(position[axis]));
+    }
+    for (int axis = 0; axis < D; axis++) {
+      particle_hash = Mix(particle_hash ^ ScalarBits(velocity[axis]));
+    }
+    hash += particle_hash;
+  }
+  return hash;
+}
+
+template <int D>
+BasicReplayEdit<D> BasicReplayEdit<D>::AddParticles(const ParticleConfig& particle_config) {
+  BasicReplayEdit edit;
+  edit.kind = kAddParticles;
+  edit.particle_config = particle_config;
+  return edit;
+}
+
+template <int D>
+BasicReplayEdit<D> BasicReplayEdit<D>::RemoveParticles(size_t type, size_t amount) {
+  BasicReplayEdit edit;
+  edit.kind = kRemoveParticles;
+  edit.particle_config.type = type;
+  edit.particle_config.amount = amount;
+  return edit;
+}
+
+template <int D>
+BasicReplayEdit<D> BasicReplayEdit<D>::ScaleVelocities(double factor) {
+  BasicReplayEdit edit;
+  edit.kind = kScaleVelocities;
+  edit.factor = factor;
+  return edit;
+}
+
+template <int D>
+BasicReplayEdit<D> BasicReplayEdit<D>::ResizeBox(const glm::vec<D, double>& box_size) {
+  BasicReplayEdit edit;
+  edit.kind = kResizeBox;
+  edit.box_size = box_size;
+  return edit;
+}
+
+template <int D>
+bool BasicReplayEdit<D>::Apply(BasicGasContainer<D>& container) const {
+  switch (kind) {
+    case kAddParticles:
+      return container.AddParticles(particle_config);
+    case kRemoveParticles:
+      return container.RemoveParticles(particle_config.type, particle_config.amount) > 0;
+    case kScaleVelocities:
+      container.ScaleVelocities(factor);
+      return true;
+    case kResizeBox:
+      return container.ResizeBox(box_size);
+  }
+  return false;
+}
+
+template <int D>
+BasicReplayRecorder<D>::BasicReplayRecorder(const std::string& path,
+                                            const BasicGasContainer<D>& container,
+                                            size_t block_size)
+    : stream_(path, std::ios::binary) {
+  size_t particle_count = container.GetParticles().size();
+  block_size_ = block_size > 0 ? block_size : std::max<size_t>(1, (particle_count + 63) / 64);
+
+  stream_.write(kMagic, sizeof(kMagic));
+  WriteValue(stream_, kVersion);
+  WriteValue(stream_, uint32_t(sizeof(Scalar)));
+  WriteValue(stream_, uint32_t(D));
+  WriteValue(stream_, uint32_t(container.GetSeed()));
+  WriteVector(stream_, container.GetTopLeftCorner());
+  WriteVector(stream_, container.GetBoxSize());
+  WriteValue(stream_, container.GetNeighborSkin());
+  WriteValue(stream_, uint8_t(container.IsDenseGasMode()));
+
+  const ContactSolverSettings& settings = container.GetContactSolverSettings();
+  WriteValue(stream_, uint64_t(settings.max_velocity_iterations));
+  WriteValue(stream_, uint64_t(settings.max_position_iterations));
+  WriteValue(stream_, settings.velocity_tolerance);
+  WriteValue(stream_, settings.overlap_tolerance);
+  WriteValue(stream_, settings.overlap_correction);
+
+  // The configs exactly as given, since the Particles cannot tell two configs of one type apart
+  const std::vector<ParticleConfig>& particle_configs = container.GetParticleConfigs();
+  WriteValue(stream_, uint64_t(particle_configs.size()));
+  for (const ParticleConfig& particle_config : particle_configs) {
+    WriteParticleConfig(stream_, particle_config);
+  }
+  WriteStaticGeometry(stream_, container.GetStaticGeometry());
+  WriteValue(stream_, uint64_t(block_size_));
+
+  RecordStep(container.GetParticles());
+}
+
+template <int D>
+void BasicReplayRecorder<D>::RecordEdit(const BasicReplayEdit<D>& edit) {
+  pending_edits_.push_back(edit);
+}
+
+template <int D>
+void BasicReplayRecorder<D>::RecordStep(const std::vector<Particle>& particles) {
+  WriteValue(stream_, uint64_t(pending_edits_.size()));
+  for (const BasicReplayEdit<D>& edit : pending_edits_) {
+    WriteEdit(stream_, edit);
+  }
+  pending_edits_.clear();
+
+  WriteValue(stream_, uint64_t(particles.size()));
+  uint64_t state_hash = 0;
+  for (size_t begin = 0; begin < particles.size(); begin += block_size_) {
+    uint64_t block_hash = HashParticles(particles, begin,
+                                        std::min(particles.size(), begin + block_size_));
+    WriteValue(stream_, FoldHash(block_hash));
+    state_hash = Mix(state_hash ^ block_hash);
+  }
+  WriteValue(stream_, state_hash);
+  stream_.flush();
+}
+
+template <int D>
+bool BasicReplayRecorder<D>::IsGood() const {
+  return stream_.good();
+}
+
+template <int D>
+bool BasicReplayLog<D>::Read(const std::string& path) {
+  std::ifstream stream(path, std::ios::binary);
+  char magic[sizeof(kMagic)];
+  uint32_t version = 0;
+  uint32_t scalar_size = 0;
+  uint32_t dimensions = 0;
+  if (!stream.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !ReadValue(stream, version) || version != kVersion || !ReadValue(stream, scalar_size) ||
+      !ReadValue(stream, dimensions) || dimensions != D) {
+    return false;
+  }
+
+  BasicReplayHeader<D> header;
+  uint32_t seed = 0;
+  uint8_t dense_gas_mode = 0;
+  uint64_t max_velocity_iterations = 0;
+  uint64_t max_position_iterations = 0;
+  uint64_t config_count = 0;
+  bool read = ReadValue(stream, seed) && ReadVector(stream, header.top_left_corner) &&
+              ReadVector(stream, header.box_size) &&
+              ReadValue(stream, header.neighbor_skin) && ReadValue(stream, dense_gas_mode) &&
+              ReadValue(stream, max_velocity_iterations) &&
+              ReadValue(stream, max_position_iterations) &&
+              ReadValue(stream, header.contact_solver_settings.velocity_tolerance) &&
+              ReadValue(stream, header.contact_solver_settings.overlap_tolerance) &&
+              ReadValue(stream, header.contact_solver_settings.overlap_correction) &&
+              ReadValue(stream, config_count);
+  if (!read) {
+    return false;
+  }
+  header.scalar_size = scalar_size;
+  header.seed = seed;
+  header.dense_gas_mode = dense_gas_mode != 0;
+  header.contact_solver_settings.max_velocity_iterations = size_t(max_velocity_iterations);
+  header.contact_solver_settings.max_position_iterations = size_t(max_position_iterations);
+
+  for (uint64_t i = 0; i < config_count; i++) {
+    ParticleConfig particle_config(0, ci::Color(), 0, 0, 0);
+    if (!ReadParticleConfig(stream, particle_config)) {
+      return false;
+    }
+    header.particle_configs.push_back(particle_config);
+  }
+  uint64_t block_size = 0;
+  if (!ReadStaticGeometry(stream, header.static_geometry) ||
+      !ReadValue(stream, block_size) || block_size == 0) {
+    return false;
+  }
+  header.block_size = size_t(block_size);
+
+  header_ = header;
+  state_hashes_.clear();
+  particle_counts_.clear();
+  edits_.clear();
+  edit_starts_.assign(1, 0);
+  block_hashes_.clear();
+  block_starts_.assign(1, 0);
+  // A step cut short by the end of the file, e.g. from a crashed run, is dropped
+  uint64_t edit_count = 0;
+  while (ReadValue(stream, edit_count)) {
+    BasicReplayEdit<D> edit;
+    uint64_t edits_read = 0;
+    while (edits_read < edit_count && ReadEdit(stream, edit)) {
+      edits_.push_back(edit);
+      edits_read++;
+    }
+
+    uint64_t particle_count = 0;
+    bool step_read = edits_read == edit_count && ReadValue(stream, particle_count);
+    size_t block_count = step_read ? BlockCount(size_t(particle_count), header_.block_size) : 0;
+    uint32_t block_hash = 0;
+    for (size_t block = 0; step_read && block < block_count; block++) {
+      step_read = ReadValue(stream, block_hash);
+      block_hashes_.push_back(block_hash);
+    }
+    uint64_t state_hash = 0;
+    if (!step_read || !ReadValue(stream, state_hash)) {
+      edits_.resize(edit_starts_.back());
+      block_hashes_.resize(block_starts_.back());
+      break;
+    }
+    edit_starts_.push_back(edits_.size());
+    block_starts_.push_back(block_hashes_.size());
+    particle_counts_.push_back(size_t(particle_count));
+    state_hashes_.push_back(state_hash);
+  }
+  return !state_hashes_.empty();
+}
+
+template <int D>
+BasicGasContainer<D> BasicReplayLog<D>::CreateContainer(ThreadPool* thread_pool) const {
+  BasicGasContainer<D> container(header_.particle_configs, header_.top_left_corner,
+                                 header_.box_size, header_.seed, thread_pool);
+  container.SetNeighborSkin(header_.neighbor_skin);
+  container.SetDenseGasMode(header_.dense_gas_mode, header_.contact_solver_settings);
+  if (!header_.static_geometry.IsEmpty()) {
+    container.SetStaticGeometry(header_.static_geometry);
+  }
+  return container;
+}
+
+template <int D>
+ReplayDivergence BasicReplayLog<D>::Verify(BasicGasContainer<D>& container) const {
+  ReplayDivergence divergence;
+  if (header_.scalar_size != sizeof(Scalar)) {
+    divergence.diverged = true;
+    divergence.reason = "recorded with a different Scalar precision";
+    return divergence;
+  }
+
+  for (size_t step = 0; step < state_hashes_.size(); step++) {
+    if (step > 0) {
+      for (size_t edit = edit_starts_[step]; edit < edit_starts_[step + 1]; edit++) {
+        edits_[edit].Apply(container);
+      }
+      container.Update();
+    }
+
+    const std::vector<BasicParticle<Scalar, D>>& particles = container.GetParticles();
+    if (particles.size() != particle_counts_[step]) {
+      // The range covers the Particles only one of the runs has
+      divergence.diverged = true;
+      divergence.step = step;
+      divergence.first_particle = std::min(particles.size(), particle_counts_[step]);
+      divergence.last_particle = std::max(particles.size(), particle_counts_[step]) - 1;
+      divergence.reason = "different particle count";
+      return divergence;
+    }
+    for (size_t block = 0; block_starts_[step] + block < block_starts_[step + 1]; block++) {
+      size_t begin = block * header_.block_size;
+      size_t end = std::min(particles.size(), begin + header_.block_size);
+      uint64_t block_hash = HashParticles(particles, begin, end);
+      if (FoldHash(block_hash) != block_hashes_[block_starts_[step] + block]) {
+        divergence.diverged = true;
+        divergence.step = step;
+        divergence.first_particle = begin;
+        divergence.last_particle = end - 1;
+        divergence.reason = step == 0 ? "initial state differs" : "particle state differs";
+        return divergence;
+      }
+    }
+  }
+  return divergence;
+}
+
+template <int D>
+const BasicReplayHeader<D>& BasicReplayLog<D>::GetHeader() const {
+  return header_;
+}
+
+template <int D>
+size_t BasicReplayLog<D>::GetStepCount() const {
+  return state_hashes_.size();
+}
+
+template <int D>
+size_t BasicReplayLog<D>::GetEditCount() const {
+  return edits_.size();
+}
+
+template uint64_t HashParticles(const std::vector<BasicParticle<Scalar, 2>>& particles,
+                                size_t begin, size_t end);
+template uint64_t HashParticles(const std::vector<BasicParticle<Scalar, 3>>& particles,
+                                size_t begin, size_t end);
+template struct BasicReplayEdit<2>;
+template struct BasicReplayEdit<3>;
+template class BasicReplayRecorder<2>;
+template class BasicReplayRecorder<3>;
+template class BasicReplayLog<2>;
+template class BasicReplayLog<3>;
+
+}  // namespace idealgas
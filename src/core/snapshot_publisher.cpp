@@ -0,0 +1,124 @@
+#include <core/snapshot_publisher.h>
+
+#include <core/memory_report.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+Particle::Vec SimulationSnapshot::GetPosition(size_t index) const {
+  if (index < positions.size()) {
+    return positions[index];
+  }
+  return Particle::Vec(quantization_origin +
+                       glm::dvec2(quantized_positions[index]) * quantization_step);
+}
+
+SnapshotPublisher::View::View() : buffer_(nullptr) {}
+
+SnapshotPublisher::View::View(Buffer* buffer) : buffer_(buffer) {}
+
+SnapshotPublisher::View::View(View&& other) : buffer_(other.buffer_) {
+  other.buffer_ = nullptr;
+}
+
+SnapshotPublisher::View& SnapshotPublisher::View::operator=(View&& other) {
+  if (this != &other) {
+    if (buffer_ != nullptr) {
+      buffer_->reader_count.fetch_sub(1);
+    }
+    buffer_ = other.buffer_;
+    other.buffer_ = nullptr;
+  }
+  return *this;
+}
+
+SnapshotPublisher::View::~View() {
+  if (buffer_ != nullptr) {
+    buffer_->reader_count.fetch_sub(1);
+  }
+}
+
+bool SnapshotPublisher::View::IsValid() const {
+  return buffer_ != nullptr;
+}
+
+const SimulationSnapshot& SnapshotPublisher::View::operator*() const {
+  return buffer_->snapshot;
+}
+
+const SimulationSnapshot* SnapshotPublisher::View::operator->() const {
+  return &buffer_->snapshot;
+}
+
+SnapshotPublisher::SnapshotPublisher(size_t buffer_count)
+    : buffer_count_(std::max<size_t>(3, buffer_count)),
+      published_index_(buffer_count_),
+      back_index_(buffer_count_),
+      dropped_count_(0) {
+  buffers_.reset(new Buffer[buffer_count_]);
+}
+
+SimulationSnapshot* SnapshotPublisher::BeginPublish() {
+  size_t published_index = published_index_.load();
+  for (size_t offset = 1; offset <= buffer_count_; offset++) {
+    size_t index = (published_index + offset) % buffer_count_;
+    // Never overwrite the current buffer, a reader may be about to pin it
+    if (index != published_index && buffers_[index].reader_count.load() == 0) {
+      back_index_ = index;
+      return &buffers_[index].snapshot;
+    }
+  }
+
+  back_index_ = buffer_count_;
+  dropped_count_.fetch_add(1);
+  return nullptr;
+}
+
+void SnapshotPublisher::EndPublish() {
+  if (back_index_ < buffer_count_) {
+    published_index_.store(back_index_);
+    back_index_ = buffer_count_;
+  }
+}
+
+SnapshotPublisher::View SnapshotPublisher::Acquire() const {
+  while (true) {
+    size_t index = published_index_.load();
+    if (index >= buffer_count_) {
+      return View();
+    }
+
+    // Pin first, then check the buffer is still current. If it is, the writer
+    // has finished with it and will skip it until the pin is released. If not,
+    // the writer may already be refilling it, so let go and try the new one.
+    Buffer& buffer = buffers_[index];
+    buffer.reader_count.fetch_add(1);
+    if (published_index_.load() == index) {
+      return View(&buffer);
+    }
+    buffer.reader_count.fetch_sub(1);
+  }
+}
+
+size_t SnapshotPublisher::GetDroppedCount() const {
+  return dropped_count_.load();
+}
+
+size_t SnapshotPublisher::GetMemoryUsage() const {
+  // Readers never resize a buffer, so its capacities are only written by this thread
+  size_t bytes = buffer_count_ * sizeof(Buffer);
+  for (size_t i = 0; i < buffer_count_; i++) {
+    const SimulationSnapshot& snapshot = buffers_[i].snapshot;
+    bytes += GetAllocatedBytes(snapshot.positions) +
+             GetAllocatedBytes(snapshot.quantized_positions) +
+             GetAllocatedBytes(snapshot.velocities) +
+             GetAllocatedBytes(snapshot.speed_frequencies);
+    for (const std::vector<size_t>& frequencies : snapshot.speed_frequencies) {
+      bytes += GetAllocatedBytes(frequencies);
+    }
+  }
+  return bytes;
+}
+
+}  // namespace idealgas
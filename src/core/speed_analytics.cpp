@@ -0,0 +1,276 @@
+#include <core/speed_analytics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace idealgas {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// Particles in each chunk of the per-particle passes
+const size_t kChunkSize = 16384;
+
+/**
+ * Runs a body over [0, count) in chunks of kChunkSize, on a ThreadPool if there is more
+ * than one chunk
+ * @param count The number of indices
+ * @param thread_pool The ThreadPool, or nullptr to run serially
+ * @param body Called with the [begin, end) range of each chunk
+ */
+void ForEachChunk(size_t count, ThreadPool* thread_pool,
+                  const std::function<void(size_t, size_t)>& body) {
+  if (thread_pool == nullptr || count <= kChunkSize) {
+    for (size_t begin = 0; begin < count; begin += kChunkSize) {
+      body(begin, std::min(count, begin + kChunkSize));
+    }
+    return;
+  }
+  thread_pool->ParallelFor(0, count, kChunkSize, body);
+}
+
+/**
+ * Computes Pearson's chi squared of bin counts against an even split
+ * @param frequencies The observed counts
+ * @param total The total of the counts
+ * @return The chi squared
+ */
+double ChiSquaredAgainstUniform(const std::vector<size_t>& frequencies, size_t total) {
+  double expected = double(total) / frequencies.size();
+  double chi_squared = 0;
+  for (size_t frequency : frequencies) {
+    chi_squared += (frequency - expected) * (frequency - expected) / expected;
+  }
+  return chi_squared;
+}
+
+/**
+ * Maps a kinetic energy over kT to an equal probability bin of its Maxwell-Boltzmann
+ * distribution, the unit exponential in 2D or the gamma distribution of shape 3/2 in 3D
+ * @param energy_ratio The kinetic energy over kT
+ * @param bin_count The number of bins
+ * @param dimensions The number of dimensions, 2 or 3
+ * @return The bin index
+ */
+size_t EnergyBin(double energy_ratio, size_t bin_count, int dimensions) {
+  // The CDF of the distribution is uniform on [0, 1) for energies drawn from it
+  double cumulative = 1 - std::exp(-energy_ratio);
+  if (dimensions == 3) {
+    cumulative = std::erf(std::sqrt(energy_ratio)) -
+                 2 * std::sqrt(energy_ratio / kPi) * std::exp(-energy_ratio);
+  }
+  return std::min(bin_count - 1, size_t(std::max(cumulative, 0.0) * bin_count));
+}
+
+}  // namespace
+
+SpeedAnalytics::SpeedAnalytics(size_t type_count, const SpeedAnalyticsSettings& settings)
+    : settings_(settings),
+      fits_(type_count),
+      step_count_(0),
+      equilibrium_step_(0),
+      window_chi_squared_sum_(0),
+      window_temperature_sums_(type_count, 0) {
+  settings_.fit_bin_count = std::max<size_t>(2, settings_.fit_bin_count);
+  settings_.window_size = std::max<size_t>(1, settings_.window_size);
+}
+
+template <int D>
+void SpeedAnalytics::Update(const std::vector<BasicParticle<Scalar, D>>& particles,
+                            ThreadPool* thread_pool) {
+  typedef BasicParticle<Scalar, D> Particle;
+  step_count_++;
+
+  // Each chunk sums into its own slice, and the slices are added in chunk order
+  size_t type_count = fits_.size();
+  size_t chunk_count = (particles.size() + kChunkSize - 1) / kChunkSize;
+  std::vector<double> partial_energies(chunk_count * type_count, 0);
+  std::vector<double> partial_masses(chunk_count * type_count, 0);
+  std::vector<size_t> partial_counts(chunk_count * type_count, 0);
+  ForEachChunk(particles.size(), thread_pool, [&](size_t begin, size_t end) {
+    size_t offset = begin / kChunkSize * type_count;
+    for (size_t i = begin; i < end; i++) {
+      const Particle& particle = particles[i];
+      size_t type = particle.GetType();
+      if (type >= type_count) {
+        continue;
+      }
+      partial_energies[offset + type] += 0.5 * particle.GetMass() *
+                                         glm::dot(particle.GetVelocity(), particle.GetVelocity());
+      partial_masses[offset + type] += particle.GetMass();
+      partial_counts[offset + type]++;
+    }
+  });
+
+  std::vector<double> energy_sums(type_count, 0);
+  std::vector<double> mass_sums(type_count, 0);
+  std::vector<size_t> counts(type_count, 0);
+  for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+    for (size_t type = 0; type < type_count; type++) {
+      energy_sums[type] += partial_energies[chunk * type_count + type];
+      mass_sums[type] += partial_masses[chunk * type_count + type];
+      counts[type] += partial_counts[chunk * type_count + type];
+    }
+  }
+
+  // Species with fewer Particles get fewer bins, keeping about five expected per bin.
+  // The pooled bins come first in each chunk's counts, then the bins of each species.
+  std::vector<std::vector<size_t>> species_frequencies(type_count);
+  std::vector<size_t> bin_offsets(type_count);
+  size_t bin_count = settings_.fit_bin_count;
+  for (size_t type = 0; type < type_count; type++) {
+    SpeciesFit& fit = fits_[type];
+    fit.count = counts[type];
+    fit.mean_mass = counts[type] > 0 ? mass_sums[type] / counts[type] : 0;
+    fit.temperature = counts[type] > 0 ? 2 * energy_sums[type] / (D * counts[type]) : 0;
+    size_t species_bins = std::max<size_t>(2, std::min(settings_.fit_bin_count,
+                                                       counts[type] / 5));
+    species_frequencies[type].assign(species_bins, 0);
+    bin_offsets[type] = bin_count;
+    bin_count += species_bins;
+  }
+
+  std::vector<size_t> partial_frequencies(chunk_count * bin_count, 0);
+  ForEachChunk(particles.size(), thread_pool, [&](size_t begin, size_t end) {
+    size_t* frequencies = partial_frequencies.data() + begin / kChunkSize * bin_count;
+    for (size_t i = begin; i < end; i++) {
+      const Particle& particle = particles[i];
+      size_t type = particle.GetType();
+      if (type >= type_count || fits_[type].temperature <= 0) {
+        continue;
+      }
+      double energy_ratio = 0.5 * particle.GetMass() *
+                            glm::dot(particle.GetVelocity(), particle.GetVelocity()) /
+                            fits_[type].temperature;
+      frequencies[EnergyBin(energy_ratio, settings_.fit_bin_count, D)]++;
+      frequencies[bin_offsets[type] +
+                  EnergyBin(energy_ratio, species_frequencies[type].size(), D)]++;
+    }
+  });
+
+  std::vector<size_t> pooled_frequencies(settings_.fit_bin_count, 0);
+  size_t pooled_total = 0;
+  for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+    const size_t* frequencies = partial_frequencies.data() + chunk * bin_count;
+    for (size_t bin = 0; bin < pooled_frequencies.size(); bin++) {
+      pooled_frequencies[bin] += frequencies[bin];
+      pooled_total += frequencies[bin];
+    }
+    for (size_t type = 0; type < type_count; type++) {
+      for (size_t bin = 0; bin < species_frequencies[type].size(); bin++) {
+        species_frequencies[type][bin] += frequencies[bin_offsets[type] + bin];
+      }
+    }
+  }
+
+  // The temperatures are fitted to the raw energies rather than the bin counts, so by
+  // Chernoff-Lehmann the statistic sits between chi squared with (bins - 1 - fitted)
+  // and (bins - 1) degrees of freedom. The latter keeps the test from firing early.
+  for (size_t type = 0; type < fits_.size(); type++) {
+    SpeciesFit& fit = fits_[type];
+    fit.degrees_of_freedom = species_frequencies[type].size() - 1;
+    fit.chi_squared = fit.count > 0 && fit.temperature > 0
+        ? ChiSquaredAgainstUniform(species_frequencies[type], fit.count) : 0;
+  }
+  double pooled_dof = double(pooled_frequencies.size() - 1);
+  double pooled_chi_squared = pooled_total > 0
+      ? ChiSquaredAgainstUniform(pooled_frequencies, pooled_total) : 0;
+
+  UpdateWindow(pooled_chi_squared / pooled_dof);
+}
+
+bool SpeedAnalytics::IsEquilibrated() const {
+  return equilibrium_step_ > 0;
+}
+
+size_t SpeedAnalytics::GetEquilibriumStep() const {
+  return equilibrium_step_;
+}
+
+double SpeedAnalytics::GetWindowedChiSquaredPerDof() const {
+  return window_chi_squared_.empty() ? 0 : window_chi_squared_sum_ / window_chi_squared_.size();
+}
+
+double SpeedAnalytics::GetAdaptiveSpeedInterval(size_t type, size_t speed_ticks) const {
+  const SpeciesFit& fit = fits_[type];
+  if (fit.count == 0 || fit.mean_mass <= 0 || speed_ticks == 0) {
+    return 0;
+  }
+  double temperature = fit.windowed_temperature > 0 ? fit.windowed_temperature : fit.temperature;
+  double thermal_speed = std::sqrt(2 * temperature / fit.mean_mass);
+  double interval = settings_.speed_range_factor * thermal_speed / speed_ticks;
+  return std::max(0.1, std::ceil(interval * 10) / 10);
+}
+
+const SpeciesFit& SpeedAnalytics::GetFit(size_t type) const {
+  return fits_[type];
+}
+
+size_t SpeedAnalytics::GetStepCount() const {
+  return step_count_;
+}
+
+void SpeedAnalytics::UpdateWindow(double pooled_chi_squared_per_dof) {
+  std::vector<double> temperatures(fits_.size());
+  for (size_t type = 0; type < fits_.size(); type++) {
+    temperatures[type] = fits_[type].temperature;
+    window_temperature_sums_[type] += temperatures[type];
+  }
+  window_chi_squared_.push_back(pooled_chi_squared_per_dof);
+  window_chi_squared_sum_ += pooled_chi_squared_per_dof;
+  window_temperatures_.push_back(temperatures);
+
+  if (window_chi_squared_.size() > settings_.window_size) {
+    window_chi_squared_sum_ -= window_chi_squared_.front();
+    window_chi_squared_.pop_front();
+    for (size_t type = 0; type < fits_.size(); type++) {
+      window_temperature_sums_[type] -= window_temperatures_.front()[type];
+    }
+    window_temperatures_.pop_front();
+  }
+
+  double min_temperature = 0;
+  double max_temperature = 0;
+  for (size_t type = 0; type < fits_.size(); type++) {
+    double windowed = window_temperature_sums_[type] / window_temperatures_.size();
+    fits_[type].windowed_temperature = windowed;
+    if (fits_[type].count == 0) {
+      continue;
+    }
+    min_temperature = min_temperature > 0 ? std::min(min_temperature, windowed) : windowed;
+    max_temperature = std::max(max_temperature, windowed);
+  }
+
+  // Equilibrium needs a full window, a Maxwell-Boltzmann fit, and equipartition between types
+  if (equilibrium_step_ == 0 && window_chi_squared_.size() == settings_.window_size &&
+      GetWindowedChiSquaredPerDof() <= settings_.max_chi_squared_per_dof &&
+      min_temperature > 0 &&
+      max_temperature / min_temperature - 1 <= settings_.max_temperature_spread) {
+    equilibrium_step_ = step_count_;
+  }
+}
+
+template <int D>
+size_t RunUntilEquilibrium(BasicGasContainer<D>& container, SpeedAnalytics& analytics,
+                           size_t max_steps) {
+  size_t steps = 0;
+  while (steps < max_steps && !analytics.IsEquilibrated()) {
+    container.Update();
+    analytics.Update(container.GetParticles());
+    steps++;
+  }
+  return steps;
+}
+
+template void SpeedAnalytics::Update(const std::vector<Particle>& particles,
+                                     ThreadPool* thread_pool);
+template void SpeedAnalytics::Update(const std::vector<Particle3D>& particles,
+                                     ThreadPool* thread_pool);
+template size_t RunUntilEquilibrium(GasContainer& container, SpeedAnalytics& analytics,
+                                    size_t max_steps);
+template size_t RunUntilEquilibrium(GasContainer3D& container, SpeedAnalytics& analytics,
+                                    size_t max_steps);
+
+}  // namespace idealgas
@@ -0,0 +1,102 @@
+#include <core/speed_distribution.h>
+
+namespace idealgas {
+
+namespace {
+
+// Below this many Particles a single thread counts faster than the pool can split the work
+const size_t kParallelCountThreshold = 16384;
+
+}  // namespace
+
+SpeedDistribution::SpeedDistribution(size_t speed_ticks, double speed_interval) :
+        speed_ticks_(speed_ticks), speed_interval_(speed_interval),
+        frequencies_(speed_ticks, 0) {}
+
+void SpeedDistribution::Reset() {
+  frequencies_.assign(speed_ticks_, 0);
+}
+
+template <int D>
+void SpeedDistribution::CountParticle(const BasicParticle<Scalar, D>& particle) {
+  double speed = glm::length(particle.GetVelocity());
+  size_t allocated_bin = 0;
+
+  // While the speed is above the minimum value of the next bin, assign to the next bin
+  while (speed > (allocated_bin + 1) * speed_interval_ && allocated_bin < speed_ticks_ - 1) {
+    allocated_bin++;
+  }
+  frequencies_[allocated_bin]++;
+}
+
+void SpeedDistribution::Merge(const SpeedDistribution& other) {
+  for (size_t bin = 0; bin < speed_ticks_ && bin < other.frequencies_.size(); bin++) {
+    frequencies_[bin] += other.frequencies_[bin];
+  }
+}
+
+void SpeedDistribution::SetSpeedInterval(double speed_interval) {
+  speed_interval_ = speed_interval;
+}
+
+const std::vector<size_t>& SpeedDistribution::GetFrequencies() const {
+  return frequencies_;
+}
+
+size_t SpeedDistribution::GetTotalFrequency() const {
+  size_t total_frequency = 0;
+  for (size_t frequency : frequencies_) {
+    total_frequency += frequency;
+  }
+  return total_frequency;
+}
+
+size_t SpeedDistribution::GetSpeedTicks() const {
+  return speed_ticks_;
+}
+
+double SpeedDistribution::GetSpeedInterval() const {
+  return speed_interval_;
+}
+
+template <int D>
+void CountSpeeds(const std::vector<BasicParticle<Scalar, D>>& particles,
+                 std::vector<SpeedDistribution>& distributions, ThreadPool* thread_pool) {
+  if (thread_pool == nullptr || particles.size() < kParallelCountThreshold) {
+    for (const BasicParticle<Scalar, D>& particle : particles) {
+      distributions[particle.GetType()].CountParticle(particle);
+    }
+    return;
+  }
+
+  std::vector<SpeedDistribution> empty_distributions;
+  for (const SpeedDistribution& distribution : distributions) {
+    empty_distributions.emplace_back(distribution.GetSpeedTicks(),
+                                     distribution.GetSpeedInterval());
+  }
+  size_t grain_size = thread_pool->GetGrainSize(particles.size(), 64);
+  std::vector<std::vector<SpeedDistribution>> partial_distributions(
+          (particles.size() + grain_size - 1) / grain_size, empty_distributions);
+
+  thread_pool->ParallelFor(0, particles.size(), grain_size, [&](size_t begin, size_t end) {
+    std::vector<SpeedDistribution>& partial = partial_distributions[begin / grain_size];
+    for (size_t i = begin; i < end; i++) {
+      partial[particles[i].GetType()].CountParticle(particles[i]);
+    }
+  });
+
+  for (const std::vector<SpeedDistribution>& partial : partial_distributions) {
+    for (size_t type = 0; type < distributions.size(); type++) {
+      distributions[type].Merge(partial[type]);
+    }
+  }
+}
+
+template void SpeedDistribution::CountParticle(const Particle&);
+template void SpeedDistribution::CountParticle(const Particle3D&);
+template void CountSpeeds(const std::vector<Particle>&, std::vector<SpeedDistribution>&,
+                          ThreadPool*);
+template void CountSpeeds(const std::vector<Particle3D>&, std::vector<SpeedDistribution>&,
+                          ThreadPool*);
+
+}  // namespace idealgas
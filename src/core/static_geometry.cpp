@@ -0,0 +1,330 @@
+#include <core/static_geometry.h>
+
+#include <core/memory_report.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * @return The point of a segment closest to a point
+ */
+glm::dvec2 ClosestPointOnSegment(const glm::dvec2& point, const glm::dvec2& start,
+                                 const glm::dvec2& end) {
+  glm::dvec2 direction = end - start;
+  double length_squared = glm::dot(direction, direction);
+  if (length_squared == 0) {
+    return start;
+  }
+  double t = glm::clamp(glm::dot(point - start, direction) / length_squared, 0.0, 1.0);
+  return start + direction * t;
+}
+
+/**
+ * Cuts a segment to the part inside a box, by Liang-Barsky clipping
+ * @param start The start of the segment, moved onto the box if outside
+ * @param end The end of the segment, moved onto the box if outside
+ * @param lower The corner of the box with the smallest coordinates
+ * @param upper The corner of the box with the largest coordinates
+ * @return False if no part of the segment is inside the box
+ */
+bool ClipSegment(glm::dvec2& start, glm::dvec2& end, const glm::dvec2& lower,
+                 const glm::dvec2& upper) {
+  glm::dvec2 direction = end - start;
+  double first = 0;
+  double last = 1;
+  for (int axis = 0; axis < 2; axis++) {
+    // Distances to the lower and upper wall along the segment
+    double offsets[2] = {start[axis] - lower[axis], upper[axis] - start[axis]};
+    double steps[2] = {-direction[axis], direction[axis]};
+    for (int side = 0; side < 2; side++) {
+      if (steps[side] == 0) {
+        if (offsets[side] < 0) {
+          return false;
+        }
+      } else if (steps[side] < 0) {
+        first = std::max(first, offsets[side] / steps[side]);
+      } else {
+        last = std::min(last, offsets[side] / steps[side]);
+      }
+    }
+  }
+  if (first > last) {
+    return false;
+  }
+  glm::dvec2 clipped_start = start + direction * first;
+  end = start + direction * last;
+  start = clipped_start;
+  return true;
+}
+
+/**
+ * Reads a fixed number of values from the rest of a config line
+ * @return True if exactly that many values were on the line
+ */
+bool ReadValues(std::istringstream& line, double* values, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (!(line >> values[i])) {
+      return false;
+    }
+  }
+  line >> std::ws;
+  return line.eof();
+}
+
+}  // namespace
+
+double Piston::GetPressure() const {
+  double length = glm::length(end - start);
+  return steps > 0 && length > 0 ? impulse / (double(steps) * length) : 0;
+}
+
+bool StaticGeometry::Load(std::istream& stream) {
+  std::string text;
+  while (std::getline(stream, text)) {
+    std::istringstream line(text);
+    std::string shape;
+    if (!(line >> shape) || shape[0] == '#') {
+      continue;
+    }
+
+    double values[7];
+    if (shape == "segment" && ReadValues(line, values, 4)) {
+      AddSegment(glm::dvec2(values[0], values[1]), glm::dvec2(values[2], values[3]));
+    } else if (shape == "circle" && ReadValues(line, values, 3) && values[2] > 0) {
+      AddCircle(glm::dvec2(values[0], values[1]), values[2]);
+    } else if (shape == "piston" && ReadValues(line, values, 7)) {
+      Piston piston;
+      piston.start = glm::dvec2(values[0], values[1]);
+      piston.end = glm::dvec2(values[2], values[3]);
+      piston.velocity = glm::dvec2(values[4], values[5]);
+      piston.travel = values[6];
+      AddPiston(piston);
+    } else if (shape == "polygon") {
+      // Read one value at a time, so a trailing unpaired coordinate is caught
+      std::vector<double> coordinates;
+      double value;
+      while (line >> value) {
+        coordinates.push_back(value);
+      }
+      line.clear();
+      line >> std::ws;
+      if (!line.eof() || coordinates.size() % 2 != 0 || coordinates.size() < 6) {
+        return false;
+      }
+      std::vector<glm::dvec2> corners;
+      for (size_t i = 0; i < coordinates.size(); i += 2) {
+        corners.emplace_back(coordinates[i], coordinates[i + 1]);
+      }
+      for (size_t i = 0; i < corners.size(); i++) {
+        AddSegment(corners[i], corners[(i + 1) % corners.size()]);
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StaticGeometry::LoadFile(const std::string& path) {
+  std::ifstream stream(path);
+  return stream.is_open() && Load(stream);
+}
+
+void StaticGeometry::AddSegment(const glm::dvec2& start, const glm::dvec2& end) {
+  Obstacle obstacle;
+  obstacle.shape = Obstacle::kSegment;
+  obstacle.start = start;
+  obstacle.end = end;
+  obstacles_.push_back(obstacle);
+}
+
+void StaticGeometry::AddCircle(const glm::dvec2& center, double radius) {
+  Obstacle obstacle;
+  obstacle.shape = Obstacle::kCircle;
+  obstacle.start = center;
+  obstacle.end = center;
+  obstacle.radius = radius;
+  obstacles_.push_back(obstacle);
+}
+
+void StaticGeometry::AddPiston(const Piston& piston) {
+  pistons_.push_back(piston);
+}
+
+void StaticGeometry::Clip(const glm::dvec2& top_left_corner, double box_width,
+                          double box_height) {
+  glm::dvec2 lower = top_left_corner;
+  glm::dvec2 upper = top_left_corner + glm::dvec2(box_width, box_height);
+
+  // Circles are kept while any part of them reaches into the box
+  std::vector<Obstacle> obstacles;
+  for (Obstacle obstacle : obstacles_) {
+    if (obstacle.shape == Obstacle::kCircle) {
+      glm::dvec2 nearest(glm::clamp(obstacle.start.x, lower.x, upper.x),
+                         glm::clamp(obstacle.start.y, lower.y, upper.y));
+      if (glm::length(obstacle.start - nearest) < obstacle.radius) {
+        obstacles.push_back(obstacle);
+      }
+    } else if (ClipSegment(obstacle.start, obstacle.end, lower, upper)) {
+      obstacles.push_back(obstacle);
+    }
+  }
+  obstacles_ = obstacles;
+
+  std::vector<Piston> pistons;
+  for (Piston piston : pistons_) {
+    if (ClipSegment(piston.start, piston.end, lower, upper)) {
+      pistons.push_back(piston);
+    }
+  }
+  pistons_ = pistons;
+}
+
+void StaticGeometry::Bake(const glm::dvec2& top_left_corner, double box_width,
+                          double box_height, double max_radius) {
+  grid_corner_ = top_left_corner;
+  cell_size_ = std::max({box_width / kMaxGridSide, box_height / kMaxGridSide,
+                         max_radius, 1e-6});
+  columns_ = size_t(box_width / cell_size_) + 1;
+  rows_ = size_t(box_height / cell_size_) + 1;
+
+  // A Particle centered in a cell can only touch obstacles within its radius of the cell,
+  // which is within max_radius plus half the cell diagonal of the cell's center
+  double reach = max_radius + cell_size_ * std::sqrt(0.5);
+  std::vector<std::vector<size_t>> cells(columns_ * rows_);
+  for (size_t index = 0; index < obstacles_.size(); index++) {
+    const Obstacle& obstacle = obstacles_[index];
+    double padding = obstacle.radius + reach;
+    glm::dvec2 lower = glm::min(obstacle.start, obstacle.end) - glm::dvec2(padding);
+    glm::dvec2 upper = glm::max(obstacle.start, obstacle.end) + glm::dvec2(padding);
+
+    double first_column = std::max(0.0, std::floor((lower.x - grid_corner_.x) / cell_size_));
+    double last_column = std::min(double(columns_ - 1),
+                                  std::floor((upper.x - grid_corner_.x) / cell_size_));
+    double first_row = std::max(0.0, std::floor((lower.y - grid_corner_.y) / cell_size_));
+    double last_row = std::min(double(rows_ - 1),
+                               std::floor((upper.y - grid_corner_.y) / cell_size_));
+    for (double row = first_row; row <= last_row; row++) {
+      for (double column = first_column; column <= last_column; column++) {
+        glm::dvec2 center = grid_corner_ + glm::dvec2(column + 0.5, row + 0.5) * cell_size_;
+        double distance = glm::length(
+                center - ClosestPointOnSegment(center, obstacle.start, obstacle.end));
+        if (distance <= padding) {
+          cells[size_t(row) * columns_ + size_t(column)].push_back(index);
+        }
+      }
+    }
+  }
+
+  cell_starts_.assign(1, 0);
+  cell_obstacles_.clear();
+  for (const std::vector<size_t>& cell : cells) {
+    cell_obstacles_.insert(cell_obstacles_.end(), cell.begin(), cell.end());
+    cell_starts_.push_back(cell_obstacles_.size());
+  }
+}
+
+void StaticGeometry::MovePistons() {
+  for (Piston& piston : pistons_) {
+    double speed = glm::length(piston.velocity);
+    if (piston.moved >= piston.travel || speed == 0) {
+      continue;
+    }
+    double distance = std::min(speed, piston.travel - piston.moved);
+    glm::dvec2 displacement = piston.velocity * (distance / speed);
+    piston.start += displacement;
+    piston.end += displacement;
+    piston.moved += distance;
+  }
+}
+
+size_t StaticGeometry::Collide(Particle& particle, double* piston_impulses) const {
+  glm::dvec2 position(particle.GetPosition());
+  glm::dvec2 velocity(particle.GetVelocity());
+  double radius = particle.GetRadius();
+  size_t bounces = 0;
+
+  if (!cell_starts_.empty()) {
+    double column = glm::clamp(std::floor((position.x - grid_corner_.x) / cell_size_),
+                               0.0, double(columns_ - 1));
+    double row = glm::clamp(std::floor((position.y - grid_corner_.y) / cell_size_),
+                            0.0, double(rows_ - 1));
+    size_t cell = size_t(row) * columns_ + size_t(column);
+    for (size_t k = cell_starts_[cell]; k < cell_starts_[cell + 1]; k++) {
+      const Obstacle& obstacle = obstacles_[cell_obstacles_[k]];
+      // A circle is a segment of zero length with a radius
+      glm::dvec2 offset = position -
+                          ClosestPointOnSegment(position, obstacle.start, obstacle.end);
+      double distance = glm::length(offset);
+      if (distance > 0 && distance <= radius + obstacle.radius &&
+          glm::dot(velocity, offset) < 0) {
+        glm::dvec2 normal = offset / distance;
+        velocity -= 2 * glm::dot(velocity, normal) * normal;
+        bounces++;
+      }
+    }
+  }
+
+  for (size_t index = 0; index < pistons_.size(); index++) {
+    const Piston& piston = pistons_[index];
+    glm::dvec2 offset = position - ClosestPointOnSegment(position, piston.start, piston.end);
+    double distance = glm::length(offset);
+    if (distance == 0 || distance > radius) {
+      continue;
+    }
+
+    // Reflect the velocity relative to the piston, as off an infinitely heavy wall
+    glm::dvec2 piston_velocity = piston.moved < piston.travel ? piston.velocity : glm::dvec2(0);
+    glm::dvec2 normal = offset / distance;
+    double approach_speed = glm::dot(velocity - piston_velocity, normal);
+    if (approach_speed < 0) {
+      velocity -= 2 * approach_speed * normal;
+      piston_impulses[index] -= 2 * double(particle.GetMass()) * approach_speed;
+      bounces++;
+    }
+  }
+
+  if (bounces > 0) {
+    particle.SetVelocity(Particle::Vec(velocity));
+  }
+  return bounces;
+}
+
+void StaticGeometry::AddPistonImpulses(const std::vector<double>& piston_impulses) {
+  for (size_t index = 0; index < pistons_.size() && index < piston_impulses.size(); index++) {
+    pistons_[index].impulse += piston_impulses[index];
+    pistons_[index].steps++;
+  }
+}
+
+void StaticGeometry::ResetPistonImpulses() {
+  for (Piston& piston : pistons_) {
+    piston.impulse = 0;
+    piston.steps = 0;
+  }
+}
+
+bool StaticGeometry::IsEmpty() const {
+  return obstacles_.empty() && pistons_.empty();
+}
+
+size_t StaticGeometry::GetMemoryUsage() const {
+  return GetAllocatedBytes(obstacles_) + GetAllocatedBytes(pistons_) +
+         GetAllocatedBytes(cell_starts_) + GetAllocatedBytes(cell_obstacles_);
+}
+
+const std::vector<Obstacle>& StaticGeometry::GetObstacles() const {
+  return obstacles_;
+}
+
+const std::vector<Piston>& StaticGeometry::GetPistons() const {
+  return pistons_;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,380 @@
+#include <core/statistics_log.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+namespace {
+
+const char kMagic[8] = {'I', 'G', 'S', 'T', 'A', 'T', 'S', '\0'};
+const uint32_t kVersion = 1;
+// Magic, footer offset, row group count
+const size_t kMinimumSize = 2 * sizeof(kMagic) + 2 * sizeof(uint64_t);
+
+template <typename T>
+void WriteValue(std::ostream& stream, const T& value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Reads a value at an offset of a buffer, advancing the offset
+ * @return True if the value was inside the buffer
+ */
+template <typename T>
+bool ReadValue(const char* bytes, size_t size, size_t& offset, T& value) {
+  if (offset > size || size - offset < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, bytes + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+inline uint64_t DoubleBits(double value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(double));
+  return bits;
+}
+
+}  // namespace
+
+std::vector<ColumnSchema> MakeStatisticsSchema(size_t type_count, size_t speed_ticks) {
+  std::vector<ColumnSchema> schema {
+          {"step", ColumnSchema::kUInt64, 1},
+          {"kinetic_energy", ColumnSchema::kFloat64, 1},
+          {"particle_collisions", ColumnSchema::kUInt64, 1},
+          {"wall_bounces", ColumnSchema::kUInt64, 1},
+          {"obstacle_bounces", ColumnSchema::kUInt64, 1}};
+  for (size_t type = 0; type < type_count; type++) {
+    std::string suffix = "_" + std::to_string(type);
+    schema.push_back({"temperature" + suffix, ColumnSchema::kFloat64, 1});
+    schema.push_back({"speed_interval" + suffix, ColumnSchema::kFloat64, 1});
+    schema.push_back({"speed_frequencies" + suffix, ColumnSchema::kUInt64,
+                      uint32_t(speed_ticks)});
+  }
+  return schema;
+}
+
+StatisticsWriter::StatisticsWriter(const std::string& path, size_t type_count,
+                                   size_t speed_ticks, size_t rows_per_group)
+    : schema_(MakeStatisticsSchema(type_count, speed_ticks)),
+      rows_per_group_(std::max<size_t>(1, rows_per_group)),
+      current_group_(schema_.size()),
+      stream_(path, std::ios::binary),
+      good_(false) {
+  size_t header_size = sizeof(kMagic) + 2 * sizeof(uint32_t);
+  stream_.write(kMagic, sizeof(kMagic));
+  WriteValue(stream_, kVersion);
+  WriteValue(stream_, uint32_t(schema_.size()));
+  for (const ColumnSchema& column : schema_) {
+    WriteValue(stream_, uint32_t(column.type));
+    WriteValue(stream_, column.width);
+    WriteValue(stream_, uint32_t(column.name.size()));
+    stream_.write(column.name.data(), std::streamsize(column.name.size()));
+    header_size += 3 * sizeof(uint32_t) + column.name.size();
+  }
+  // Pad, so every column buffer starts on an 8 byte boundary
+  for (; header_size % 8 != 0; header_size++) {
+    WriteValue(stream_, uint8_t(0));
+  }
+  good_ = stream_.good();
+
+  for (size_t column = 0; column < schema_.size(); column++) {
+    current_group_[column].reserve(rows_per_group_ * schema_[column].width);
+  }
+  writer_thread_ = std::thread(&StatisticsWriter::WriterLoop, this);
+}
+
+StatisticsWriter::~StatisticsWriter() {
+  Close();
+}
+
+void StatisticsWriter::Append(const StepStatistics& statistics) {
+  if (closed_) {
+    return;
+  }
+
+  // Columns in the order of MakeStatisticsSchema, missing types and bins as zeros
+  size_t column = 0;
+  current_group_[column++].push_back(statistics.step);
+  current_group_[column++].push_back(DoubleBits(statistics.kinetic_energy));
+  current_group_[column++].push_back(statistics.particle_collisions);
+  current_group_[column++].push_back(statistics.wall_bounces);
+  current_group_[column++].push_back(statistics.obstacle_bounces);
+  for (size_t type = 0; column < schema_.size(); type++) {
+    current_group_[column++].push_back(DoubleBits(
+            type < statistics.temperatures.size() ? statistics.temperatures[type] : 0));
+    current_group_[column++].push_back(DoubleBits(
+            type < statistics.speed_intervals.size() ? statistics.speed_intervals[type] : 0));
+
+    std::vector<uint64_t>& frequencies = current_group_[column];
+    for (size_t bin = 0; bin < schema_[column].width; bin++) {
+      bool has_bin = type < statistics.speed_frequencies.size() &&
+                     bin < statistics.speed_frequencies[type].size();
+      frequencies.push_back(has_bin ? statistics.speed_frequencies[type][bin] : 0);
+    }
+    column++;
+  }
+
+  if (++current_rows_ == rows_per_group_) {
+    QueueCurrentGroup();
+  }
+}
+
+void StatisticsWriter::Close() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+
+  if (current_rows_ > 0) {
+    QueueCurrentGroup();
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stopping_ = true;
+  }
+  queue_condition_.notify_one();
+  writer_thread_.join();
+}
+
+bool StatisticsWriter::IsGood() const {
+  return good_;
+}
+
+const std::vector<ColumnSchema>& StatisticsWriter::GetSchema() const {
+  return schema_;
+}
+
+void StatisticsWriter::QueueCurrentGroup() {
+  RowGroup next_group(schema_.size());
+  for (size_t column = 0; column < schema_.size(); column++) {
+    next_group[column].reserve(rows_per_group_ * schema_[column].width);
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queued_groups_.emplace_back(std::move(current_group_), current_rows_);
+  }
+  queue_condition_.notify_one();
+  current_group_ = std::move(next_group);
+  current_rows_ = 0;
+}
+
+void StatisticsWriter::WriterLoop() {
+  while (true) {
+    std::pair<RowGroup, size_t> group;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_condition_.wait(lock, [this]() { return stopping_ || !queued_groups_.empty(); });
+      if (queued_groups_.empty()) {
+        break;
+      }
+      group = std::move(queued_groups_.front());
+      queued_groups_.pop_front();
+    }
+
+    row_group_index_.emplace_back(uint64_t(stream_.tellp()), uint64_t(group.second));
+    for (const std::vector<uint64_t>& values : group.first) {
+      stream_.write(reinterpret_cast<const char*>(values.data()),
+                    std::streamsize(values.size() * sizeof(uint64_t)));
+    }
+    good_ = good_ && stream_.good();
+  }
+
+  // The footer is read from the end: the row group index, its offset, then the magic
+  uint64_t footer_offset = uint64_t(stream_.tellp());
+  WriteValue(stream_, uint64_t(row_group_index_.size()));
+  for (const std::pair<uint64_t, uint64_t>& row_group : row_group_index_) {
+    WriteValue(stream_, row_group.first);
+    WriteValue(stream_, row_group.second);
+  }
+  WriteValue(stream_, footer_offset);
+  stream_.write(kMagic, sizeof(kMagic));
+  stream_.flush();
+  good_ = good_ && stream_.good();
+}
+
+StatisticsReader::~StatisticsReader() {
+  Release();
+}
+
+bool StatisticsReader::Read(const std::string& path) {
+  schema_.clear();
+  column_offsets_.clear();
+  row_counts_.clear();
+  Release();
+  if (!Load(path) || size_ < kMinimumSize) {
+    return false;
+  }
+
+  // Header
+  size_t offset = sizeof(kMagic);
+  uint32_t version = 0;
+  uint32_t column_count = 0;
+  if (std::memcmp(data_, kMagic, sizeof(kMagic)) != 0 ||
+      !ReadValue(data_, size_, offset, version) || version != kVersion ||
+      !ReadValue(data_, size_, offset, column_count)) {
+    return false;
+  }
+  for (uint32_t column = 0; column < column_count; column++) {
+    uint32_t type = 0;
+    uint32_t width = 0;
+    uint32_t name_length = 0;
+    if (!ReadValue(data_, size_, offset, type) || type > ColumnSchema::kFloat64 ||
+        !ReadValue(data_, size_, offset, width) ||
+        !ReadValue(data_, size_, offset, name_length) ||
+        size_ - offset < name_length) {
+      return false;
+    }
+    schema_.push_back({std::string(data_ + offset, name_length),
+                       ColumnSchema::Type(type), width});
+    offset += name_length;
+  }
+  size_t data_start = (offset + 7) / 8 * 8;
+
+  // Footer
+  size_t magic_offset = size_ - sizeof(kMagic);
+  size_t footer_offset_position = magic_offset - sizeof(uint64_t);
+  uint64_t footer_offset = 0;
+  uint64_t group_count = 0;
+  if (std::memcmp(data_ + magic_offset, kMagic, sizeof(kMagic)) != 0 ||
+      !ReadValue(data_, size_, footer_offset_position, footer_offset) ||
+      footer_offset < data_start || footer_offset > magic_offset) {
+    return false;
+  }
+  offset = size_t(footer_offset);
+  if (!ReadValue(data_, size_, offset, group_count) ||
+      group_count > (magic_offset - offset) / (2 * sizeof(uint64_t))) {
+    return false;
+  }
+
+  // Every column of every row group must lie between the header and the footer
+  for (uint64_t group = 0; group < group_count; group++) {
+    uint64_t group_offset = 0;
+    uint64_t row_count = 0;
+    ReadValue(data_, size_, offset, group_offset);
+    ReadValue(data_, size_, offset, row_count);
+    if (group_offset < data_start || group_offset % 8 != 0 || group_offset > footer_offset) {
+      return false;
+    }
+
+    std::vector<size_t> offsets;
+    uint64_t column_offset = group_offset;
+    for (const ColumnSchema& column : schema_) {
+      uint64_t column_size = row_count * column.width * sizeof(uint64_t);
+      if (column.width > 0 && (row_count > footer_offset / column.width ||
+                               column_size > footer_offset - column_offset)) {
+        return false;
+      }
+      offsets.push_back(size_t(column_offset));
+      column_offset += column_size;
+    }
+    column_offsets_.push_back(offsets);
+    row_counts_.push_back(size_t(row_count));
+  }
+  return true;
+}
+
+size_t StatisticsReader::FindColumn(const std::string& name) const {
+  for (size_t column = 0; column < schema_.size(); column++) {
+    if (schema_[column].name == name) {
+      return column;
+    }
+  }
+  return schema_.size();
+}
+
+const uint64_t* StatisticsReader::GetUInt64Column(size_t group, size_t column) const {
+  if (column >= schema_.size() || schema_[column].type != ColumnSchema::kUInt64) {
+    return nullptr;
+  }
+  return reinterpret_cast<const uint64_t*>(data_ + column_offsets_[group][column]);
+}
+
+const double* StatisticsReader::GetFloat64Column(size_t group, size_t column) const {
+  if (column >= schema_.size() || schema_[column].type != ColumnSchema::kFloat64) {
+    return nullptr;
+  }
+  return reinterpret_cast<const double*>(data_ + column_offsets_[group][column]);
+}
+
+bool StatisticsReader::IsMapped() const {
+  return mapping_ != nullptr;
+}
+
+const std::vector<ColumnSchema>& StatisticsReader::GetSchema() const {
+  return schema_;
+}
+
+size_t StatisticsReader::GetRowGroupCount() const {
+  return row_counts_.size();
+}
+
+size_t StatisticsReader::GetRowCount(size_t group) const {
+  return row_counts_[group];
+}
+
+size_t StatisticsReader::GetRowCount() const {
+  size_t row_count = 0;
+  for (size_t rows : row_counts_) {
+    row_count += rows;
+  }
+  return row_count;
+}
+
+bool StatisticsReader::Load(const std::string& path) {
+#ifndef _WIN32
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  struct stat status;
+  if (fstat(file, &status) == 0 && status.st_size > 0) {
+    void* mapping = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    if (mapping != MAP_FAILED) {
+      mapping_ = mapping;
+      data_ = static_cast<const char*>(mapping);
+      size_ = size_t(status.st_size);
+    }
+  }
+  close(file);
+  if (mapping_ != nullptr) {
+    return true;
+  }
+#endif
+
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream.is_open()) {
+    return false;
+  }
+  bytes_.resize(size_t(stream.tellg()));
+  stream.seekg(0);
+  if (!stream.read(bytes_.data(), std::streamsize(bytes_.size()))) {
+    return false;
+  }
+  data_ = bytes_.data();
+  size_ = bytes_.size();
+  return true;
+}
+
+void StatisticsReader::Release() {
+#ifndef _WIN32
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+  }
+#endif
+  mapping_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+  std::vector<char>().swap(bytes_);
+}
+
+}  // namespace idealgas
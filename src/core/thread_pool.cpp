@@ -0,0 +1,129 @@
+#include <core/thread_pool.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+ThreadPool::ThreadPool(size_t thread_count) : queued_tasks_(0), stopping_(false) {
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  for (size_t i = 0; i < thread_count; i++) {
+    queues_.emplace_back(new WorkQueue());
+  }
+  for (size_t i = 0; i < thread_count; i++) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_ = true;
+  }
+  wake_condition_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain_size,
+                             const std::function<void(size_t, size_t)>& body) {
+  if (begin >= end) {
+    return;
+  }
+  grain_size = std::max<size_t>(1, grain_size);
+
+  size_t chunk_count = (end - begin + grain_size - 1) / grain_size;
+  std::atomic<size_t> remaining_chunks(chunk_count);
+  std::mutex done_mutex;
+  std::condition_variable done_condition;
+
+  // Deal the chunks round robin, so every worker starts with local work
+  for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+    size_t chunk_begin = begin + chunk * grain_size;
+    size_t chunk_end = std::min(end, chunk_begin + grain_size);
+    WorkQueue& queue = *queues_[chunk % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    ++queued_tasks_;
+    queue.tasks.emplace_back([&, chunk_begin, chunk_end]() {
+      body(chunk_begin, chunk_end);
+      // Decrement under the lock, so the waiter cannot return and destroy
+      // the locals while they are still being used here
+      std::lock_guard<std::mutex> done_lock(done_mutex);
+      if (--remaining_chunks == 0) {
+        done_condition.notify_all();
+      }
+    });
+  }
+  {
+    // Serialise with workers checking the wake predicate, so none miss the notify
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+  }
+  wake_condition_.notify_all();
+
+  // Help out instead of idling, then wait for chunks still running on workers
+  std::function<void()> task;
+  while (remaining_chunks > 0 && TakeTask(0, task)) {
+    task();
+  }
+  std::unique_lock<std::mutex> done_lock(done_mutex);
+  done_condition.wait(done_lock, [&]() { return remaining_chunks == 0; });
+}
+
+size_t ThreadPool::GetGrainSize(size_t count, size_t alignment) const {
+  // Four chunks per thread absorb uneven chunk times without much queueing overhead
+  alignment = std::max<size_t>(1, alignment);
+  size_t grain_size = (count + 4 * workers_.size() - 1) / (4 * workers_.size());
+  return std::max<size_t>(1, (grain_size + alignment - 1) / alignment) * alignment;
+}
+
+size_t ThreadPool::GetThreadCount() const {
+  return workers_.size();
+}
+
+void ThreadPool::WorkerLoop(size_t worker_index) {
+  std::function<void()> task;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_condition_.wait(lock, [this]() { return stopping_ || queued_tasks_ > 0; });
+      if (stopping_) {
+        return;
+      }
+    }
+
+    while (TakeTask(worker_index, task)) {
+      task();
+    }
+  }
+}
+
+bool ThreadPool::TakeTask(size_t queue_index, std::function<void()>& task) {
+  // Own queue first, newest task first, since its data is most likely still cached
+  {
+    WorkQueue& queue = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      --queued_tasks_;
+      return true;
+    }
+  }
+
+  for (size_t offset = 1; offset < queues_.size(); offset++) {
+    WorkQueue& victim = *queues_[(queue_index + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      --queued_tasks_;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace idealgas
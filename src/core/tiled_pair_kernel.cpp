@@ -0,0 +1,106 @@
+#include <core/tiled_pair_kernel.h>
+
+#include <core/memory_report.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace idealgas {
+
+namespace {
+
+// The squared cutoff is widened by this fraction, so rounding in the tile never drops a
+// pair that CheckCollision, which compares unsquared distances, would accept
+const Scalar kCutoffPadding = Scalar(1e-4);
+
+}  // namespace
+
+template <int D>
+void BasicTiledPairKernel<D>::FindPairs(ParticleSpan<const Particle> particles) {
+  size_t particle_count = particles.size();
+  for (int axis = 0; axis < D; axis++) {
+    coordinates_[axis].resize(particle_count);
+  }
+  radii_.resize(particle_count);
+  for (size_t i = 0; i < particle_count; i++) {
+    for (int axis = 0; axis < D; axis++) {
+      coordinates_[axis][i] = particles[i].GetPosition()[axis];
+    }
+    radii_[i] = particles[i].GetRadius();
+  }
+
+  // Local, so the compiler knows the flags alias none of the coordinates
+  uint32_t hits[kTileSize];
+  pairs_.clear();
+  for (size_t row_begin = 0; row_begin < particle_count; row_begin += kTileSize) {
+    size_t row_end = std::min(particle_count, row_begin + kTileSize);
+    size_t row_pairs_begin = pairs_.size();
+
+    for (size_t column_begin = row_begin; column_begin < particle_count;
+         column_begin += kTileSize) {
+      size_t column_end = std::min(particle_count, column_begin + kTileSize);
+      for (size_t i = row_begin; i < row_end; i++) {
+        // Within the diagonal tile only the pairs above the diagonal are tested
+        size_t begin = std::max(column_begin, i + 1);
+        if (begin >= column_end) {
+          continue;
+        }
+
+        Scalar position[D];
+        const Scalar* column_coordinates[D];
+        for (int axis = 0; axis < D; axis++) {
+          position[axis] = coordinates_[axis][i];
+          column_coordinates[axis] = coordinates_[axis].data() + begin;
+        }
+        Scalar radius = radii_[i];
+        const Scalar* column_radii = radii_.data() + begin;
+        size_t width = column_end - begin;
+
+        // Branch free, so the whole row is tested a vector of pairs at a time
+        uint32_t any_hit = 0;
+        for (size_t k = 0; k < width; k++) {
+          Scalar distance_squared = 0;
+          for (int axis = 0; axis < D; axis++) {
+            Scalar difference = position[axis] - column_coordinates[axis][k];
+            distance_squared += difference * difference;
+          }
+          Scalar cutoff = radius + column_radii[k];
+          uint32_t hit = distance_squared <= cutoff * cutoff * (1 + kCutoffPadding);
+          hits[k] = hit;
+          any_hit |= hit;
+        }
+        if (any_hit == 0) {
+          continue;
+        }
+        for (size_t k = 0; k < width; k++) {
+          if (hits[k] != 0) {
+            pairs_.emplace_back(i, begin + k);
+          }
+        }
+      }
+    }
+
+    // The column tiles were visited in turn, so the pairs of this row tile are regrouped
+    // by their smaller index
+    std::sort(pairs_.begin() + row_pairs_begin, pairs_.end());
+  }
+}
+
+template <int D>
+const std::vector<std::pair<size_t, size_t>>& BasicTiledPairKernel<D>::GetPairs() const {
+  return pairs_;
+}
+
+template <int D>
+size_t BasicTiledPairKernel<D>::GetMemoryUsage() const {
+  size_t bytes = GetAllocatedBytes(radii_) + GetAllocatedBytes(pairs_);
+  for (int axis = 0; axis < D; axis++) {
+    bytes += GetAllocatedBytes(coordinates_[axis]);
+  }
+  return bytes;
+}
+
+template class BasicTiledPairKernel<2>;
+template class BasicTiledPairKernel<3>;
+
+}  // namespace idealgas
@@ -8,16 +8,14 @@ using glm::vec2;
 
 Histogram::Histogram(size_t speed_ticks, double speed_interval,
                      size_t frequency_ticks, ci::Color histogram_color) :
-  kSpeedTicks(speed_ticks), kSpeedInterval(speed_interval),
-  kFrequencyTicks(frequency_ticks), kHistogramColor(histogram_color){
+  kSpeedTicks(speed_ticks),
+  kFrequencyTicks(frequency_ticks), kHistogramColor(histogram_color),
+  distribution_(speed_ticks, speed_interval) {
 
 };
 
 void Histogram::Draw(const glm::vec2& offset, float width, float height) const {
-  size_t total_frequency = 0;
-  for (size_t frequency: frequencies_) {
-    total_frequency += frequency;
-  }
+  size_t total_frequency = distribution_.GetTotalFrequency();
 
   DrawBackground(offset, width, height);
   DrawTicks(offset, width, height, total_frequency);
@@ -25,21 +23,41 @@ void Histogram::Draw(const glm::vec2& offset, float width, float height) const {
 }
 
 void Histogram::ResetCount() {
-  frequencies_ = std::vector<size_t> (kSpeedTicks, 0);
+  distribution_.Reset();
 }
 
-void Histogram::CountParticle(const Particle &particle) {
-  double speed = glm::length(particle.GetVelocity());
-  size_t allocated_bin = 0;
+template <int D>
+void Histogram::CountParticle(const BasicParticle<Scalar, D> &particle) {
+  distribution_.CountParticle(particle);
+}
 
-  // While the speed is above the minimum value of the next bin, assign to the next bin
-  while(speed > (allocated_bin + 1) * kSpeedInterval && allocated_bin < kSpeedTicks - 1) {
-    allocated_bin++;
-  }
-  frequencies_[allocated_bin]++;
+template void Histogram::CountParticle(const Particle &particle);
+template void Histogram::CountParticle(const Particle3D &particle);
+
+void Histogram::SetDistribution(const SpeedDistribution& distribution) {
+  distribution_ = distribution;
+}
+
+void Histogram::SetSpeedInterval(double speed_interval) {
+  distribution_.SetSpeedInterval(speed_interval);
+}
+
+const SpeedDistribution& Histogram::GetDistribution() const {
+  return distribution_;
+}
+
+const ci::Font& Histogram::GetAxisLabelFont() {
+  static const ci::Font kAxisLabelFont("Arial", 20);
+  return kAxisLabelFont;
+}
+
+const ci::Font& Histogram::GetTickLabelFont() {
+  static const ci::Font kTickLabelFont("Arial", 15);
+  return kTickLabelFont;
 }
 
 void Histogram::DrawBackground(const glm::vec2& offset, float width, float height) const {
+  const ci::Font& axis_label_font = GetAxisLabelFont();
   ci::Rectf bounding_box(vec2(0, 0) + offset, vec2(width, height) + offset);
   ci::gl::color(ci::Color(kHistogramColor));
   ci::gl::drawStrokedRect(bounding_box, 5);
@@ -48,24 +66,25 @@ void Histogram::DrawBackground(const glm::vec2& offset, float width, float heigh
 
   // Axis labels
   ci::gl::drawStringCentered(kXLabel,
-                        vec2(width / 2, height + 2 * kAxisLabelFont.getSize()) + offset,
+                        vec2(width / 2, height + 2 * axis_label_font.getSize()) + offset,
                        ci::ColorA(1, 1, 1, 1),
-                        kAxisLabelFont);
+                        axis_label_font);
 
   // Code below derived from:
   // https://discourse.libcinder.org/t/what-is-the-best-way-to-rotate-rectangles-images/410
   ci::gl::translate(offset);
   ci::gl::rotate(-1.5708f); // Rotate pi / 2 radians
   ci::gl::drawStringCentered(kYLabel,
-                             vec2(-height / 2, - 3 * kAxisLabelFont.getSize()),
+                             vec2(-height / 2, - 3 * axis_label_font.getSize()),
                              ci::ColorA(1, 1, 1, 1),
-                             kAxisLabelFont);
+                             axis_label_font);
   ci::gl::rotate(1.5708f);
   ci::gl::translate(-offset);
 }
 
 void Histogram::DrawTicks(const glm::vec2& offset, float width,
                           float height, size_t total_frequency) const {
+  const ci::Font& tick_label_font = GetTickLabelFont();
   ci::gl::color(ci::Color("grey"));
   float y_tick_spacing = height / kFrequencyTicks;
   for (float tick_count = 0; tick_count <= kFrequencyTicks; tick_count++) {
@@ -80,7 +99,7 @@ void Histogram::DrawTicks(const glm::vec2& offset, float width,
     ci::gl::drawStringRight(tick_label_stream.str(),
                        vec2(-5, height - (y_tick_spacing * tick_count) - 10) + offset,
                        ci::ColorA(1, 1, 1, 1),
-                       kTickLabelFont);
+                       tick_label_font);
   }
 
   float x_tick_spacing = width / kSpeedTicks;
@@ -88,13 +107,13 @@ void Histogram::DrawTicks(const glm::vec2& offset, float width,
     ci::gl::drawLine(vec2(x_tick_spacing * tick_count, 0) + offset,
                      vec2(x_tick_spacing * tick_count, height) + offset);
 
-    double tick_label = tick_count * kSpeedInterval;
+    double tick_label = tick_count * distribution_.GetSpeedInterval();
     std::stringstream tick_label_stream;
     tick_label_stream << std::fixed << std::setprecision(1) << tick_label;
     ci::gl::drawString(tick_label_stream.str(),
                   vec2(x_tick_spacing * tick_count, height + 5) + offset,
                   ci::ColorA(1, 1, 1, 1),
-                  kTickLabelFont);
+                  tick_label_font);
   }
 }
 
@@ -104,7 +123,7 @@ void Histogram::DrawBars(const glm::vec2& offset, float width,
   float x_tick_spacing = width / kSpeedTicks;
 
   for (size_t frequency_bin = 0; frequency_bin < kSpeedTicks; frequency_bin++) {
-    float bar_ratio = float(frequencies_[frequency_bin]) / float(total_frequency);
+    float bar_ratio = float(distribution_.GetFrequencies()[frequency_bin]) / float(total_frequency);
     vec2 bottom_left = vec2(x_tick_spacing * frequency_bin, height) + offset;
     vec2 top_right = vec2(x_tick_spacing * (frequency_bin + 1),
                           height  * (1- bar_ratio)) + offset;
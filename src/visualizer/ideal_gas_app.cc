@@ -1,25 +1,166 @@
 #include <visualizer/ideal_gas_app.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
 namespace idealgas {
 
 namespace visualizer {
 
-IdealGasApp::IdealGasApp()
-    : simulation_(glm::vec2(kMargin, kMargin),
-                  kBoxWidth, kBoxHeight)  {
+namespace {
+
+/**
+ * @return The IDEALGAS_THREADS environment variable, or 0 for one thread per hardware thread
+ */
+size_t GetThreadCountSetting() {
+  const char* thread_count = std::getenv("IDEALGAS_THREADS");
+  return thread_count != nullptr ? std::strtoul(thread_count, nullptr, 10) : 0;
+}
+
+/**
+ * @return The IDEALGAS_SEED environment variable, or the current time to seed each run apart
+ */
+unsigned int GetSeedSetting() {
+  const char* seed = std::getenv("IDEALGAS_SEED");
+  return seed != nullptr ? unsigned(std::strtoul(seed, nullptr, 10)) : unsigned(time(0));
+}
+
+/**
+ * @return True if the IDEALGAS_DIMENSIONS environment variable asks for a 3D gas
+ */
+bool Is3DSetting() {
+  const char* dimensions = std::getenv("IDEALGAS_DIMENSIONS");
+  return dimensions != nullptr && std::strtoul(dimensions, nullptr, 10) == 3;
+}
+
+/**
+ * Loads static geometry, records a replay, exports statistics and serves metrics as the
+ * environment asks
+ * @param simulation The Simulation
+ */
+template <int D>
+void ConfigureSimulation(BasicSimulation<D>& simulation) {
+  if (const char* geometry_path = std::getenv("IDEALGAS_GEOMETRY")) {
+    simulation.LoadStaticGeometry(geometry_path);
+  }
+
+  // After the geometry, which the replay header records
+  if (const char* replay_path = std::getenv("IDEALGAS_REPLAY")) {
+    simulation.RecordReplay(replay_path);
+  }
+
+  if (const char* statistics_path = std::getenv("IDEALGAS_STATISTICS")) {
+    simulation.ExportStatistics(statistics_path);
+  }
+
+  if (const char* quantized = std::getenv("IDEALGAS_QUANTIZED_SNAPSHOTS")) {
+    simulation.SetQuantizedSnapshots(std::strtoul(quantized, nullptr, 10) != 0);
+  }
+
+  // Unattended runs can be scraped instead of watched
+  if (const char* socket_path = std::getenv("IDEALGAS_METRICS_SOCKET")) {
+    simulation.ServeMetrics(std::string(socket_path));
+  } else if (const char* port = std::getenv("IDEALGAS_METRICS_PORT")) {
+    simulation.ServeMetrics(uint16_t(std::strtoul(port, nullptr, 10)));
+  }
+}
+
+}  // namespace
+
+IdealGasApp::IdealGasApp() {
   ci::app::setWindowSize((int) kWindowSize, (int) kWindowSize);
+
+  if (Is3DSetting()) {
+    simulation_3d_.reset(new Simulation3D(glm::vec2(kMargin, kMargin),
+                                          kBoxWidth, kBoxHeight, GetThreadCountSetting(),
+                                          GetSeedSetting()));
+    ConfigureSimulation(*simulation_3d_);
+  } else {
+    simulation_.reset(new Simulation(glm::vec2(kMargin, kMargin),
+                                     kBoxWidth, kBoxHeight, GetThreadCountSetting(),
+                                     GetSeedSetting()));
+    ConfigureSimulation(*simulation_);
+  }
 }
 
 void IdealGasApp::draw() {
   ci::Color8u background_color(20, 20, 20);
   ci::gl::clear(background_color);
 
-  simulation_.Draw();
+  if (simulation_3d_ != nullptr) {
+    simulation_3d_->Draw();
+  } else {
+    simulation_->Draw();
+  }
 }
 
 void IdealGasApp::update() {
-  simulation_.Update();
+  if (simulation_3d_ != nullptr) {
+    simulation_3d_->Update();
+  } else {
+    simulation_->Update();
+  }
+
+  // After the first step, which builds the neighbour list and publishes the first snapshot
+  if (!memory_reported_) {
+    MemoryReport report = simulation_3d_ != nullptr ? simulation_3d_->GetMemoryReport()
+                                                    : simulation_->GetMemoryReport();
+    std::fputs(report.Format().c_str(), stdout);
+    memory_reported_ = true;
+  }
 }
+
+void IdealGasApp::keyDown(ci::app::KeyEvent event) {
+  if (simulation_3d_ != nullptr) {
+    ApplyKey(*simulation_3d_, event);
+  } else {
+    ApplyKey(*simulation_, event);
+  }
+}
+
+template <int D>
+void IdealGasApp::ApplyKey(BasicSimulation<D>& simulation, const ci::app::KeyEvent& event) {
+  // Every change applies between two steps, without restarting the Simulation
+  char key = event.getChar();
+  if (key >= '1' && key <= '9' && size_t(key - '1') < simulation.GetParticleTypeCount()) {
+    selected_type_ = size_t(key - '1');
+  } else if (key == '+' || event.getCode() == ci::app::KeyEvent::KEY_EQUALS) {
+    simulation.AddParticles(selected_type_, kParticleBatchSize);
+  } else if (key == '-' || event.getCode() == ci::app::KeyEvent::KEY_MINUS) {
+    simulation.RemoveParticles(selected_type_, kParticleBatchSize);
+  } else if (key == 'h') {
+    simulation.ScaleVelocities(kHeatingFactor);
+  } else if (key == 'c') {
+    simulation.ScaleVelocities(1 / kHeatingFactor);
+  } else {
+    // The box stays inside the window, left of the histograms
+    double width = box_width_;
+    double height = box_height_;
+    switch (event.getCode()) {
+      case ci::app::KeyEvent::KEY_RIGHT:
+        width = std::min(kBoxWidth, width + kBoxResizeStep);
+        break;
+      case ci::app::KeyEvent::KEY_LEFT:
+        width = std::max(kMinBoxSize, width - kBoxResizeStep);
+        break;
+      case ci::app::KeyEvent::KEY_DOWN:
+        height = std::min(kWindowSize - 2 * kMargin, height + kBoxResizeStep);
+        break;
+      case ci::app::KeyEvent::KEY_UP:
+        height = std::max(kMinBoxSize, height - kBoxResizeStep);
+        break;
+      default:
+        return;
+    }
+    if ((width != box_width_ || height != box_height_) && simulation.ResizeBox(width, height)) {
+      box_width_ = width;
+      box_height_ = height;
+    }
+  }
+}
+
 }  // namespace visualizer
 
 }  // namespace idealgas
@@ -1,110 +1,490 @@
 #include <visualizer/simulation.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace idealgas {
 
 namespace visualizer {
 
 using glm::vec2;
 
-Simulation::Simulation(const glm::vec2 &top_left_corner,
-                       double box_width, double box_height)
-    : top_left_corner_(top_left_corner),
-      box_width_(box_width),
-      box_height_(box_height) {
-    InitializeParticles();
+template <int D>
+BasicSimulation<D>::BasicSimulation(const glm::vec2 &top_left_corner,
+                                    double box_width, double box_height, size_t thread_count,
+                                    unsigned int seed)
+    : construction_start_(std::chrono::steady_clock::now()),
+      thread_pool_(thread_count),
+      container_(particle_configs_, GetContainerCorner(top_left_corner),
+                 GetContainerSize(box_width, box_height), seed, &thread_pool_),
+      speed_analytics_(particle_configs_.size()),
+      metrics_({"physics", "analytics", "density", "publish"}, particle_configs_.size()),
+      metrics_exporter_(metrics_),
+      density_field_(size_t(box_width / kDensityCellSize),
+                     size_t(box_height / kDensityCellSize),
+                     particle_configs_.size()),
+      density_surface_(int(density_field_.GetColumns()), int(density_field_.GetRows()), false) {
     InitializeHistograms();
+    construction_time_ = std::chrono::steady_clock::now() - construction_start_;
 }
 
-void Simulation::Draw() const {
+template <int D>
+void BasicSimulation<D>::Draw() const {
+  vec2 top_left_corner(container_.GetTopLeftCorner().x, container_.GetTopLeftCorner().y);
+  double box_width = container_.GetBoxWidth();
+  double box_height = container_.GetBoxHeight();
+
   ci::gl::color(ci::Color("white"));
-  ci::Rectf gas_box(top_left_corner_, top_left_corner_ + vec2(box_width_,box_height_));
+  ci::Rectf gas_box(top_left_corner, top_left_corner + vec2(box_width, box_height));
   ci::gl::drawStrokedRect(gas_box, 5);
 
-  for (const Particle& particle : particles_) {
-    ci::gl::color(particle.GetColor());
-    ci::gl::drawSolidCircle(particle.GetPosition(), particle.GetRadius());
+  DrawStaticGeometry();
+  if (UsesDensityField()) {
+    DrawDensityField(gas_box);
+  } else {
+    DrawParticles();
   }
 
   for (size_t i = 0; i < histograms_.size(); i++) {
-    histograms_[i].Draw(top_left_corner_ +
-      vec2(box_width_ + kHistogramSpacing, (kHistogramHeight + kHistogramSpacing) * i),
+    histograms_[i].Draw(top_left_corner +
+      vec2(box_width + kHistogramSpacing, (kHistogramHeight + kHistogramSpacing) * i),
       kHistogramWidth, kHistogramHeight);
   }
 }
 
-void Simulation::Update() {
-  ProcessParticleMovement();
-  ProcessParticleCollision();
+template <int D>
+void BasicSimulation<D>::Update() {
+  std::chrono::steady_clock::time_point update_start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point phase_start = update_start;
+  container_.Update();
+  phase_start = EndPhase(kPhysicsPhase, phase_start);
+
   UpdateHistogram();
+  phase_start = EndPhase(kAnalyticsPhase, phase_start);
+
+  if (UsesDensityField()) {
+    BuildDensityField();
+    phase_start = EndPhase(kDensityPhase, phase_start);
+  }
+
+  step_count_++;
+  PublishSnapshot();
+  RecordStatistics();
+  if (replay_recorder_) {
+    replay_recorder_->RecordStep(container_.GetParticles());
+  }
+  phase_start = EndPhase(kPublishPhase, phase_start);
+  if (step_count_ == 1) {
+    metrics_.SetStartupTimes(construction_time_, phase_start - update_start);
+  }
+  UpdateMetrics();
+}
+
+template <int D>
+const std::vector<typename BasicSimulation<D>::Particle>&
+BasicSimulation<D>::GetParticles() const {
+  return container_.GetParticles();
+}
+
+template <int D>
+Scalar BasicSimulation<D>::GetKineticEnergy() const {
+  return container_.GetKineticEnergy();
+}
+
+template <int D>
+bool BasicSimulation<D>::AddParticles(size_t type, size_t amount) {
+  if (type >= particle_configs_.size()) {
+    return false;
+  }
+  ParticleConfig particle_config = particle_configs_[type];
+  particle_config.amount = amount;
+  if (!ApplyEdit(BasicReplayEdit<D>::AddParticles(particle_config))) {
+    return false;
+  }
+  // Draw may switch to the density field before the next step builds it
+  if (UsesDensityField()) {
+    BuildDensityField();
+  }
+  return true;
+}
+
+template <int D>
+size_t BasicSimulation<D>::RemoveParticles(size_t type, size_t amount) {
+  size_t particle_count = container_.GetParticles().size();
+  if (ApplyEdit(BasicReplayEdit<D>::RemoveParticles(type, amount)) && UsesDensityField()) {
+    BuildDensityField();
+  }
+  return particle_count - container_.GetParticles().size();
+}
+
+template <int D>
+void BasicSimulation<D>::ScaleVelocities(double factor) {
+  ApplyEdit(BasicReplayEdit<D>::ScaleVelocities(factor));
+}
+
+template <int D>
+bool BasicSimulation<D>::ResizeBox(double box_width, double box_height) {
+  if (!ApplyEdit(BasicReplayEdit<D>::ResizeBox(GetContainerSize(box_width, box_height)))) {
+    return false;
+  }
+
+  // Cells keep their size, so the grid and the texture drawn from it are resized
+  density_field_ = DensityField(size_t(box_width / kDensityCellSize),
+                                size_t(box_height / kDensityCellSize),
+                                particle_configs_.size());
+  density_surface_ = ci::Surface8u(int(density_field_.GetColumns()),
+                                   int(density_field_.GetRows()), false);
+  density_texture_.reset();
+  if (UsesDensityField()) {
+    BuildDensityField();
+  }
+  return true;
+}
+
+template <int D>
+size_t BasicSimulation<D>::GetParticleTypeCount() const {
+  return particle_configs_.size();
 }
 
-void Simulation::InitializeParticles() {
-  srand((unsigned int)time(0));
-  std::vector<Particle> initial_particles;
-  for (const ParticleConfig& particle_type : particle_configs_) {
-    for (size_t i = 0; i < particle_type.amount; i++) {
-      double x_pos = GenerateRandomDouble(top_left_corner_.x, top_left_corner_.x + box_width_);
-      double y_pos = GenerateRandomDouble(top_left_corner_.y, top_left_corner_.y + box_height_);
-
-      double max_velocity = particle_type.radius * kMaxSpeedFactor;
-      double min_velocity = -particle_type.radius * kMaxSpeedFactor;
-      double x_vel = GenerateRandomDouble(min_velocity, max_velocity);
-      double y_vel = GenerateRandomDouble(min_velocity, max_velocity);
-
-      initial_particles.emplace_back(particle_type.type,
-                                     vec2(x_pos, y_pos),
-                              vec2(x_vel, y_vel),
-                                     particle_type.color,
-                                     particle_type.radius,
-                                     particle_type.mass);
+template <int D>
+SnapshotPublisher::View BasicSimulation<D>::AcquireSnapshot() const {
+  return snapshot_publisher_.Acquire();
+}
+
+template <int D>
+const SpeedAnalytics& BasicSimulation<D>::GetSpeedAnalytics() const {
+  return speed_analytics_;
+}
+
+template <int D>
+bool BasicSimulation<D>::LoadStaticGeometry(const std::string& path) {
+  if constexpr (D != 2) {
+    return false;
+  }
+  // The header of a replay being recorded already holds the geometry it started with
+  if (replay_recorder_) {
+    return false;
+  }
+
+  StaticGeometry config;
+  if (!config.LoadFile(path)) {
+    return false;
+  }
+
+  // Shift the config from box coordinates into window coordinates
+  glm::dvec2 offset(container_.GetTopLeftCorner().x, container_.GetTopLeftCorner().y);
+  StaticGeometry static_geometry;
+  for (const Obstacle& obstacle : config.GetObstacles()) {
+    if (obstacle.shape == Obstacle::kCircle) {
+      static_geometry.AddCircle(obstacle.start + offset, obstacle.radius);
+    } else {
+      static_geometry.AddSegment(obstacle.start + offset, obstacle.end + offset);
     }
   }
+  for (Piston piston : config.GetPistons()) {
+    piston.start += offset;
+    piston.end += offset;
+    static_geometry.AddPiston(piston);
+  }
+  container_.SetStaticGeometry(static_geometry);
+  return true;
+}
+
+template <int D>
+bool BasicSimulation<D>::ExportStatistics(const std::string& path) {
+  statistics_writer_.reset(new StatisticsWriter(path, particle_configs_.size(), kSpeedTicks));
+  return statistics_writer_->IsGood();
+}
+
+template <int D>
+bool BasicSimulation<D>::RecordReplay(const std::string& path) {
+  if (step_count_ > 0 || edited_) {
+    return false;
+  }
+  replay_recorder_.reset(new BasicReplayRecorder<D>(path, container_));
+  return replay_recorder_->IsGood();
+}
+
+template <int D>
+bool BasicSimulation<D>::ServeMetrics(uint16_t port) {
+  return metrics_exporter_.StartTcp(port);
+}
+
+template <int D>
+bool BasicSimulation<D>::ServeMetrics(const std::string& socket_path) {
+  return metrics_exporter_.StartUnix(socket_path);
+}
+
+template <int D>
+const SimulationMetrics& BasicSimulation<D>::GetMetrics() const {
+  return metrics_;
+}
+
+template <int D>
+void BasicSimulation<D>::SetQuantizedSnapshots(bool enabled) {
+  quantized_snapshots_ = enabled;
+}
 
-  particles_ = std::move(initial_particles);
+template <int D>
+MemoryReport BasicSimulation<D>::GetMemoryReport() const {
+  MemoryReport report = container_.GetMemoryReport();
+  report.Add("snapshots", snapshot_publisher_.GetMemoryUsage());
+  report.Add("density field", density_field_.GetMemoryUsage());
+  return report;
 }
 
-void Simulation::InitializeHistograms() {
+template <int D>
+void BasicSimulation<D>::InitializeHistograms() {
   for (ParticleConfig& particle_config : particle_configs_) {
     histograms_.emplace_back(kSpeedTicks, kSpeedInterval, kFrequencyTicks, particle_config.color);
+    speed_distributions_.emplace_back(kSpeedTicks, kSpeedInterval);
+  }
+}
+
+template <int D>
+void BasicSimulation<D>::UpdateHistogram() {
+  speed_analytics_.Update(container_.GetParticles(), &thread_pool_);
+  for (size_t type = 0; type < histograms_.size(); type++) {
+    double speed_interval = speed_analytics_.GetAdaptiveSpeedInterval(type, kSpeedTicks);
+    if (kAdaptiveSpeedInterval && speed_interval > 0) {
+      histograms_[type].SetSpeedInterval(speed_interval);
+    }
+    // Cleared in place, keeping the bin buffer of the last step
+    speed_distributions_[type].SetSpeedInterval(
+            histograms_[type].GetDistribution().GetSpeedInterval());
+    speed_distributions_[type].Reset();
+  }
+
+  CountSpeeds(container_.GetParticles(), speed_distributions_, &thread_pool_);
+  for (size_t type = 0; type < histograms_.size(); type++) {
+    histograms_[type].SetDistribution(speed_distributions_[type]);
+  }
+}
+
+template <int D>
+void BasicSimulation<D>::PublishSnapshot() {
+  SimulationSnapshot* snapshot = snapshot_publisher_.BeginPublish();
+  if (snapshot == nullptr) {
+    return;
+  }
+
+  // Buffers are reused, so after the first few steps these only copy
+  const std::vector<Particle>& particles = container_.GetParticles();
+  snapshot->step = step_count_;
+  snapshot->velocities.resize(particles.size());
+  // 3D snapshots hold the x and y components, as drawn
+  for (size_t i = 0; i < particles.size(); i++) {
+    const typename Particle::Vec& velocity = particles[i].GetVelocity();
+    snapshot->velocities[i] = idealgas::Particle::Vec(velocity.x, velocity.y);
+  }
+  if (quantized_snapshots_) {
+    // Positions are clamped to the box, which Particles only leave by a fraction of a radius
+    glm::dvec2 origin(container_.GetTopLeftCorner().x, container_.GetTopLeftCorner().y);
+    glm::dvec2 extent(container_.GetBoxWidth(), container_.GetBoxHeight());
+    snapshot->positions.clear();
+    snapshot->quantized_positions.resize(particles.size());
+    snapshot->quantization_origin = origin;
+    snapshot->quantization_step = extent / SimulationSnapshot::kQuantizationSteps;
+    for (size_t i = 0; i < particles.size(); i++) {
+      for (int axis = 0; axis < 2; axis++) {
+        double fraction = (particles[i].GetPosition()[axis] - origin[axis]) / extent[axis];
+        fraction = std::min(std::max(fraction, 0.0), 1.0);
+        snapshot->quantized_positions[i][axis] =
+                uint16_t(std::lround(fraction * SimulationSnapshot::kQuantizationSteps));
+      }
+    }
+  } else {
+    snapshot->quantized_positions.clear();
+    snapshot->positions.resize(particles.size());
+    for (size_t i = 0; i < particles.size(); i++) {
+      const typename Particle::Vec& position = particles[i].GetPosition();
+      snapshot->positions[i] = idealgas::Particle::Vec(position.x, position.y);
+    }
+  }
+  snapshot->speed_frequencies.resize(histograms_.size());
+  for (size_t i = 0; i < histograms_.size(); i++) {
+    snapshot->speed_frequencies[i] = histograms_[i].GetDistribution().GetFrequencies();
+  }
+
+  snapshot_publisher_.EndPublish();
+}
+
+template <int D>
+std::chrono::steady_clock::time_point BasicSimulation<D>::EndPhase(
+        Phase phase, std::chrono::steady_clock::time_point start) {
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  metrics_.AddPhaseTime(phase, end - start);
+  return end;
+}
+
+template <int D>
+void BasicSimulation<D>::UpdateMetrics() {
+  // The analytics already hold each type's temperature kT, a D / 2 share of its mean
+  // kinetic energy, so the total energy costs nothing extra per step
+  double kinetic_energy = 0;
+  for (size_t type = 0; type < particle_configs_.size(); type++) {
+    const SpeciesFit& fit = speed_analytics_.GetFit(type);
+    metrics_.SetTemperature(type, fit.temperature);
+    kinetic_energy += D * fit.temperature * fit.count / 2;
   }
+  metrics_.SetKineticEnergy(kinetic_energy);
+  metrics_.SetParticleMemory(container_.GetParticles().capacity() * sizeof(Particle));
+  metrics_.RecordStep(step_count_, container_.GetCollisionCounts());
 }
 
-void Simulation::ProcessParticleMovement() {
-  for (Particle& particle : particles_) {
-    particle.ProcessMovement();
+template <int D>
+void BasicSimulation<D>::RecordStatistics() {
+  if (statistics_writer_ == nullptr) {
+    return;
   }
+
+  const CollisionCounts& collision_counts = container_.GetCollisionCounts();
+  step_statistics_.step = step_count_;
+  step_statistics_.particle_collisions = collision_counts.particle_collisions;
+  step_statistics_.wall_bounces = collision_counts.wall_bounces;
+  step_statistics_.obstacle_bounces = collision_counts.obstacle_bounces;
+  step_statistics_.kinetic_energy = 0;
+  step_statistics_.temperatures.resize(histograms_.size());
+  step_statistics_.speed_intervals.resize(histograms_.size());
+  step_statistics_.speed_frequencies.resize(histograms_.size());
+  for (size_t type = 0; type < histograms_.size(); type++) {
+    const SpeciesFit& fit = speed_analytics_.GetFit(type);
+    const SpeedDistribution& distribution = histograms_[type].GetDistribution();
+    step_statistics_.kinetic_energy += D * fit.temperature * fit.count / 2;
+    step_statistics_.temperatures[type] = fit.temperature;
+    step_statistics_.speed_intervals[type] = distribution.GetSpeedInterval();
+    step_statistics_.speed_frequencies[type] = distribution.GetFrequencies();
+  }
+  statistics_writer_->Append(step_statistics_);
 }
 
-void Simulation::ProcessParticleCollision() {
-  for (size_t i = 0; i < particles_.size(); i++) {
-    particles_[i].ProcessXWallCollision(top_left_corner_.x);
-    particles_[i].ProcessXWallCollision(top_left_corner_.x + box_width_);
-    particles_[i].ProcessYWallCollision(top_left_corner_.y);
-    particles_[i].ProcessYWallCollision(top_left_corner_.y + box_height_);
+template <int D>
+bool BasicSimulation<D>::ApplyEdit(const BasicReplayEdit<D>& edit) {
+  // Applied and recorded as ReplayLog::Verify replays them
+  if (!edit.Apply(container_)) {
+    return false;
+  }
+  edited_ = true;
+  if (replay_recorder_) {
+    replay_recorder_->RecordEdit(edit);
+  }
+  return true;
+}
+
+template <int D>
+glm::vec<D, float> BasicSimulation<D>::GetContainerCorner(const glm::vec2& top_left_corner) {
+  glm::vec<D, float> corner(0);
+  corner[0] = top_left_corner.x;
+  corner[1] = top_left_corner.y;
+  return corner;
+}
 
-    for (size_t j = i + 1; j < particles_.size(); j++) {
-     if (CheckCollision(particles_[i], particles_[j])) {
-       CollideParticles(particles_[i], particles_[j]);
-     }
+template <int D>
+glm::vec<D, double> BasicSimulation<D>::GetContainerSize(double box_width, double box_height) {
+  glm::vec<D, double> box_size(box_height);
+  box_size[0] = box_width;
+  return box_size;
+}
+
+template <int D>
+void BasicSimulation<D>::DrawParticles() const {
+  const std::vector<Particle>& particles = container_.GetParticles();
+  if constexpr (D == 2) {
+    for (const Particle& particle : particles) {
+      ci::gl::color(particle_configs_[particle.GetType()].color);
+      ci::gl::drawSolidCircle(vec2(particle.GetPosition()), float(particle.GetRadius()));
+    }
+  } else {
+    // Farthest first, so nearer Particles are drawn over them
+    std::vector<size_t> draw_order(particles.size());
+    for (size_t i = 0; i < particles.size(); i++) {
+      draw_order[i] = i;
+    }
+    std::sort(draw_order.begin(), draw_order.end(), [&](size_t a, size_t b) {
+      return particles[a].GetPosition().z > particles[b].GetPosition().z;
+    });
+
+    double near = container_.GetTopLeftCorner().z;
+    double depth = std::max(container_.GetBoxSize().z, 1.0);
+    for (size_t i : draw_order) {
+      const Particle& particle = particles[i];
+      double distance = glm::clamp((particle.GetPosition().z - near) / depth, 0.0, 1.0);
+      float brightness = 1 - (1 - kFarBrightness) * float(distance);
+      ci::gl::color(particle_configs_[particle.GetType()].color * brightness);
+      ci::gl::drawSolidCircle(vec2(particle.GetPosition().x, particle.GetPosition().y),
+                              float(particle.GetRadius()));
     }
   }
 }
 
-void Simulation::UpdateHistogram() {
-  for (Histogram& histogram : histograms_) {
-    histogram.ResetCount();
+template <int D>
+void BasicSimulation<D>::DrawStaticGeometry() const {
+  const StaticGeometry& static_geometry = container_.GetStaticGeometry();
+  ci::gl::color(ci::Color("gray"));
+  for (const Obstacle& obstacle : static_geometry.GetObstacles()) {
+    if (obstacle.shape == Obstacle::kCircle) {
+      ci::gl::drawSolidCircle(vec2(obstacle.start), float(obstacle.radius));
+    } else {
+      ci::gl::drawLine(vec2(obstacle.start), vec2(obstacle.end));
+    }
   }
 
-  for (const Particle& particle : particles_) {
-    histograms_[particle.GetType()].CountParticle(particle);
+  ci::gl::color(ci::Color("white"));
+  for (const Piston& piston : static_geometry.GetPistons()) {
+    ci::gl::drawLine(vec2(piston.start), vec2(piston.end));
   }
 }
 
-inline double Simulation::GenerateRandomDouble(double min, double max) {
-  // Code below derived from:
-  // https://blog.gtwang.org/programming/c-cpp-rand-random-number-generation-tutorial-examples/
-  return (max - min) * rand() / (RAND_MAX + 1.0) + min;
+template <int D>
+bool BasicSimulation<D>::UsesDensityField() const {
+  return container_.GetParticles().size() > kDensityFieldThreshold;
+}
+
+template <int D>
+void BasicSimulation<D>::BuildDensityField() {
+  vec2 top_left_corner(container_.GetTopLeftCorner().x, container_.GetTopLeftCorner().y);
+  density_field_.Build(container_.GetParticles(), top_left_corner,
+                       container_.GetBoxWidth(), container_.GetBoxHeight(), thread_pool_);
+}
+
+template <int D>
+void BasicSimulation<D>::DrawDensityField(const ci::Rectf& gas_box) const {
+  // Square root brightness keeps sparse cells visible next to dense ones
+  float max_count = float(std::max<size_t>(1, density_field_.GetMaxCount()));
+  double mean_temperature = density_field_.GetMeanTemperature();
+  for (size_t row = 0; row < density_field_.GetRows(); row++) {
+    for (size_t column = 0; column < density_field_.GetColumns(); column++) {
+      size_t count = density_field_.GetCount(column, row);
+      ci::Color cell_color(0, 0, 0);
+      if (count > 0) {
+        for (size_t type = 0; type < density_field_.GetTypeCount(); type++) {
+          cell_color += particle_configs_[type].color *
+                        float(density_field_.GetTypeCount(column, row, type));
+        }
+        cell_color = cell_color / float(count);
+
+        // Heat is 1/2 at the mean temperature, approaching 1 in the hottest cells
+        double temperature = density_field_.GetTemperature(column, row);
+        float heat = mean_temperature > 0
+                     ? float(temperature / (temperature + mean_temperature)) : 0.5f;
+        cell_color += (ci::Color(1, 1, 1) - cell_color) * (kHeatWhitening * heat);
+        cell_color = cell_color * std::sqrt(count / max_count);
+      }
+      density_surface_.setPixel(glm::ivec2(column, row), ci::Color8u(cell_color));
+    }
+  }
+
+  if (density_texture_) {
+    density_texture_->update(density_surface_);
+  } else {
+    density_texture_ = ci::gl::Texture2d::create(density_surface_);
+  }
+  ci::gl::color(ci::Color("white"));
+  ci::gl::draw(density_texture_, gas_box);
 }
+
+template class BasicSimulation<2>;
+template class BasicSimulation<3>;
 }  // namespace visualizer
 
 }  // namespace idealgas
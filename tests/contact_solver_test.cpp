@@ -0,0 +1,74 @@
+#include <core/contact_solver.h>
+#include <core/gas_container.h>
+#include <core/observables.h>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Contact solver", "[collision][dense]") {
+  SECTION("Single contact matches the pairwise collision") {
+    std::vector<idealgas::Particle> particles;
+    particles.emplace_back(0, glm::vec2(1, 2), glm::vec2(3, 4), 10, 2);
+    particles.emplace_back(0, glm::vec2(5, 6), glm::vec2(-1, -1), 10, 8);
+    idealgas::Particle pairwise_a = particles[0];
+    idealgas::Particle pairwise_b = particles[1];
+    idealgas::CollideParticles(pairwise_a, pairwise_b);
+
+    idealgas::ContactSolver solver;
+    solver.Solve(particles, {{0, 1}});
+    // Same velocities as the mass test in particle_test.cpp: [-4.2, -3.2] and [0.8, 0.8]
+    REQUIRE(particles[0].GetVelocity().x == Approx(pairwise_a.GetVelocity().x));
+    REQUIRE(particles[0].GetVelocity().y == Approx(pairwise_a.GetVelocity().y));
+    REQUIRE(particles[1].GetVelocity().x == Approx(pairwise_b.GetVelocity().x));
+    REQUIRE(particles[1].GetVelocity().y == Approx(pairwise_b.GetVelocity().y));
+    REQUIRE(solver.GetStats().contact_count == 1);
+  }
+
+  SECTION("Pairs out of reach are ignored") {
+    std::vector<idealgas::Particle> particles;
+    particles.emplace_back(0, glm::vec2(0, 0), glm::vec2(1, 0), 1, 1);
+    particles.emplace_back(0, glm::vec2(5, 0), glm::vec2(-1, 0), 1, 1);
+    idealgas::ContactSolver solver;
+    solver.Solve(particles, {{0, 1}});
+    REQUIRE(solver.GetStats().contact_count == 0);
+    REQUIRE(particles[0].GetVelocity().x == 1);
+  }
+
+  SECTION("Overlapping cluster converges within the iteration caps") {
+    // A row of three overlapping particles pressed together from both ends
+    std::vector<idealgas::Particle> particles;
+    particles.emplace_back(0, glm::vec2(0, 0), glm::vec2(2, 0), 10, 1);
+    particles.emplace_back(0, glm::vec2(15, 0), glm::vec2(0, 0), 10, 1);
+    particles.emplace_back(0, glm::vec2(30, 0), glm::vec2(-2, 0), 10, 1);
+    glm::vec2 momentum = idealgas::ComputeMomentum(particles);
+
+    idealgas::ContactSolverSettings settings;
+    idealgas::ContactSolver solver(settings);
+    solver.Solve(particles, {{0, 1}, {0, 2}, {1, 2}});
+    const idealgas::ContactSolverStats& stats = solver.GetStats();
+
+    REQUIRE(stats.contact_count == 2);
+    REQUIRE(stats.velocity_iterations <= settings.max_velocity_iterations);
+    REQUIRE(stats.position_iterations <= settings.max_position_iterations);
+    REQUIRE(stats.velocity_residual <= settings.velocity_tolerance);
+    REQUIRE(idealgas::ComputeMomentum(particles).x == Approx(momentum.x).margin(1e-5));
+
+    // The ends now move apart and no longer overlap their middle neighbour
+    REQUIRE(particles[0].GetVelocity().x < 0);
+    REQUIRE(particles[2].GetVelocity().x > 0);
+    REQUIRE(glm::distance(particles[0].GetPosition(), particles[1].GetPosition()) ==
+            Approx(20).margin(0.1));
+  }
+}
+
+TEST_CASE("Dense gas mode", "[collision][dense]") {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 20, 100, 100)};
+  idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 300, 300, 3);
+  container.SetDenseGasMode(true);
+
+  for (size_t step = 0; step < 50; step++) {
+    container.Update();
+  }
+  REQUIRE(container.GetContactSolverStats().contact_count > 0);
+  REQUIRE(container.GetContactSolverStats().velocity_iterations > 0);
+}
@@ -0,0 +1,78 @@
+#include <core/density_field.h>
+#include <core/gas_container.h>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Density field binning", "[density-field]") {
+  idealgas::ThreadPool thread_pool(2);
+
+  SECTION("Particles are counted in the cell holding their center") {
+    std::vector<idealgas::Particle> particles;
+    particles.emplace_back(0, glm::vec2(105, 105), glm::vec2(3, 4), 1, 2);
+    particles.emplace_back(1, glm::vec2(108, 108), glm::vec2(1, 0), 1, 4);
+    particles.emplace_back(1, glm::vec2(195, 150), glm::vec2(0, 0), 1, 4);
+
+    // 100x100 box at (100, 100) split into 10x10 cells
+    idealgas::DensityField density_field(10, 10, 2);
+    density_field.Build(particles, glm::vec2(100, 100), 100, 100, thread_pool);
+
+    REQUIRE(density_field.GetCount(0, 0) == 2);
+    REQUIRE(density_field.GetTypeCount(0, 0, 0) == 1);
+    REQUIRE(density_field.GetTypeCount(0, 0, 1) == 1);
+    REQUIRE(density_field.GetCount(9, 5) == 1);
+    REQUIRE(density_field.GetMaxCount() == 2);
+    // (0.5 * 2 * 25 + 0.5 * 4 * 1) / 2 = 13.5
+    REQUIRE(density_field.GetTemperature(0, 0) == Approx(13.5));
+    REQUIRE(density_field.GetTemperature(5, 5) == 0);
+    // (2 * 25 / 2 + 4 * 1 / 2 + 0) / 3 = 9
+    REQUIRE(density_field.GetMeanTemperature() == Approx(9));
+  }
+
+  SECTION("Rebuilding keeps the grids and starts from empty cells") {
+    std::vector<idealgas::ParticleConfig> particle_configs {
+            idealgas::ParticleConfig(0, "red", 1, 1, 20000)};
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 300, 300, 5);
+    idealgas::ThreadPool parallel_pool(4);
+    idealgas::DensityField density_field(50, 50, 1);
+    density_field.Build(container.GetParticles(), glm::vec2(0, 0), 300, 300, parallel_pool);
+    size_t memory_usage = density_field.GetMemoryUsage();
+
+    std::vector<idealgas::Particle> particles;
+    particles.emplace_back(0, glm::vec2(1, 1), glm::vec2(0, 0), 1, 1);
+    density_field.Build(container.GetParticles(), glm::vec2(0, 0), 300, 300, parallel_pool);
+    density_field.Build(particles, glm::vec2(0, 0), 300, 300, parallel_pool);
+    REQUIRE(density_field.GetMaxCount() == 1);
+    REQUIRE(density_field.GetCount(0, 0) == 1);
+    REQUIRE(density_field.GetMemoryUsage() == memory_usage);
+  }
+
+  SECTION("Particles outside the box are clamped to the edge") {
+    std::vector<idealgas::Particle> particles;
+    particles.emplace_back(0, glm::vec2(-50, 250), glm::vec2(0, 0), 1, 1);
+    idealgas::DensityField density_field(4, 4, 1);
+    density_field.Build(particles, glm::vec2(0, 0), 100, 100, thread_pool);
+    REQUIRE(density_field.GetCount(0, 3) == 1);
+  }
+
+  SECTION("Parallel binning matches serial binning") {
+    std::vector<idealgas::ParticleConfig> particle_configs {
+            idealgas::ParticleConfig(0, "red", 1, 1, 20000),
+            idealgas::ParticleConfig(1, "blue", 1, 1, 10000)};
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 300, 300, 5);
+    idealgas::ThreadPool serial_pool(1);
+    idealgas::ThreadPool parallel_pool(4);
+    idealgas::DensityField serial(150, 150, 2);
+    idealgas::DensityField parallel(150, 150, 2);
+    serial.Build(container.GetParticles(), glm::vec2(0, 0), 300, 300, serial_pool);
+    parallel.Build(container.GetParticles(), glm::vec2(0, 0), 300, 300, parallel_pool);
+
+    size_t total = 0;
+    for (size_t row = 0; row < 150; row++) {
+      for (size_t column = 0; column < 150; column++) {
+        REQUIRE(serial.GetTypeCount(column, row, 1) == parallel.GetTypeCount(column, row, 1));
+        total += parallel.GetCount(column, row);
+      }
+    }
+    REQUIRE(total == 30000);
+  }
+}
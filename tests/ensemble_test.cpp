@@ -0,0 +1,112 @@
+#include <core/ensemble.h>
+
+#include <algorithm>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+std::vector<idealgas::ParticleConfig> MakeConfigs() {
+  return {idealgas::ParticleConfig(0, "red", 20, 100, 20),
+          idealgas::ParticleConfig(1, "blue", 10, 50, 10)};
+}
+
+}  // namespace
+
+TEST_CASE("Thread pool covers every index once", "[thread-pool]") {
+  idealgas::ThreadPool thread_pool(4);
+  std::vector<int> visits(1000, 0);
+
+  SECTION("Chunks larger than one index") {
+    thread_pool.ParallelFor(0, visits.size(), 7, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        visits[i]++;
+      }
+    });
+    REQUIRE(std::count(visits.begin(), visits.end(), 1) == 1000);
+  }
+
+  SECTION("Empty range does nothing") {
+    thread_pool.ParallelFor(5, 5, 1, [&](size_t begin, size_t) {
+      visits[begin]++;
+    });
+    REQUIRE(std::count(visits.begin(), visits.end(), 0) == 1000);
+  }
+}
+
+TEST_CASE("Speed distribution merge", "[histogram]") {
+  idealgas::SpeedDistribution distribution_a(4, 0.5);
+  idealgas::SpeedDistribution distribution_b(4, 0.5);
+
+  // Speeds 0.3, 1.0 and 5.0 fall into bins 0, 1 and the last bin
+  distribution_a.CountParticle(idealgas::Particle(0, glm::vec2(0, 0), glm::vec2(0.3, 0), 1, 1));
+  distribution_b.CountParticle(idealgas::Particle(0, glm::vec2(0, 0), glm::vec2(0, 1), 1, 1));
+  distribution_b.CountParticle(idealgas::Particle(0, glm::vec2(0, 0), glm::vec2(3, 4), 1, 1));
+  distribution_a.Merge(distribution_b);
+
+  REQUIRE(distribution_a.GetFrequencies() == std::vector<size_t>({1, 1, 0, 1}));
+  REQUIRE(distribution_a.GetTotalFrequency() == 3);
+}
+
+TEST_CASE("Ensemble of replicas", "[ensemble]") {
+  SECTION("Replicas are seeded independently") {
+    idealgas::Ensemble ensemble(MakeConfigs(), 600, 600, 3, 1, 2);
+    REQUIRE(ensemble.GetReplicaCount() == 3);
+    REQUIRE(ensemble.GetReplicaParticles(0).size() == 30);
+    REQUIRE(ensemble.GetReplicaParticles(0)[0].GetPosition() !=
+            ensemble.GetReplicaParticles(1)[0].GetPosition());
+  }
+
+  SECTION("Replicas step as separate containers with their seeds") {
+    // The second set is above the tiled kernel threshold, so scratch neighbour lists switch too
+    std::vector<std::vector<idealgas::ParticleConfig>> config_sets {
+            MakeConfigs(),
+            {idealgas::ParticleConfig(0, "red", 4, 10, 700),
+             idealgas::ParticleConfig(1, "blue", 2, 5, 300)}};
+    for (const std::vector<idealgas::ParticleConfig>& configs : config_sets) {
+      idealgas::Ensemble ensemble(configs, 600, 600, 6, 3, 2);
+      ensemble.Update(20);
+      ensemble.Update(20);
+
+      for (size_t replica = 0; replica < 6; replica++) {
+        idealgas::GasContainer container(configs, glm::vec2(0, 0), 600, 600,
+                                         3 + (unsigned int) replica);
+        for (size_t step = 0; step < 40; step++) {
+          container.Update();
+        }
+        idealgas::ParticleSpan<const idealgas::Particle> particles =
+                ensemble.GetReplicaParticles(replica);
+        REQUIRE(particles.size() == container.GetParticles().size());
+        for (size_t i = 0; i < particles.size(); i++) {
+          REQUIRE(particles[i].GetPosition() == container.GetParticles()[i].GetPosition());
+          REQUIRE(particles[i].GetVelocity() == container.GetParticles()[i].GetVelocity());
+        }
+      }
+    }
+  }
+
+  SECTION("Result does not depend on the thread count") {
+    idealgas::Ensemble serial(MakeConfigs(), 600, 600, 8, 42, 1);
+    idealgas::Ensemble parallel(MakeConfigs(), 600, 600, 8, 42, 4);
+    serial.Update(50);
+    parallel.Update(50);
+
+    idealgas::EnsembleObservables serial_observables = serial.Aggregate(8, 0.5);
+    idealgas::EnsembleObservables parallel_observables = parallel.Aggregate(8, 0.5);
+    REQUIRE(serial_observables.mean_kinetic_energy == parallel_observables.mean_kinetic_energy);
+    for (size_t type = 0; type < 2; type++) {
+      REQUIRE(serial_observables.speed_distributions[type].GetFrequencies() ==
+              parallel_observables.speed_distributions[type].GetFrequencies());
+    }
+  }
+
+  SECTION("Merged histograms count every particle of every replica") {
+    idealgas::Ensemble ensemble(MakeConfigs(), 600, 600, 5, 7, 2);
+    ensemble.Update(10);
+    idealgas::EnsembleObservables observables = ensemble.Aggregate(8, 0.5);
+    REQUIRE(observables.speed_distributions[0].GetTotalFrequency() == 100);
+    REQUIRE(observables.speed_distributions[1].GetTotalFrequency() == 50);
+    REQUIRE(observables.kinetic_energy_standard_error > 0);
+    REQUIRE(ensemble.GetReplicaStepsPerSecond() > 0);
+  }
+}
@@ -0,0 +1,180 @@
+#include <core/gas_container.h>
+#include <core/speed_distribution.h>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Parallel per-particle passes", "[gas-container]") {
+  // Enough Particles that the passes are split over the pool
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 2, 100, 15000),
+          idealgas::ParticleConfig(1, "blue", 1, 50, 15000)};
+  idealgas::ThreadPool thread_pool(4);
+
+  SECTION("Trajectories do not depend on the thread count") {
+    idealgas::GasContainer serial(particle_configs, glm::vec2(0, 0), 1500, 1500, 3);
+    idealgas::GasContainer parallel(particle_configs, glm::vec2(0, 0), 1500, 1500, 3);
+    parallel.SetThreadPool(&thread_pool);
+    for (size_t step = 0; step < 20; step++) {
+      serial.Update();
+      parallel.Update();
+    }
+
+    const std::vector<idealgas::Particle>& serial_particles = serial.GetParticles();
+    const std::vector<idealgas::Particle>& parallel_particles = parallel.GetParticles();
+    for (size_t i = 0; i < serial_particles.size(); i++) {
+      REQUIRE(parallel_particles[i].GetPosition() == serial_particles[i].GetPosition());
+      REQUIRE(parallel_particles[i].GetVelocity() == serial_particles[i].GetVelocity());
+    }
+    REQUIRE(parallel.GetCollisionCounts().wall_bounces ==
+            serial.GetCollisionCounts().wall_bounces);
+    REQUIRE(parallel.GetCollisionCounts().particle_collisions ==
+            serial.GetCollisionCounts().particle_collisions);
+    REQUIRE(serial.GetCollisionCounts().wall_bounces > 0);
+  }
+
+  SECTION("Partial speed counts merge to the serial counts") {
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 1500, 1500, 3);
+    std::vector<idealgas::SpeedDistribution> serial(2, idealgas::SpeedDistribution(8, 0.05));
+    std::vector<idealgas::SpeedDistribution> parallel = serial;
+
+    idealgas::CountSpeeds(container.GetParticles(), serial, nullptr);
+    idealgas::CountSpeeds(container.GetParticles(), parallel, &thread_pool);
+    for (size_t type = 0; type < 2; type++) {
+      REQUIRE(parallel[type].GetFrequencies() == serial[type].GetFrequencies());
+      REQUIRE(parallel[type].GetTotalFrequency() == 15000);
+    }
+  }
+}
+
+TEST_CASE("Parallel initialisation", "[gas-container]") {
+  // Several blocks of Particles, with a type boundary inside a block
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 2, 100, 100000),
+          idealgas::ParticleConfig(1, "blue", 1, 50, 0),
+          idealgas::ParticleConfig(2, "green", 1, 50, 60000)};
+  idealgas::ThreadPool thread_pool(4);
+  idealgas::GasContainer serial(particle_configs, glm::vec2(10, 20), 1000, 500, 3);
+  idealgas::GasContainer parallel(particle_configs, glm::vec2(10, 20), 1000, 500, 3,
+                                  &thread_pool);
+
+  const std::vector<idealgas::Particle>& serial_particles = serial.GetParticles();
+  const std::vector<idealgas::Particle>& parallel_particles = parallel.GetParticles();
+  REQUIRE(serial_particles.size() == 160000);
+  REQUIRE(serial_particles.capacity() == 160000);
+  for (size_t i = 0; i < serial_particles.size(); i++) {
+    REQUIRE(parallel_particles[i].GetPosition() == serial_particles[i].GetPosition());
+    REQUIRE(parallel_particles[i].GetVelocity() == serial_particles[i].GetVelocity());
+    REQUIRE(serial_particles[i].GetType() == (i < 100000 ? 0 : 2));
+    REQUIRE(serial_particles[i].GetPosition().x >= 10);
+    REQUIRE(serial_particles[i].GetPosition().x <= 1010);
+    REQUIRE(serial_particles[i].GetPosition().y >= 20);
+    REQUIRE(serial_particles[i].GetPosition().y <= 520);
+  }
+
+  // Blocks draw from different generators
+  REQUIRE(serial_particles[0].GetPosition() != serial_particles[65536].GetPosition());
+}
+
+TEST_CASE("Grain sizes split arrays on whole cache lines", "[gas-container]") {
+  idealgas::ThreadPool thread_pool(4);
+  REQUIRE(thread_pool.GetGrainSize(100000, 64) % 64 == 0);
+  // 16 chunks of 6250 rounded up to 6272
+  REQUIRE(thread_pool.GetGrainSize(100000, 64) == 6272);
+  REQUIRE(thread_pool.GetGrainSize(10, 64) == 64);
+}
+
+TEST_CASE("Runtime changes between steps", "[gas-container]") {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 4, 100, 200),
+          idealgas::ParticleConfig(1, "blue", 2, 50, 200)};
+  idealgas::GasContainer brute_force(particle_configs, glm::vec2(0, 0), 400, 400, 7);
+  idealgas::GasContainer neighbor_listed(particle_configs, glm::vec2(0, 0), 400, 400, 7);
+  brute_force.SetNeighborSkin(0);
+  neighbor_listed.SetNeighborSkin(8);
+  neighbor_listed.SetTiledKernelThreshold(0);
+  auto apply = [](idealgas::GasContainer& container, size_t step) {
+    if (step == 10) {
+      container.AddParticles(idealgas::ParticleConfig(2, "green", 6, 500, 50));
+    } else if (step == 20) {
+      container.RemoveParticles(0, 120);
+    } else if (step == 30) {
+      container.ScaleVelocities(1.5);
+    } else if (step == 40) {
+      container.ResizeBox(glm::dvec2(300, 350));
+    }
+  };
+
+  SECTION("Collisions match the brute force loop through every change") {
+    for (size_t step = 0; step < 60; step++) {
+      apply(brute_force, step);
+      apply(neighbor_listed, step);
+      brute_force.Update();
+      neighbor_listed.Update();
+    }
+
+    // The list resolves exactly the pairs of the brute force loop
+    REQUIRE(neighbor_listed.GetParticles().size() == 330);
+    for (size_t i = 0; i < brute_force.GetParticles().size(); i++) {
+      REQUIRE(brute_force.GetParticles()[i].GetPosition() ==
+              neighbor_listed.GetParticles()[i].GetPosition());
+      REQUIRE(brute_force.GetParticles()[i].GetVelocity() ==
+              neighbor_listed.GetParticles()[i].GetVelocity());
+    }
+    REQUIRE(neighbor_listed.GetNeighborListStats().incremental_updates == 2);
+  }
+
+  SECTION("Removal takes the last Particles of the type") {
+    std::vector<idealgas::Particle> before = neighbor_listed.GetParticles();
+    REQUIRE(neighbor_listed.RemoveParticles(1, 150) == 150);
+    REQUIRE(neighbor_listed.RemoveParticles(3, 10) == 0);
+    REQUIRE(neighbor_listed.GetParticles().size() == 250);
+    for (size_t i = 0; i < 250; i++) {
+      REQUIRE(neighbor_listed.GetParticles()[i].GetPosition() == before[i].GetPosition());
+    }
+  }
+
+  SECTION("Types past the 8-bit limit are not added") {
+    size_t max_type = idealgas::Particle::kMaxTypeCount - 1;
+    REQUIRE(neighbor_listed.AddParticles(idealgas::ParticleConfig(max_type, "green", 2, 1, 5)));
+    REQUIRE(neighbor_listed.GetParticles().back().GetType() == max_type);
+    REQUIRE_FALSE(neighbor_listed.AddParticles(
+            idealgas::ParticleConfig(max_type + 1, "green", 2, 1, 5)));
+    REQUIRE(neighbor_listed.GetParticles().size() == 405);
+
+    // Nor constructed with, asserts or not
+    std::vector<idealgas::ParticleConfig> particle_configs {
+            idealgas::ParticleConfig(0, "red", 2, 1, 5),
+            idealgas::ParticleConfig(max_type + 1, "green", 2, 1, 5)};
+    REQUIRE_THROWS_AS(idealgas::GasContainer(particle_configs, glm::vec2(0), 100, 100, 1),
+                      std::invalid_argument);
+  }
+
+  SECTION("A box narrower than the largest Particle is refused") {
+    REQUIRE_FALSE(neighbor_listed.ResizeBox(glm::dvec2(400, 7)));
+    REQUIRE_FALSE(neighbor_listed.ResizeBox(glm::dvec2(0, 400)));
+    REQUIRE(neighbor_listed.GetBoxHeight() == 400);
+
+    // Particles are pushed back in until they touch the new walls at most
+    REQUIRE(neighbor_listed.ResizeBox(glm::dvec2(400, 8)));
+    for (const idealgas::Particle& particle : neighbor_listed.GetParticles()) {
+      REQUIRE(particle.GetPosition().y >= particle.GetRadius());
+      REQUIRE(particle.GetPosition().y <= 8 - particle.GetRadius());
+    }
+  }
+
+  SECTION("Scaling velocities scales the kinetic energy by the square") {
+    double energy = neighbor_listed.GetKineticEnergy();
+    neighbor_listed.ScaleVelocities(0.5);
+    REQUIRE(neighbor_listed.GetKineticEnergy() == Approx(energy / 4));
+  }
+
+  SECTION("Shrinking the box pushes Particles inside the new walls") {
+    neighbor_listed.ResizeBox(glm::dvec2(100, 200));
+    REQUIRE(neighbor_listed.GetBoxWidth() == 100);
+    for (const idealgas::Particle& particle : neighbor_listed.GetParticles()) {
+      REQUIRE(particle.GetPosition().x + particle.GetRadius() <= Approx(100));
+      REQUIRE(particle.GetPosition().y + particle.GetRadius() <= Approx(200));
+      REQUIRE(particle.GetPosition().x - particle.GetRadius() >= Approx(0));
+    }
+  }
+}
@@ -0,0 +1,103 @@
+#include <core/gas_container.h>
+#include <core/memory_report.h>
+#include <core/snapshot_publisher.h>
+
+#include <cmath>
+
+#include <catch2/catch.hpp>
+
+using idealgas::BasicGasContainer;
+using idealgas::MemoryReport;
+using idealgas::Particle;
+using idealgas::ParticleConfig;
+using idealgas::SimulationSnapshot;
+
+TEST_CASE("Memory report totals") {
+  MemoryReport report(100);
+  report.Add("particles", 2800);
+  report.Add("neighbor list", 1200);
+
+  SECTION("Total and bytes per particle") {
+    REQUIRE(report.GetTotalBytes() == 4000);
+    REQUIRE(report.GetBytesPerParticle(2800) == Approx(28));
+    REQUIRE(report.GetSubsystems().size() == 2);
+  }
+
+  SECTION("Adding another report keeps its subsystems") {
+    MemoryReport snapshots(100);
+    snapshots.Add("snapshots", 1000);
+    report.Add(snapshots);
+    REQUIRE(report.GetTotalBytes() == 5000);
+    REQUIRE(report.GetSubsystems().back().first == "snapshots");
+  }
+
+  SECTION("No bytes per particle without particles") {
+    MemoryReport empty(0);
+    empty.Add("particles", 64);
+    REQUIRE(empty.GetBytesPerParticle(64) == 0);
+  }
+
+  SECTION("Format lists every subsystem and the total") {
+    std::string table = report.Format();
+    REQUIRE(table.find("particles") != std::string::npos);
+    REQUIRE(table.find("neighbor list") != std::string::npos);
+    REQUIRE(table.find("4000") != std::string::npos);
+    REQUIRE(table.back() == '\n');
+  }
+}
+
+TEST_CASE("Gas container memory report") {
+  std::vector<ParticleConfig> particle_configs {
+          ParticleConfig(0, "red", 2, 100, 500),
+          ParticleConfig(1, "blue", 1, 50, 500)};
+  BasicGasContainer<2> container(particle_configs, glm::vec2(0), glm::dvec2(400), 3);
+  container.SetNeighborSkin(4);
+  container.SetTiledKernelThreshold(0);
+  container.Update();
+
+  MemoryReport report = container.GetMemoryReport();
+  REQUIRE(report.GetParticleCount() == 1000);
+
+  SECTION("Particles are counted at their allocated size") {
+    REQUIRE(report.GetSubsystems().front().first == "particles");
+    REQUIRE(report.GetSubsystems().front().second >= 1000 * sizeof(Particle));
+  }
+
+  SECTION("The neighbor list holds memory once built") {
+    for (const auto& subsystem : report.GetSubsystems()) {
+      if (subsystem.first == "neighbor list") {
+        REQUIRE(subsystem.second > 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("Particle type packing") {
+  Particle particle(255, Particle::Vec(1, 2), Particle::Vec(0), 3, 4);
+  REQUIRE(particle.GetType() == 255);
+  REQUIRE(particle.GetRadius() == Approx(3));
+  REQUIRE(particle.GetMass() == Approx(4));
+}
+
+TEST_CASE("Quantized snapshot positions") {
+  SimulationSnapshot snapshot;
+  snapshot.quantization_origin = glm::dvec2(10, 20);
+  snapshot.quantization_step = glm::dvec2(400, 300) / SimulationSnapshot::kQuantizationSteps;
+  snapshot.quantized_positions.push_back(glm::vec<2, uint16_t>(0, 65535));
+  snapshot.quantized_positions.push_back(glm::vec<2, uint16_t>(32768, 16384));
+
+  SECTION("Box corners decode exactly") {
+    REQUIRE(snapshot.GetPosition(0).x == Approx(10));
+    REQUIRE(snapshot.GetPosition(0).y == Approx(320));
+  }
+
+  SECTION("Positions decode within one step") {
+    REQUIRE(std::abs(snapshot.GetPosition(1).x - 210) <= snapshot.quantization_step.x);
+    REQUIRE(std::abs(snapshot.GetPosition(1).y - 95) <= snapshot.quantization_step.y);
+  }
+
+  SECTION("Unquantized positions are returned as published") {
+    snapshot.positions.push_back(Particle::Vec(5, 6));
+    REQUIRE(snapshot.GetPosition(0) == Particle::Vec(5, 6));
+  }
+}
@@ -0,0 +1,131 @@
+#include <core/metrics_exporter.h>
+
+#include <cstring>
+
+#include <catch2/catch.hpp>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * Sends a request over a connected socket and reads the response until the server closes it
+ */
+std::string Exchange(int client, const std::string& request) {
+  if (!request.empty()) {
+    send(client, request.data(), request.size(), 0);
+  }
+  std::string response;
+  char buffer[1024];
+  ssize_t received;
+  while ((received = recv(client, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, size_t(received));
+  }
+  close(client);
+  return response;
+}
+
+std::string ScrapeTcp(uint16_t port, const std::string& request) {
+  int client = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+  return Exchange(client, request);
+}
+
+std::string ScrapeUnix(const std::string& path) {
+  int client = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size());
+  REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+  return Exchange(client, "");
+}
+
+}  // namespace
+#endif
+
+TEST_CASE("Metrics exposition", "[metrics]") {
+  idealgas::SimulationMetrics metrics({"physics", "analytics"}, 2);
+  idealgas::CollisionCounts counts;
+  counts.particle_collisions = 12;
+  counts.wall_bounces = 34;
+  metrics.AddPhaseTime(0, std::chrono::milliseconds(1500));
+  metrics.RecordStep(1, counts);
+  metrics.RecordStep(2, counts);
+  metrics.SetKineticEnergy(250);
+  metrics.SetTemperature(1, 2.5);
+  metrics.SetParticleMemory(4096);
+  metrics.SetStartupTimes(std::chrono::milliseconds(120), std::chrono::milliseconds(40));
+
+  std::string exposition = metrics.FormatExposition();
+  REQUIRE(exposition.find("# TYPE idealgas_steps_total counter\nidealgas_steps_total 2\n") !=
+          std::string::npos);
+  REQUIRE(exposition.find("idealgas_phase_seconds_total{phase=\"physics\"} 1.5\n") !=
+          std::string::npos);
+  REQUIRE(exposition.find("idealgas_phase_seconds_total{phase=\"analytics\"} 0\n") !=
+          std::string::npos);
+  REQUIRE(exposition.find("idealgas_particle_collisions_total 12\n") != std::string::npos);
+  REQUIRE(exposition.find("idealgas_wall_bounces_total 34\n") != std::string::npos);
+  REQUIRE(exposition.find("idealgas_kinetic_energy 250\n") != std::string::npos);
+  REQUIRE(exposition.find("idealgas_temperature{type=\"0\"} 0\n") != std::string::npos);
+  REQUIRE(exposition.find("idealgas_temperature{type=\"1\"} 2.5\n") != std::string::npos);
+  REQUIRE(exposition.find("idealgas_particle_memory_bytes 4096\n") != std::string::npos);
+  REQUIRE(exposition.find("idealgas_startup_seconds{stage=\"construction\"} 0.12\n") !=
+          std::string::npos);
+  REQUIRE(exposition.find("idealgas_startup_seconds{stage=\"first_step\"} 0.04\n") !=
+          std::string::npos);
+  REQUIRE(exposition.find("idealgas_steps_per_second ") != std::string::npos);
+}
+
+#ifndef _WIN32
+TEST_CASE("Metrics exporter serves local clients", "[metrics]") {
+  idealgas::SimulationMetrics metrics({"physics"}, 1);
+  metrics.RecordStep(7, idealgas::CollisionCounts());
+  idealgas::MetricsExporter exporter(metrics);
+
+  SECTION("HTTP scrape over TCP") {
+    REQUIRE(exporter.StartTcp(0));
+    REQUIRE(exporter.GetPort() != 0);
+
+    std::string response = ScrapeTcp(exporter.GetPort(), "GET /metrics HTTP/1.1\r\n\r\n");
+    REQUIRE(response.find("HTTP/1.0 200 OK\r\n") == 0);
+    REQUIRE(response.find("text/plain; version=0.0.4") != std::string::npos);
+    REQUIRE(response.find("\r\n\r\n# HELP idealgas_steps_total") != std::string::npos);
+    REQUIRE(response.find("idealgas_steps_total 7\n") != std::string::npos);
+
+    REQUIRE(ScrapeTcp(exporter.GetPort(), "GET /other HTTP/1.1\r\n\r\n").find("404") !=
+            std::string::npos);
+  }
+
+  SECTION("Bare scrape over a Unix socket") {
+    std::string path = "metrics_test.sock";
+    REQUIRE(exporter.StartUnix(path));
+    std::string response = ScrapeUnix(path);
+    REQUIRE(response.find("# HELP idealgas_steps_total") == 0);
+    REQUIRE(response.find("idealgas_steps_total 7\n") != std::string::npos);
+
+    // Stopping removes the socket file
+    exporter.Stop();
+    REQUIRE_FALSE(exporter.IsRunning());
+    REQUIRE(access(path.c_str(), F_OK) != 0);
+  }
+
+  SECTION("Scrapes see the latest step") {
+    REQUIRE(exporter.StartTcp(0));
+    metrics.RecordStep(8, idealgas::CollisionCounts());
+    REQUIRE(ScrapeTcp(exporter.GetPort(), "GET / HTTP/1.0\r\n\r\n")
+                    .find("idealgas_steps_total 8\n") != std::string::npos);
+    REQUIRE(exporter.GetScrapeCount() == 1);
+  }
+}
+#endif
@@ -0,0 +1,221 @@
+#include <core/gas_container.h>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+std::vector<idealgas::ParticleConfig> MakeConfigs() {
+  return {idealgas::ParticleConfig(0, "red", 20, 100, 40),
+          idealgas::ParticleConfig(1, "blue", 10, 50, 40),
+          idealgas::ParticleConfig(2, "green", 2, 5, 40)};
+}
+
+}  // namespace
+
+TEST_CASE("Neighbor list contents", "[neighbor-list]") {
+  std::vector<idealgas::Particle> particles;
+  particles.emplace_back(0, glm::vec2(0, 0), glm::vec2(0, 0), 10, 1);
+  particles.emplace_back(0, glm::vec2(25, 0), glm::vec2(0, 0), 10, 1);
+  particles.emplace_back(0, glm::vec2(100, 0), glm::vec2(0, 0), 2, 1);
+  particles.emplace_back(0, glm::vec2(0, 21), glm::vec2(0, 0), 2, 1);
+
+  idealgas::NeighborList neighbor_list(6);
+  neighbor_list.Update(particles);
+
+  SECTION("Pairs within sum of radii plus skin are listed") {
+    // |0 - 1| = 25 <= 10 + 10 + 6, |0 - 3| = 21 <= 10 + 2 + 6 fails
+    REQUIRE(neighbor_list.NeighborsEnd(0) - neighbor_list.NeighborsBegin(0) == 1);
+    REQUIRE(*neighbor_list.NeighborsBegin(0) == 1);
+    REQUIRE(neighbor_list.NeighborsBegin(2) == neighbor_list.NeighborsEnd(2));
+  }
+
+  SECTION("Rebuilds only after moving more than half the skin") {
+    particles[2] = idealgas::Particle(0, glm::vec2(102.9, 0), glm::vec2(0, 0), 2, 1);
+    neighbor_list.Update(particles);
+    REQUIRE(neighbor_list.GetStats().rebuilds == 1);
+
+    particles[2] = idealgas::Particle(0, glm::vec2(103.1, 0), glm::vec2(0, 0), 2, 1);
+    neighbor_list.Update(particles);
+    REQUIRE(neighbor_list.GetStats().rebuilds == 2);
+    REQUIRE(neighbor_list.GetStats().updates == 3);
+  }
+}
+
+TEST_CASE("Neighbor list matches brute force", "[neighbor-list][collision]") {
+  idealgas::GasContainer brute_force(MakeConfigs(), glm::vec2(0, 0), 300, 300, 11);
+  idealgas::GasContainer neighbor_listed(MakeConfigs(), glm::vec2(0, 0), 300, 300, 11);
+  brute_force.SetNeighborSkin(0);
+  neighbor_listed.SetNeighborSkin(40);
+  neighbor_listed.SetTiledKernelThreshold(0);
+
+  for (size_t step = 0; step < 300; step++) {
+    brute_force.Update();
+    neighbor_listed.Update();
+  }
+
+  // Same pairs in the same order, so the trajectories are identical
+  for (size_t i = 0; i < brute_force.GetParticles().size(); i++) {
+    REQUIRE(brute_force.GetParticles()[i].GetPosition() ==
+            neighbor_listed.GetParticles()[i].GetPosition());
+    REQUIRE(brute_force.GetParticles()[i].GetVelocity() ==
+            neighbor_listed.GetParticles()[i].GetVelocity());
+  }
+  REQUIRE(neighbor_listed.GetNeighborListStats().updates == 300);
+  REQUIRE(neighbor_listed.GetNeighborListStats().rebuilds < 300);
+  REQUIRE(brute_force.GetNeighborListStats().updates == 0);
+}
+
+TEST_CASE("Multi-level grid with widely different radii", "[neighbor-list]") {
+  // Radii from 1 to 100 span 7 levels of doubling cells
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 1, 1, 400),
+          idealgas::ParticleConfig(1, "blue", 6, 10, 40),
+          idealgas::ParticleConfig(2, "green", 100, 1000, 4)};
+  idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 1000, 1000, 5);
+  const std::vector<idealgas::Particle>& particles = container.GetParticles();
+
+  idealgas::NeighborList multi_level(2);
+  idealgas::NeighborList uniform(2, 1);
+  multi_level.Build(particles);
+  uniform.Build(particles);
+  REQUIRE(multi_level.GetStats().level_count > 1);
+  REQUIRE(uniform.GetStats().level_count == 1);
+
+  SECTION("Every pair within reach is listed once, in ascending order") {
+    for (size_t i = 0; i < particles.size(); i++) {
+      std::vector<size_t> expected;
+      for (size_t j = i + 1; j < particles.size(); j++) {
+        glm::dvec2 displacement = glm::dvec2(particles[i].GetPosition()) -
+                                  glm::dvec2(particles[j].GetPosition());
+        double cutoff = double(particles[i].GetRadius()) + particles[j].GetRadius() + 2;
+        if (glm::dot(displacement, displacement) <= cutoff * cutoff) {
+          expected.push_back(j);
+        }
+      }
+      REQUIRE(std::vector<size_t>(multi_level.NeighborsBegin(i), multi_level.NeighborsEnd(i)) ==
+              expected);
+      REQUIRE(std::vector<size_t>(uniform.NeighborsBegin(i), uniform.NeighborsEnd(i)) ==
+              expected);
+    }
+  }
+
+  SECTION("Small Particles are not checked against each other in large cells") {
+    REQUIRE(multi_level.GetStats().pair_count == uniform.GetStats().pair_count);
+    REQUIRE(multi_level.GetStats().candidate_checks * 4 < uniform.GetStats().candidate_checks);
+  }
+}
+
+TEST_CASE("Builds on a ThreadPool", "[neighbor-list]") {
+  // Enough Particles and cells to split into several chunks and bands at every level
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 1, 1, 30000),
+          idealgas::ParticleConfig(1, "blue", 3, 10, 10000),
+          idealgas::ParticleConfig(2, "green", 12, 100, 500)};
+  idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 2000, 2000, 9);
+  const std::vector<idealgas::Particle>& particles = container.GetParticles();
+  idealgas::ThreadPool thread_pool(4);
+
+  idealgas::NeighborList serial(2);
+  idealgas::NeighborList parallel(2);
+  serial.Build(particles);
+  parallel.Build(particles, &thread_pool);
+  REQUIRE(parallel.GetStats().level_count > 1);
+
+  SECTION("The same pairs are listed in the same order") {
+    REQUIRE(parallel.GetStats().pair_count == serial.GetStats().pair_count);
+    REQUIRE(parallel.GetStats().candidate_checks == serial.GetStats().candidate_checks);
+    for (size_t i = 0; i < particles.size(); i++) {
+      REQUIRE(std::vector<size_t>(parallel.NeighborsBegin(i), parallel.NeighborsEnd(i)) ==
+              std::vector<size_t>(serial.NeighborsBegin(i), serial.NeighborsEnd(i)));
+    }
+  }
+
+  SECTION("Every listed pair is within reach") {
+    for (size_t i = 0; i < particles.size(); i++) {
+      for (const size_t* j = parallel.NeighborsBegin(i); j != parallel.NeighborsEnd(i); j++) {
+        glm::dvec2 displacement = glm::dvec2(particles[i].GetPosition()) -
+                                  glm::dvec2(particles[*j].GetPosition());
+        double cutoff = double(particles[i].GetRadius()) + particles[*j].GetRadius() + 2;
+        REQUIRE(glm::dot(displacement, displacement) <= cutoff * cutoff);
+      }
+    }
+  }
+}
+
+TEST_CASE("Incremental insertion and removal", "[neighbor-list]") {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 1, 1, 300),
+          idealgas::ParticleConfig(1, "blue", 6, 10, 30),
+          idealgas::ParticleConfig(2, "green", 20, 100, 4)};
+  idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 500, 500, 3);
+  std::vector<idealgas::Particle> particles = container.GetParticles();
+
+  // Listed on the first half, within a corner of the box
+  size_t first = particles.size() / 2;
+  std::vector<idealgas::Particle> listed;
+  for (const idealgas::Particle& particle : particles) {
+    if (listed.size() < first && particle.GetPosition().x < 300 &&
+        particle.GetPosition().y < 300) {
+      listed.push_back(particle);
+    }
+  }
+  first = listed.size();
+  for (const idealgas::Particle& particle : particles) {
+    if (particle.GetPosition().x >= 300 || particle.GetPosition().y >= 300) {
+      listed.push_back(particle);
+    }
+  }
+
+  idealgas::NeighborList incremental(2);
+  incremental.Build(std::vector<idealgas::Particle>(listed.begin(), listed.begin() + first));
+  REQUIRE(incremental.GetStats().level_count > 1);
+
+  auto require_same_pairs = [](const idealgas::NeighborList& neighbor_list,
+                               const std::vector<idealgas::Particle>& particles) {
+    idealgas::NeighborList rebuilt(2);
+    rebuilt.Build(particles);
+    REQUIRE(neighbor_list.GetStats().pair_count == rebuilt.GetStats().pair_count);
+    for (size_t i = 0; i < particles.size(); i++) {
+      REQUIRE(std::vector<size_t>(neighbor_list.NeighborsBegin(i), neighbor_list.NeighborsEnd(i))
+              == std::vector<size_t>(rebuilt.NeighborsBegin(i), rebuilt.NeighborsEnd(i)));
+    }
+  };
+
+  SECTION("Inserted Particles outside the grid are listed as by a rebuild") {
+    incremental.Insert(listed, first);
+    REQUIRE(incremental.GetStats().rebuilds == 1);
+    REQUIRE(incremental.GetStats().incremental_updates == 1);
+    require_same_pairs(incremental, listed);
+    REQUIRE_FALSE(incremental.NeedsRebuild(listed));
+  }
+
+  SECTION("Removed Particles are dropped and the rest renumbered") {
+    incremental.Insert(listed, first);
+    std::vector<bool> removed(listed.size(), false);
+    std::vector<idealgas::Particle> kept;
+    for (size_t i = 0; i < listed.size(); i++) {
+      removed[i] = i % 3 == 0 || listed[i].GetType() == 2;
+      if (!removed[i]) {
+        kept.push_back(listed[i]);
+      }
+    }
+    incremental.Remove(removed);
+    REQUIRE(incremental.GetStats().rebuilds == 1);
+    require_same_pairs(incremental, kept);
+
+    // The grid still holds the kept Particles, so later insertions search it
+    kept.push_back(listed[0]);
+    incremental.Insert(kept, kept.size() - 1);
+    REQUIRE(incremental.GetStats().rebuilds == 1);
+    require_same_pairs(incremental, kept);
+  }
+
+  SECTION("A Particle larger than the coarsest cells rebuilds the list") {
+    listed.erase(listed.begin() + first, listed.end());
+    listed.emplace_back(3, glm::vec2(100, 100), glm::vec2(0, 0), 200, 1);
+    incremental.Insert(listed, first);
+    REQUIRE(incremental.GetStats().rebuilds == 2);
+    REQUIRE(incremental.GetStats().incremental_updates == 0);
+    require_same_pairs(incremental, listed);
+  }
+}
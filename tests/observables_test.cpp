@@ -0,0 +1,56 @@
+#include <core/observables.h>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Compensated summation", "[precision]") {
+  SECTION("Sum of small terms onto a large float total") {
+    idealgas::CompensatedSum<float> compensated;
+    float naive = 0;
+    compensated.Add(1e7f);
+    naive += 1e7f;
+    for (size_t i = 0; i < 10000; i++) {
+      compensated.Add(0.1f);
+      naive += 0.1f;
+    }
+    // Each 0.1 is below half an ulp of 1e7 in float, so the naive sum never moves
+    REQUIRE(naive == 1e7f);
+    REQUIRE(compensated.GetSum() == Approx(1e7 + 1000).epsilon(1e-7));
+  }
+
+  SECTION("Empty sum is zero") {
+    idealgas::CompensatedSum<double> compensated;
+    REQUIRE(compensated.GetSum() == 0);
+  }
+}
+
+TEST_CASE("Kinetic energy and momentum", "[precision][energy][momentum]") {
+  SECTION("Float and double particles agree") {
+    std::vector<idealgas::BasicParticle<float>> float_particles;
+    std::vector<idealgas::BasicParticle<double>> double_particles;
+    float_particles.emplace_back(0, glm::vec<2, float>(1, 2), glm::vec<2, float>(3, 4), 10.0f, 2.0f);
+    float_particles.emplace_back(0, glm::vec<2, float>(5, 6), glm::vec<2, float>(-1, -1), 10.0f, 8.0f);
+    double_particles.emplace_back(0, glm::vec<2, double>(1, 2), glm::vec<2, double>(3, 4), 10.0, 2.0);
+    double_particles.emplace_back(0, glm::vec<2, double>(5, 6), glm::vec<2, double>(-1, -1), 10.0, 8.0);
+
+    // E = 0.5 * 2 * 25 + 0.5 * 8 * 2 = 33
+    REQUIRE(idealgas::ComputeKineticEnergy(float_particles) == Approx(33));
+    REQUIRE(idealgas::ComputeKineticEnergy(double_particles) == Approx(33));
+
+    // p = 2 * [3, 4] + 8 * [-1, -1] = [-2, 0]
+    REQUIRE(idealgas::ComputeMomentum(float_particles).x == Approx(-2));
+    REQUIRE(idealgas::ComputeMomentum(double_particles).y == Approx(0));
+  }
+
+  SECTION("Collision conserves energy and momentum") {
+    std::vector<idealgas::BasicParticle<double>> particles;
+    particles.emplace_back(0, glm::vec<2, double>(1, 2), glm::vec<2, double>(3, 4), 10.0, 2.0);
+    particles.emplace_back(0, glm::vec<2, double>(5, 6), glm::vec<2, double>(-1, -1), 10.0, 8.0);
+    double energy = idealgas::ComputeKineticEnergy(particles);
+    glm::vec<2, double> momentum = idealgas::ComputeMomentum(particles);
+
+    idealgas::CollideParticles(particles[0], particles[1]);
+    REQUIRE(idealgas::ComputeKineticEnergy(particles) == Approx(energy));
+    REQUIRE(idealgas::ComputeMomentum(particles).x == Approx(momentum.x));
+    REQUIRE(idealgas::ComputeMomentum(particles).y == Approx(momentum.y).margin(1e-12));
+  }
+}
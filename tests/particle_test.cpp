@@ -6,12 +6,11 @@ TEST_CASE("Construction from velocity and position", "[constructor]") {
   size_t type = 0;
   glm::vec2 position(1, 2);
   glm::vec2 velocity(3, 4);
-  ci::Color color = ci::Color("red");
   float radius = 10;
   double mass = 1;
 
   SECTION("Expected construction", "[position][velocity]") {
-    idealgas::Particle particle(type, position, velocity, color, radius, mass);
+    idealgas::Particle particle(type, position, velocity, radius, mass);
     REQUIRE(particle.GetPosition().x == 1);
     REQUIRE(particle.GetPosition().y == 2);
     REQUIRE(particle.GetVelocity().x == 3);
@@ -22,7 +21,7 @@ TEST_CASE("Construction from velocity and position", "[constructor]") {
     SECTION("Construction from 0 value vector") {
       SECTION("Position zero vector","[position]") {
         glm::vec2 zero_pos(0,0);
-        idealgas::Particle particle(type, zero_pos, velocity, color, radius, mass);
+        idealgas::Particle particle(type, zero_pos, velocity, radius, mass);
         REQUIRE(particle.GetPosition().x == 0);
         REQUIRE(particle.GetPosition().y == 0);
         REQUIRE(particle.GetVelocity().x == 3);
@@ -31,7 +30,7 @@ TEST_CASE("Construction from velocity and position", "[constructor]") {
 
       SECTION("Velocity zero vector","[velocity]") {
         glm::vec2 zero_vel(0,0);
-        idealgas::Particle particle(type, position, zero_vel, color, radius, mass);
+        idealgas::Particle particle(type, position, zero_vel, radius, mass);
         REQUIRE(particle.GetPosition().x == 1);
         REQUIRE(particle.GetPosition().y == 2);
         REQUIRE(particle.GetVelocity().x == 0);
@@ -42,7 +41,7 @@ TEST_CASE("Construction from velocity and position", "[constructor]") {
     SECTION("Construction from negative value vector") {
       SECTION("Position zero vector","[position]") {
         glm::vec2 negative_pos(-5,-10);
-        idealgas::Particle particle(type, negative_pos, velocity, color, radius, mass);
+        idealgas::Particle particle(type, negative_pos, velocity, radius, mass);
         REQUIRE(particle.GetPosition().x == -5);
         REQUIRE(particle.GetPosition().y == -10);
         REQUIRE(particle.GetVelocity().x == 3);
@@ -51,7 +50,7 @@ TEST_CASE("Construction from velocity and position", "[constructor]") {
 
       SECTION("Velocity zero vector","[velocity]") {
         glm::vec2 negative_vel(-20,-30);
-        idealgas::Particle particle(type, position, negative_vel, color, radius, mass);
+        idealgas::Particle particle(type, position, negative_vel, radius, mass);
         REQUIRE(particle.GetPosition().x == 1);
         REQUIRE(particle.GetPosition().y == 2);
         REQUIRE(particle.GetVelocity().x == -20);
@@ -63,7 +62,7 @@ TEST_CASE("Construction from velocity and position", "[constructor]") {
   SECTION("Construction from default vector") {
     SECTION("Position default vector","[position]") {
       glm::vec2 empty_pos;
-      idealgas::Particle particle(type, empty_pos, velocity, color, radius, mass);
+      idealgas::Particle particle(type, empty_pos, velocity, radius, mass);
       REQUIRE(particle.GetPosition().x == 0);
       REQUIRE(particle.GetPosition().y == 0);
       REQUIRE(particle.GetVelocity().x == 3);
@@ -72,7 +71,7 @@ TEST_CASE("Construction from velocity and position", "[constructor]") {
 
     SECTION("Velocity default vector","[velocity]") {
       glm::vec2 empty_vel;
-      idealgas::Particle particle(type, position, empty_vel, color, radius, mass);
+      idealgas::Particle particle(type, position, empty_vel, radius, mass);
       REQUIRE(particle.GetPosition().x == 1);
       REQUIRE(particle.GetPosition().y == 2);
       REQUIRE(particle.GetVelocity().x == 0);
@@ -85,12 +84,11 @@ TEST_CASE("Process particle movement","[position]") {
   size_t type = 0;
   glm::vec2 position(1, 2);
   glm::vec2 velocity(3, 4);
-  ci::Color color = ci::Color("red");
   float radius = 10;
   double mass = 1;
 
   SECTION("Expected process movement") {
-    idealgas::Particle particle(type, position, velocity, color, radius, mass);
+    idealgas::Particle particle(type, position, velocity, radius, mass);
 
     SECTION("After 1 iteration of process movement") {
       particle.ProcessMovement();
@@ -110,7 +108,7 @@ TEST_CASE("Process particle movement","[position]") {
   SECTION("Process movement with velocity with special value", "[edge-case]") {
     SECTION("Zero velocity") {
       glm::vec2 zero_vel(0, 0);
-      idealgas::Particle particle(type, position, zero_vel, color, radius, mass);
+      idealgas::Particle particle(type, position, zero_vel, radius, mass);
       particle.ProcessMovement();
       particle.ProcessMovement();
       particle.ProcessMovement();
@@ -120,7 +118,7 @@ TEST_CASE("Process particle movement","[position]") {
 
     SECTION("Negative velocity") {
       glm::vec2 negative_vel(-1, -2);
-      idealgas::Particle particle(type, position, negative_vel, color, radius, mass);
+      idealgas::Particle particle(type, position, negative_vel, radius, mass);
       particle.ProcessMovement();
       particle.ProcessMovement();
       particle.ProcessMovement();
@@ -133,7 +131,6 @@ TEST_CASE("Process particle movement","[position]") {
 TEST_CASE("Process X wall collision", "[velocity][wall][collision]") {
   SECTION("Collision occurs negates X velocity") {
     size_t type = 0;
-    ci::Color color = ci::Color("red");
     float radius = 10;
     double mass = 1;
 
@@ -141,7 +138,7 @@ TEST_CASE("Process X wall collision", "[velocity][wall][collision]") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(-3, -4);
 
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 9
       // radius = 10
@@ -153,7 +150,7 @@ TEST_CASE("Process X wall collision", "[velocity][wall][collision]") {
     SECTION("Particle left of wall") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(3, 4);
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 9
       // radius = 10
@@ -165,14 +162,13 @@ TEST_CASE("Process X wall collision", "[velocity][wall][collision]") {
 
   SECTION("Collision does not occur") {
     size_t type = 0;
-    ci::Color color = ci::Color("red");
     float radius = 10;
     double mass = 1;
 
     SECTION("Distance from wall larger than radius") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(3, 4);
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 11
       // radius = 10
@@ -184,7 +180,7 @@ TEST_CASE("Process X wall collision", "[velocity][wall][collision]") {
     SECTION("Distance within radius but moving away from wall") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(-3, -4);
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 6
       // radius = 10
@@ -198,14 +194,13 @@ TEST_CASE("Process X wall collision", "[velocity][wall][collision]") {
 TEST_CASE("Process Y wall collision", "[velocity][wall][collision]") {
   SECTION("Collision occurs negates Y velocity") {
     size_t type = 0;
-    ci::Color color = ci::Color("red");
     float radius = 10;
     double mass = 1;
 
     SECTION("Particle above wall") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(-3, -4);
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 9
       // radius = 10
@@ -217,7 +212,7 @@ TEST_CASE("Process Y wall collision", "[velocity][wall][collision]") {
     SECTION("Particle below wall") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(3, 4);
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 9
       // radius = 10
@@ -229,14 +224,13 @@ TEST_CASE("Process Y wall collision", "[velocity][wall][collision]") {
 
   SECTION("Collision does not occur") {
     size_t type = 0;
-    ci::Color color = ci::Color("red");
     float radius = 10;
     double mass = 1;
 
     SECTION("Distance from wall larger than radius") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(3, 4);
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 11
       // radius = 10
@@ -248,7 +242,7 @@ TEST_CASE("Process Y wall collision", "[velocity][wall][collision]") {
     SECTION("Distance within radius but moving away from wall") {
       glm::vec2 position(1, 2);
       glm::vec2 velocity(-3, -4);
-      idealgas::Particle particle(type, position, velocity, color, radius, mass);
+      idealgas::Particle particle(type, position, velocity, radius, mass);
 
       // abs(position - wall_pos) = 6
       // radius = 10
@@ -259,9 +253,36 @@ TEST_CASE("Process Y wall collision", "[velocity][wall][collision]") {
   }
 }
 
+TEST_CASE("Process box collision", "[velocity][wall][collision]") {
+  size_t type = 0;
+  float radius = 10;
+  double mass = 1;
+
+  SECTION("Particle touching a wall and moving outwards bounces") {
+    idealgas::Particle particle(type, glm::vec2(5, 95), glm::vec2(-3, 4), radius, mass);
+    REQUIRE(particle.ProcessBoxCollision(0, 0, 100));
+    REQUIRE(particle.GetVelocity().x == 3);
+    REQUIRE(particle.ProcessBoxCollision(1, 0, 100));
+    REQUIRE(particle.GetVelocity().y == -4);
+  }
+
+  SECTION("Particle pushed past a wall still turns back") {
+    // A single wall ignores it, as it is more than a radius away
+    idealgas::Particle particle(type, glm::vec2(-30, 50), glm::vec2(-3, 4), radius, mass);
+    REQUIRE_FALSE(particle.ProcessXWallCollision(0));
+    REQUIRE(particle.ProcessBoxCollision(0, 0, 100));
+    REQUIRE(particle.GetVelocity().x == 3);
+  }
+
+  SECTION("Particle past a wall and moving back in is left alone") {
+    idealgas::Particle particle(type, glm::vec2(-5, 50), glm::vec2(3, 4), radius, mass);
+    REQUIRE_FALSE(particle.ProcessBoxCollision(0, 0, 100));
+    REQUIRE(particle.GetVelocity().x == 3);
+  }
+}
+
 TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
   size_t type = 0;
-  ci::Color color = ci::Color("red");
   float radius = 10;
   double mass = 1;
 
@@ -270,8 +291,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
     glm::vec2 velocity_a(3, 4);
     glm::vec2 position_b(5, 6);
     glm::vec2 velocity_b(-1, -1);
-    idealgas::Particle particle_a(type, position_a, velocity_a, color, radius, mass);
-    idealgas::Particle particle_b(type, position_b, velocity_b, color, radius, mass);
+    idealgas::Particle particle_a(type, position_a, velocity_a, radius, mass);
+    idealgas::Particle particle_b(type, position_b, velocity_b, radius, mass);
 
     SECTION("Expected collision between two particles") {
       // Distance between particles = sqrt((5 - 1) ^ 2 + (6 - 1) ^ 2)) = 5.66
@@ -304,8 +325,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
     SECTION("Collision change is affected by particle mass", "[mass]") {
       double mass_a = 2;
       double mass_b = 8;
-      particle_a = idealgas::Particle(type, position_a, velocity_a, color, radius, mass_a);
-      particle_b = idealgas::Particle(type, position_b, velocity_b, color, radius, mass_b);
+      particle_a = idealgas::Particle(type, position_a, velocity_a, radius, mass_a);
+      particle_b = idealgas::Particle(type, position_b, velocity_b, radius, mass_b);
       idealgas::CollideParticles(particle_a, particle_b);
       // v1' = [3, 4] - ([4, 5] . [-4, -4]) / (|[-4, -4]| ^ 2) * [-4, -4] * (2 * 8 / 10)
       // = [3, 4] - (-36/32) * [-4, -4] * (16 / 10)
@@ -324,8 +345,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
     SECTION("One particle of 0 mass", "[mass]") {
       double mass_a = 0;
       double mass_b = 8;
-      particle_a = idealgas::Particle(type, position_a, velocity_a, color, radius, mass_a);
-      particle_b = idealgas::Particle(type, position_b, velocity_b, color, radius, mass_b);
+      particle_a = idealgas::Particle(type, position_a, velocity_a, radius, mass_a);
+      particle_b = idealgas::Particle(type, position_b, velocity_b, radius, mass_b);
       idealgas::CollideParticles(particle_a, particle_b);
       // v1' = [3, 4] - ([4, 5] . [-4, -4]) / (|[-4, -4]| ^ 2) * [-4, -4] * (2 * 8 / 8)
       // = [3, 4] - (-36/32) * [-4, -4] * (16 / 10)
@@ -350,8 +371,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
         glm::vec2 position_b(22, 1);
         glm::vec2 velocity_b(1, 1);
 
-        idealgas::Particle particle_a(type, position_a, velocity_a, color, radius, mass);
-        idealgas::Particle particle_b(type, position_b, velocity_b, color, radius, mass);
+        idealgas::Particle particle_a(type, position_a, velocity_a, radius, mass);
+        idealgas::Particle particle_b(type, position_b, velocity_b, radius, mass);
         // Distance between particles = 21
         // Sum of radii = 20
         REQUIRE(idealgas::CheckCollision(particle_a, particle_b) == false);
@@ -363,8 +384,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
         glm::vec2 position_b(1, 22);
         glm::vec2 velocity_b(1, 1);
 
-        idealgas::Particle particle_a(type, position_a, velocity_a, color, radius, mass);
-        idealgas::Particle particle_b(type, position_b, velocity_b, color, radius, mass);
+        idealgas::Particle particle_a(type, position_a, velocity_a, radius, mass);
+        idealgas::Particle particle_b(type, position_b, velocity_b, radius, mass);
         // Distance between particles = 21
         // Sum of radii = 20
         REQUIRE(idealgas::CheckCollision(particle_a, particle_b) == false);
@@ -376,8 +397,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
         glm::vec2 position_b(16, 16);
         glm::vec2 velocity_b(1, 1);
 
-        idealgas::Particle particle_a(type, position_a, velocity_a, color, radius, mass);
-        idealgas::Particle particle_b(type, position_b, velocity_b, color, radius, mass);
+        idealgas::Particle particle_a(type, position_a, velocity_a, radius, mass);
+        idealgas::Particle particle_b(type, position_b, velocity_b, radius, mass);
         // Distance between particles = sqrt((16 - 1) ^ 2 + (16 - 1) ^ 2)) = 21.213
         // Sum of radii = 20
 
@@ -391,8 +412,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
       glm::vec2 position_b(10, 10);
       glm::vec2 velocity_b(1, 1);
 
-      idealgas::Particle particle_a(type, position_a, velocity_a, color, radius, mass);
-      idealgas::Particle particle_b(type, position_b, velocity_b, color, radius, mass);
+      idealgas::Particle particle_a(type, position_a, velocity_a, radius, mass);
+      idealgas::Particle particle_b(type, position_b, velocity_b, radius, mass);
       // Distance between particles = sqrt((10 - 1) ^ 2 + (10 - 1) ^ 2)) = 12.727
       // Sum of radii = 20
       // (v1 - v2) . (x1 - x2) = [-3, -4] . [-9, -9] = (-3 * -9) + (-4 * -9) = 63 > 0
@@ -406,8 +427,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
         glm::vec2 position_b(1, 2);
         glm::vec2 velocity_b(-3, -4);
 
-        idealgas::Particle particle_a(type, position_a, velocity_a, color, radius, mass);
-        idealgas::Particle particle_b(type, position_b, velocity_b, color, radius, mass);
+        idealgas::Particle particle_a(type, position_a, velocity_a, radius, mass);
+        idealgas::Particle particle_b(type, position_b, velocity_b, radius, mass);
         // Distance between particles = 0
         // Sum of radii = 20
         // (v1 - v2) . (x1 - x2) = [6, 8] . [0, 0] = 0
@@ -421,8 +442,8 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
         glm::vec2 position_b(3, 3);
         glm::vec2 velocity_b(3, 4);
 
-        idealgas::Particle particle_a(type, position_a, velocity_a, color, radius, mass);
-        idealgas::Particle particle_b(type, position_b, velocity_b, color, radius, mass);
+        idealgas::Particle particle_a(type, position_a, velocity_a, radius, mass);
+        idealgas::Particle particle_b(type, position_b, velocity_b, radius, mass);
         // Distance between particles = 2.24
         // Sum of radii = 20
         // (v1 - v2) . (x1 - x2) = [0, 0] . [2, 1] = 0
@@ -434,7 +455,6 @@ TEST_CASE("Process two particle collision", "[velocity][particle][collision]") {
 
 TEST_CASE("Variable radii", "[radius]") {
   size_t type = 0;
-  ci::Color color = ci::Color("red");
   float radius_a = 3;
   float radius_b = 3;
   double mass = 2;
@@ -442,8 +462,8 @@ TEST_CASE("Variable radii", "[radius]") {
   glm::vec2 velocity_a(3, 4);
   glm::vec2 position_b(5, 6);
   glm::vec2 velocity_b(-1, -1);
-  idealgas::Particle particle_a(type, position_a, velocity_a, color, radius_a, mass);
-  idealgas::Particle particle_b(type, position_b, velocity_b, color, radius_b, mass);
+  idealgas::Particle particle_a(type, position_a, velocity_a, radius_a, mass);
+  idealgas::Particle particle_b(type, position_b, velocity_b, radius_b, mass);
 
   SECTION("Expected collision between two particles") {
     // Distance between particles = sqrt((5 - 1) ^ 2 + (6 - 1) ^ 2)) = 5.66
@@ -454,7 +474,7 @@ TEST_CASE("Variable radii", "[radius]") {
 
   SECTION("Particle does not collide with small particle at same position") {
     float radius_c = 2;
-    idealgas::Particle particle_c(type, position_b, velocity_b, color, radius_c, mass);
+    idealgas::Particle particle_c(type, position_b, velocity_b, radius_c, mass);
     // Distance between particles = sqrt((5 - 1) ^ 2 + (6 - 1) ^ 2)) = 5.66
     // Sum of radii = 5 (DOES NOT COLLIDE)
     // (v1 - v2) . (x1 - x2) = [4, 5] . [-4, -4] = (4 * -4) + (5 * -4) = -36 < 0
@@ -465,8 +485,8 @@ TEST_CASE("Variable radii", "[radius]") {
     glm::vec2 position(20, 20);
     glm::vec2 velocity_a(3, 4);
     glm::vec2 velocity_b(-1, -1);
-    idealgas::Particle particle_d(type, position, velocity_a, color, 0, mass);
-    idealgas::Particle particle_e(type, position, velocity_b, color, 0, mass);
+    idealgas::Particle particle_d(type, position, velocity_a, 0, mass);
+    idealgas::Particle particle_e(type, position, velocity_b, 0, mass);
     REQUIRE(idealgas::CheckCollision(particle_d, particle_e) == false);
   }
 }
\ No newline at end of file
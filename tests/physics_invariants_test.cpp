@@ -0,0 +1,322 @@
+#include <core/gas_container.h>
+#include <core/observables.h>
+
+#include <cmath>
+#include <map>
+#include <random>
+
+#include <catch2/catch.hpp>
+
+/**
+ * Invariants of the physics checked over many random systems in 2D and 3D, and the
+ * accelerated paths checked against brute force
+ */
+
+namespace {
+
+typedef idealgas::Scalar Scalar;
+
+// Seeds of the random systems each property is checked on
+const unsigned int kSeedCount = 4;
+
+// Collisions resolved after a wall bounce may carry a Particle this far past its wall
+// before it turns back
+const double kContainmentMargin = 8;
+
+// Overlapping pairs separate within this many steps, or this many in dense gas mode
+const size_t kMaxOverlapSteps = 200;
+const size_t kMaxDenseOverlapSteps = 20;
+
+std::vector<idealgas::ParticleConfig> MakeConfigs(size_t particle_count) {
+  return {idealgas::ParticleConfig(0, "red", 4, 20, particle_count * 3 / 10),
+          idealgas::ParticleConfig(1, "blue", 2, 5, particle_count * 3 / 10),
+          idealgas::ParticleConfig(2, "green", 1, 1, particle_count * 4 / 10)};
+}
+
+/**
+ * @return The edge of a box holding a gas with ten units between neighbours on average
+ */
+template <int D>
+double GetBoxSize(size_t particle_count) {
+  return 10 * std::pow(double(particle_count), 1.0 / D);
+}
+
+template <int D>
+idealgas::BasicGasContainer<D> MakeGas(size_t particle_count, unsigned int seed) {
+  return idealgas::BasicGasContainer<D>(MakeConfigs(particle_count), glm::vec<D, float>(0),
+                                        glm::vec<D, double>(GetBoxSize<D>(particle_count)),
+                                        seed);
+}
+
+/**
+ * @return The largest distance of any Particle's edge past a wall of the box
+ */
+template <int D>
+double GetMaxEscape(const idealgas::BasicGasContainer<D>& container) {
+  double max_escape = 0;
+  for (const idealgas::BasicParticle<Scalar, D>& particle : container.GetParticles()) {
+    for (int axis = 0; axis < D; axis++) {
+      double lower = container.GetTopLeftCorner()[axis];
+      double upper = lower + container.GetBoxSize()[axis];
+      double position = particle.GetPosition()[axis];
+      max_escape = std::max(max_escape, lower - (position + particle.GetRadius()));
+      max_escape = std::max(max_escape, position - particle.GetRadius() - upper);
+    }
+  }
+  return max_escape;
+}
+
+/**
+ * @return The sum of every momentum component's magnitude, the scale of momentum errors
+ */
+template <int D>
+double GetMomentumScale(const std::vector<idealgas::BasicParticle<Scalar, D>>& particles) {
+  double scale = 0;
+  for (const idealgas::BasicParticle<Scalar, D>& particle : particles) {
+    for (int axis = 0; axis < D; axis++) {
+      scale += std::abs(double(particle.GetMass()) * particle.GetVelocity()[axis]);
+    }
+  }
+  return scale;
+}
+
+template <int D>
+void CheckContainerInvariants(bool dense_gas_mode) {
+  for (unsigned int seed = 1; seed <= kSeedCount; seed++) {
+    idealgas::BasicGasContainer<D> container = MakeGas<D>(1000, seed);
+    container.SetDenseGasMode(dense_gas_mode);
+    double initial_energy = container.GetKineticEnergy();
+
+    // Steps each overlapping pair has overlapped for
+    std::map<std::pair<size_t, size_t>, size_t> overlap_steps;
+    size_t max_overlap_steps = 0;
+    idealgas::BasicNeighborList<D> neighbor_list(0);
+    for (size_t step = 0; step < 300; step++) {
+      container.Update();
+      REQUIRE(GetMaxEscape(container) <= kContainmentMargin);
+
+      const std::vector<idealgas::BasicParticle<Scalar, D>>& particles =
+              container.GetParticles();
+      std::map<std::pair<size_t, size_t>, size_t> next_overlap_steps;
+      neighbor_list.Build(particles);
+      for (size_t i = 0; i < particles.size(); i++) {
+        for (const size_t* j = neighbor_list.NeighborsBegin(i);
+             j != neighbor_list.NeighborsEnd(i); j++) {
+          double distance = glm::length(particles[i].GetPosition() -
+                                        particles[*j].GetPosition());
+          if (distance < particles[i].GetRadius() + particles[*j].GetRadius()) {
+            size_t steps = overlap_steps[std::make_pair(i, *j)] + 1;
+            next_overlap_steps[std::make_pair(i, *j)] = steps;
+            max_overlap_steps = std::max(max_overlap_steps, steps);
+          }
+        }
+      }
+      overlap_steps.swap(next_overlap_steps);
+    }
+
+    if (!dense_gas_mode) {
+      // The solver's simultaneous impulses are not exactly elastic
+      REQUIRE(container.GetKineticEnergy() == Approx(initial_energy).epsilon(1e-4));
+    }
+    REQUIRE(max_overlap_steps <= (dense_gas_mode ? kMaxDenseOverlapSteps : kMaxOverlapSteps));
+    REQUIRE(container.GetCollisionCounts().particle_collisions > 0);
+  }
+}
+
+template <int D>
+void CheckRandomPairs() {
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> unit(-1, 1);
+  std::uniform_real_distribution<double> mass(0.1, 100);
+  auto random_vec = [&]() {
+    glm::vec<D, Scalar> vec;
+    for (int axis = 0; axis < D; axis++) {
+      vec[axis] = Scalar(unit(generator));
+    }
+    return vec;
+  };
+
+  // Unit radii and positions within one unit, so most pairs touch
+  for (size_t trial = 0; trial < 2000; trial++) {
+    std::vector<idealgas::BasicParticle<Scalar, D>> pair;
+    pair.emplace_back(0, glm::vec<D, Scalar>(0), random_vec(), 1,
+                      Scalar(mass(generator)));
+    pair.emplace_back(0, random_vec(), random_vec(), 1,
+                      Scalar(mass(generator)));
+    double energy = idealgas::ComputeKineticEnergy(pair);
+    glm::vec<D, Scalar> momentum = idealgas::ComputeMomentum(pair);
+    double scale = GetMomentumScale(pair);
+
+    if (idealgas::CheckCollision(pair[0], pair[1])) {
+      idealgas::CollideParticles(pair[0], pair[1]);
+    }
+    REQUIRE(idealgas::ComputeKineticEnergy(pair) == Approx(energy).epsilon(1e-5));
+    for (int axis = 0; axis < D; axis++) {
+      REQUIRE(std::abs(double(idealgas::ComputeMomentum(pair)[axis]) - momentum[axis]) <=
+              1e-5 * scale);
+    }
+  }
+}
+
+/**
+ * Steps a set of Particles without walls, resolving pairs as the GasContainer does
+ */
+template <int D>
+void CheckPairMomentum(bool dense_gas_mode) {
+  for (unsigned int seed = 1; seed <= kSeedCount; seed++) {
+    std::vector<idealgas::BasicParticle<Scalar, D>> particles =
+            MakeGas<D>(1000, seed).GetParticles();
+    glm::vec<D, Scalar> initial_momentum = idealgas::ComputeMomentum(particles);
+    double scale = GetMomentumScale(particles);
+
+    idealgas::BasicNeighborList<D> neighbor_list(8);
+    idealgas::BasicContactSolver<D> contact_solver;
+    std::vector<std::pair<size_t, size_t>> pairs;
+    size_t collisions = 0;
+    for (size_t step = 0; step < 100; step++) {
+      for (idealgas::BasicParticle<Scalar, D>& particle : particles) {
+        particle.ProcessMovement();
+      }
+      neighbor_list.Update(particles);
+      pairs.clear();
+      for (size_t i = 0; i < particles.size(); i++) {
+        for (const size_t* j = neighbor_list.NeighborsBegin(i);
+             j != neighbor_list.NeighborsEnd(i); j++) {
+          pairs.emplace_back(i, *j);
+        }
+      }
+
+      if (dense_gas_mode) {
+        contact_solver.Solve(particles, pairs);
+        collisions += contact_solver.GetStats().contact_count;
+      } else {
+        for (const std::pair<size_t, size_t>& pair : pairs) {
+          if (idealgas::CheckCollision(particles[pair.first], particles[pair.second])) {
+            idealgas::CollideParticles(particles[pair.first], particles[pair.second]);
+            collisions++;
+          }
+        }
+      }
+    }
+
+    glm::vec<D, Scalar> momentum = idealgas::ComputeMomentum(particles);
+    for (int axis = 0; axis < D; axis++) {
+      REQUIRE(std::abs(double(momentum[axis]) - initial_momentum[axis]) <= 1e-5 * scale);
+    }
+    REQUIRE(collisions > 0);
+  }
+}
+
+template <int D>
+void CheckMatchesBruteForce(bool dense_gas_mode) {
+  for (unsigned int seed = 1; seed <= kSeedCount; seed++) {
+    idealgas::BasicGasContainer<D> brute_force = MakeGas<D>(1000, seed);
+    idealgas::BasicGasContainer<D> neighbor_listed = MakeGas<D>(1000, seed);
+    brute_force.SetNeighborSkin(0);
+    brute_force.SetDenseGasMode(dense_gas_mode);
+    neighbor_listed.SetDenseGasMode(dense_gas_mode);
+
+    for (size_t step = 0; step < 100; step++) {
+      brute_force.Update();
+      neighbor_listed.Update();
+    }
+    for (size_t i = 0; i < brute_force.GetParticles().size(); i++) {
+      REQUIRE(brute_force.GetParticles()[i].GetPosition() ==
+              neighbor_listed.GetParticles()[i].GetPosition());
+      REQUIRE(brute_force.GetParticles()[i].GetVelocity() ==
+              neighbor_listed.GetParticles()[i].GetVelocity());
+    }
+    REQUIRE(brute_force.GetCollisionCounts().particle_collisions ==
+            neighbor_listed.GetCollisionCounts().particle_collisions);
+  }
+}
+
+template <int D>
+void CheckMatchesSerial() {
+  // Large enough that the per-particle pass and initialisation run on the pool
+  idealgas::ThreadPool thread_pool(4);
+  idealgas::BasicGasContainer<D> serial = MakeGas<D>(40000, 1);
+  idealgas::BasicGasContainer<D> threaded(MakeConfigs(40000), glm::vec<D, float>(0),
+                                          glm::vec<D, double>(GetBoxSize<D>(40000)), 1,
+                                          &thread_pool);
+  for (size_t step = 0; step < 20; step++) {
+    serial.Update();
+    threaded.Update();
+  }
+  for (size_t i = 0; i < serial.GetParticles().size(); i++) {
+    REQUIRE(serial.GetParticles()[i].GetPosition() == threaded.GetParticles()[i].GetPosition());
+  }
+  REQUIRE(serial.GetCollisionCounts().wall_bounces == threaded.GetCollisionCounts().wall_bounces);
+}
+
+/**
+ * @return The exponent b of the candidate checks of a neighbour list build growing as N^b,
+ * fitted between the smallest and largest system
+ */
+template <int D>
+double GetNeighborSearchExponent(size_t min_count, size_t max_count) {
+  double min_checks = 0;
+  double max_checks = 0;
+  for (size_t particle_count : {min_count, max_count}) {
+    idealgas::BasicGasContainer<D> container = MakeGas<D>(particle_count, 1);
+    idealgas::BasicNeighborList<D> neighbor_list(8);
+    neighbor_list.Build(container.GetParticles());
+    double checks = double(std::max<size_t>(1, neighbor_list.GetStats().candidate_checks));
+    (particle_count == min_count ? min_checks : max_checks) = checks;
+  }
+  return std::log(max_checks / min_checks) / std::log(double(max_count) / min_count);
+}
+
+}  // namespace
+
+TEST_CASE("Pair collisions conserve momentum and energy", "[invariants][collision]") {
+  SECTION("Random pairs") {
+    CheckRandomPairs<2>();
+    CheckRandomPairs<3>();
+  }
+
+  SECTION("Every pair pass of a gas") {
+    CheckPairMomentum<2>(false);
+    CheckPairMomentum<3>(false);
+  }
+
+  SECTION("Every contact solver pass of a gas") {
+    CheckPairMomentum<2>(true);
+    CheckPairMomentum<3>(true);
+  }
+}
+
+TEST_CASE("Gas invariants", "[invariants]") {
+  SECTION("Energy is conserved, Particles stay in the box and overlaps separate") {
+    CheckContainerInvariants<2>(false);
+    CheckContainerInvariants<3>(false);
+  }
+
+  SECTION("Dense gas mode keeps Particles in the box and separates overlaps") {
+    CheckContainerInvariants<2>(true);
+    CheckContainerInvariants<3>(true);
+  }
+}
+
+TEST_CASE("Accelerated paths match brute force", "[invariants][neighbor-list]") {
+  SECTION("Neighbour list") {
+    CheckMatchesBruteForce<2>(false);
+    CheckMatchesBruteForce<3>(false);
+  }
+
+  SECTION("Neighbour list in dense gas mode") {
+    CheckMatchesBruteForce<2>(true);
+    CheckMatchesBruteForce<3>(true);
+  }
+
+  SECTION("Thread pool") {
+    CheckMatchesSerial<2>();
+    CheckMatchesSerial<3>();
+  }
+}
+
+TEST_CASE("Neighbour search scales near linearly", "[invariants][scaling]") {
+  // Quadratic search would give an exponent of 2
+  REQUIRE(GetNeighborSearchExponent<2>(1000, 100000) < 1.2);
+  REQUIRE(GetNeighborSearchExponent<3>(1000, 100000) < 1.2);
+}
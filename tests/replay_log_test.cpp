@@ -0,0 +1,286 @@
+#include <core/replay_log.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+const char kLogPath[] = "replay_log_test.bin";
+
+std::vector<idealgas::ParticleConfig> CreateConfigs() {
+  return {idealgas::ParticleConfig(0, "red", 10, 100, 40),
+          idealgas::ParticleConfig(1, "blue", 5, 50, 40)};
+}
+
+/**
+ * Records a run of a GasContainer, with one Particle per block hash
+ */
+void RecordRun(idealgas::GasContainer& container, size_t steps) {
+  idealgas::ReplayRecorder recorder(kLogPath, container, 1);
+  for (size_t step = 0; step < steps; step++) {
+    container.Update();
+    recorder.RecordStep(container.GetParticles());
+  }
+  REQUIRE(recorder.IsGood());
+}
+
+}  // namespace
+
+TEST_CASE("Replay log round trip", "[replay]") {
+  idealgas::GasContainer recorded(CreateConfigs(), glm::vec2(0, 0), 300, 300, 7);
+  RecordRun(recorded, 200);
+
+  idealgas::ReplayLog log;
+  REQUIRE(log.Read(kLogPath));
+  REQUIRE(log.GetStepCount() == 201);
+  REQUIRE(log.GetHeader().seed == 7);
+  REQUIRE(log.GetHeader().particle_configs.size() == 2);
+  REQUIRE(log.GetHeader().particle_configs[1].amount == 40);
+  REQUIRE(log.GetHeader().box_size.x == 300);
+  REQUIRE(log.GetHeader().static_geometry.IsEmpty());
+
+  SECTION("A rerun from the header reproduces every step") {
+    idealgas::GasContainer container = log.CreateContainer();
+    REQUIRE_FALSE(log.Verify(container).diverged);
+  }
+
+  SECTION("Brute force and neighbour list collisions give identical trajectories") {
+    idealgas::GasContainer container = log.CreateContainer();
+    container.SetNeighborSkin(0);
+    REQUIRE_FALSE(log.Verify(container).diverged);
+  }
+
+  SECTION("A different seed diverges at step 0") {
+    idealgas::GasContainer container(CreateConfigs(), glm::vec2(0, 0), 300, 300, 8);
+    idealgas::ReplayDivergence divergence = log.Verify(container);
+    REQUIRE(divergence.diverged);
+    REQUIRE(divergence.step == 0);
+  }
+
+  std::remove(kLogPath);
+}
+
+TEST_CASE("Replay logs record static geometry and edits", "[replay]") {
+  idealgas::GasContainer recorded(CreateConfigs(), glm::vec2(0, 0), 300, 300, 7);
+  idealgas::StaticGeometry static_geometry;
+  static_geometry.AddCircle(glm::dvec2(150, 150), 20);
+  idealgas::Piston piston;
+  piston.start = glm::dvec2(280, 50);
+  piston.end = glm::dvec2(280, 250);
+  piston.velocity = glm::dvec2(-0.5, 0);
+  piston.travel = 60;
+  static_geometry.AddPiston(piston);
+  recorded.SetStaticGeometry(static_geometry);
+
+  // Edits before steps 10, 20, ..., made and recorded as Simulation makes them: the box too
+  // small and the type with nothing to remove change nothing, so they are not recorded
+  std::vector<idealgas::ReplayEdit> edits {
+          idealgas::ReplayEdit::AddParticles(idealgas::ParticleConfig(2, "green", 8, 80, 10)),
+          idealgas::ReplayEdit::RemoveParticles(0, 15),
+          idealgas::ReplayEdit::RemoveParticles(5, 15),
+          idealgas::ReplayEdit::ScaleVelocities(1.5),
+          idealgas::ReplayEdit::ResizeBox(glm::dvec2(15, 280)),
+          idealgas::ReplayEdit::ResizeBox(glm::dvec2(250, 280))};
+  size_t recorded_edits = 0;
+  {
+    idealgas::ReplayRecorder recorder(kLogPath, recorded, 1);
+    for (size_t step = 1; step <= 100; step++) {
+      if (step % 10 == 0 && step / 10 <= edits.size() &&
+          edits[step / 10 - 1].Apply(recorded)) {
+        recorder.RecordEdit(edits[step / 10 - 1]);
+        recorded_edits++;
+      }
+      recorded.Update();
+      recorder.RecordStep(recorded.GetParticles());
+    }
+    REQUIRE(recorder.IsGood());
+  }
+  REQUIRE(recorded_edits == 4);
+
+  idealgas::ReplayLog log;
+  REQUIRE(log.Read(kLogPath));
+  REQUIRE(log.GetStepCount() == 101);
+  REQUIRE(log.GetEditCount() == 4);
+  REQUIRE(log.GetHeader().static_geometry.GetObstacles().size() == 1);
+  REQUIRE(log.GetHeader().static_geometry.GetPistons().size() == 1);
+  REQUIRE(log.GetHeader().static_geometry.GetPistons()[0].velocity.x == -0.5);
+
+  SECTION("A rerun replays the geometry and every edit") {
+    idealgas::GasContainer container = log.CreateContainer();
+    REQUIRE(container.GetStaticGeometry().GetPistons().size() == 1);
+    REQUIRE_FALSE(log.Verify(container).diverged);
+    REQUIRE(container.GetParticles().size() == recorded.GetParticles().size());
+    REQUIRE(container.GetBoxSize() == recorded.GetBoxSize());
+  }
+
+  SECTION("A rerun without the geometry diverges") {
+    idealgas::GasContainer container(CreateConfigs(), glm::vec2(0, 0), 300, 300, 7);
+    idealgas::ReplayDivergence divergence = log.Verify(container);
+    REQUIRE(divergence.diverged);
+    REQUIRE(divergence.step > 0);
+  }
+
+  std::remove(kLogPath);
+}
+
+TEST_CASE("Replay logs keep configs that share a type", "[replay]") {
+  // The same type in two sizes, next to each other
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 10, 100, 20),
+          idealgas::ParticleConfig(0, "red", 4, 30, 20),
+          idealgas::ParticleConfig(1, "blue", 5, 50, 20)};
+  idealgas::GasContainer recorded(particle_configs, glm::vec2(0, 0), 300, 300, 7);
+  RecordRun(recorded, 100);
+
+  idealgas::ReplayLog log;
+  REQUIRE(log.Read(kLogPath));
+  const std::vector<idealgas::ParticleConfig>& configs = log.GetHeader().particle_configs;
+  REQUIRE(configs.size() == 3);
+  REQUIRE(configs[0].radius == 10);
+  REQUIRE(configs[1].radius == 4);
+  REQUIRE(configs[1].mass == 30);
+  REQUIRE(configs[1].amount == 20);
+
+  idealgas::GasContainer container = log.CreateContainer();
+  REQUIRE_FALSE(log.Verify(container).diverged);
+  std::remove(kLogPath);
+}
+
+TEST_CASE("Replay logs verify across thread counts and dimensions", "[replay]") {
+  // Past the threshold at which Particles are moved on the ThreadPool
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 2, 100, 12000),
+          idealgas::ParticleConfig(1, "blue", 1, 50, 8000)};
+  idealgas::ThreadPool thread_pool(4);
+
+  SECTION("A serial recording is reproduced with threads") {
+    idealgas::GasContainer recorded(particle_configs, glm::vec2(0, 0), 2000, 2000, 7);
+    RecordRun(recorded, 5);
+    idealgas::ReplayLog log;
+    REQUIRE(log.Read(kLogPath));
+    idealgas::GasContainer container = log.CreateContainer(&thread_pool);
+    REQUIRE_FALSE(log.Verify(container).diverged);
+  }
+
+  SECTION("A threaded recording is reproduced serially") {
+    idealgas::GasContainer recorded(particle_configs, glm::vec2(0, 0), 2000, 2000, 7,
+                                    &thread_pool);
+    RecordRun(recorded, 5);
+    idealgas::ReplayLog log;
+    REQUIRE(log.Read(kLogPath));
+    idealgas::GasContainer container = log.CreateContainer();
+    REQUIRE_FALSE(log.Verify(container).diverged);
+  }
+
+  SECTION("A 3D recording is reproduced, and only read as 3D") {
+    idealgas::GasContainer3D recorded(CreateConfigs(), glm::vec3(0), glm::dvec3(300), 7,
+                                      &thread_pool);
+    {
+      idealgas::ReplayRecorder3D recorder(kLogPath, recorded, 1);
+      for (size_t step = 0; step < 100; step++) {
+        recorded.Update();
+        recorder.RecordStep(recorded.GetParticles());
+      }
+      REQUIRE(recorder.IsGood());
+    }
+
+    idealgas::ReplayLog flat_log;
+    REQUIRE_FALSE(flat_log.Read(kLogPath));
+    idealgas::ReplayLog3D log;
+    REQUIRE(log.Read(kLogPath));
+    REQUIRE(log.GetHeader().box_size.z == 300);
+    idealgas::GasContainer3D container = log.CreateContainer();
+    REQUIRE_FALSE(log.Verify(container).diverged);
+  }
+
+  std::remove(kLogPath);
+}
+
+TEST_CASE("Particle hashes mix every component", "[replay]") {
+  idealgas::Particle::Vec position(1.5, 2.5);
+  std::vector<idealgas::Particle> particles {
+          idealgas::Particle(0, position, idealgas::Particle::Vec(1, 0), 1, 1)};
+  uint64_t hash = idealgas::HashParticles(particles, 0, 1);
+
+  // Flipping neighbouring bits of x and y would cancel if the components were shifted and
+  // combined before mixing
+  uint64_t bits = 0;
+  std::memcpy(&bits, &position.x, sizeof(idealgas::Scalar));
+  bits ^= 2;
+  std::memcpy(&position.x, &bits, sizeof(idealgas::Scalar));
+  std::memcpy(&bits, &position.y, sizeof(idealgas::Scalar));
+  bits ^= 1;
+  std::memcpy(&position.y, &bits, sizeof(idealgas::Scalar));
+  particles[0] = idealgas::Particle(0, position, idealgas::Particle::Vec(1, 0), 1, 1);
+  REQUIRE(idealgas::HashParticles(particles, 0, 1) != hash);
+}
+
+TEST_CASE("Replay log pinpoints the divergent particle", "[replay]") {
+  idealgas::GasContainer recorded(CreateConfigs(), glm::vec2(0, 0), 300, 300, 7);
+  RecordRun(recorded, 200);
+
+  idealgas::ReplayLog log;
+  REQUIRE(log.Read(kLogPath));
+
+  // Initial states match because velocities do not depend on mass, but red-blue collisions differ
+  std::vector<idealgas::ParticleConfig> heavier_configs = CreateConfigs();
+  heavier_configs[1].mass = 60;
+  idealgas::GasContainer container(heavier_configs, glm::vec2(0, 0), 300, 300, 7);
+
+  idealgas::ReplayDivergence divergence = log.Verify(container);
+  REQUIRE(divergence.diverged);
+  REQUIRE(divergence.step > 0);
+  REQUIRE(divergence.first_particle == divergence.last_particle);
+
+  // The reported Particle is the first to differ from the recorded run at that step
+  idealgas::GasContainer replayed = log.CreateContainer();
+  idealgas::GasContainer heavier(heavier_configs, glm::vec2(0, 0), 300, 300, 7);
+  for (size_t step = 0; step < divergence.step; step++) {
+    replayed.Update();
+    heavier.Update();
+  }
+  for (size_t i = 0; i < divergence.first_particle; i++) {
+    REQUIRE(replayed.GetParticles()[i].GetVelocity() == heavier.GetParticles()[i].GetVelocity());
+  }
+  REQUIRE(replayed.GetParticles()[divergence.first_particle].GetVelocity() !=
+          heavier.GetParticles()[divergence.first_particle].GetVelocity());
+
+  std::remove(kLogPath);
+}
+
+TEST_CASE("Malformed replay logs are rejected", "[replay]") {
+  idealgas::ReplayLog log;
+  REQUIRE_FALSE(log.Read("missing_replay_log.bin"));
+
+  SECTION("Types past the 8-bit limit") {
+    idealgas::GasContainer recorded(CreateConfigs(), glm::vec2(0, 0), 300, 300, 7);
+    RecordRun(recorded, 1);
+    REQUIRE(log.Read(kLogPath));
+
+    // The first config is its type, three color channels, then radius 10, mass 100 and
+    // amount 40
+    std::ifstream input(kLogPath, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    float radius = 10;
+    double mass = 100;
+    uint64_t amount = 40;
+    std::string config(reinterpret_cast<const char*>(&radius), sizeof(radius));
+    config.append(reinterpret_cast<const char*>(&mass), sizeof(mass));
+    config.append(reinterpret_cast<const char*>(&amount), sizeof(amount));
+    size_t offset = bytes.find(config);
+    REQUIRE(offset != std::string::npos);
+
+    uint64_t type = idealgas::Particle::kMaxTypeCount;
+    offset -= sizeof(type) + 3 * sizeof(float);
+    bytes.replace(offset, sizeof(type), reinterpret_cast<const char*>(&type), sizeof(type));
+    std::ofstream(kLogPath, std::ios::binary) << bytes;
+    REQUIRE_FALSE(log.Read(kLogPath));
+    std::remove(kLogPath);
+  }
+}
@@ -0,0 +1,99 @@
+#include <core/snapshot_publisher.h>
+
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Snapshot publishing", "[snapshot]") {
+  SECTION("Nothing is published before the first step") {
+    idealgas::SnapshotPublisher publisher;
+    REQUIRE(publisher.Acquire().IsValid() == false);
+  }
+
+  SECTION("Readers see the latest published step") {
+    idealgas::SnapshotPublisher publisher;
+    for (size_t step = 1; step <= 3; step++) {
+      idealgas::SimulationSnapshot* snapshot = publisher.BeginPublish();
+      REQUIRE(snapshot != nullptr);
+      snapshot->step = step;
+      publisher.EndPublish();
+    }
+    REQUIRE(publisher.Acquire()->step == 3);
+  }
+
+  SECTION("Pinned snapshots are never overwritten") {
+    idealgas::SnapshotPublisher publisher(3);
+    publisher.BeginPublish()->step = 1;
+    publisher.EndPublish();
+    idealgas::SnapshotPublisher::View first = publisher.Acquire();
+
+    publisher.BeginPublish()->step = 2;
+    publisher.EndPublish();
+    idealgas::SnapshotPublisher::View second = publisher.Acquire();
+
+    publisher.BeginPublish()->step = 3;
+    publisher.EndPublish();
+
+    // Of three buffers, one is current and the other two are pinned
+    REQUIRE(publisher.BeginPublish() == nullptr);
+    REQUIRE(publisher.GetDroppedCount() == 1);
+    REQUIRE(first->step == 1);
+    REQUIRE(second->step == 2);
+    REQUIRE(publisher.Acquire()->step == 3);
+  }
+}
+
+TEST_CASE("Snapshot publishing with concurrent readers", "[snapshot][thread]") {
+  // Build with IDEALGAS_SANITIZE_THREAD to run this under ThreadSanitizer
+  const size_t kSteps = 5000;
+  const size_t kParticles = 256;
+  const size_t kReaders = 4;
+  idealgas::SnapshotPublisher publisher;
+  std::atomic<bool> writing(true);
+  std::atomic<size_t> inconsistent_views(0);
+
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < kReaders; i++) {
+    readers.emplace_back([&]() {
+      size_t last_step = 0;
+      while (writing.load()) {
+        idealgas::SnapshotPublisher::View view = publisher.Acquire();
+        if (!view.IsValid()) {
+          continue;
+        }
+
+        // Every value written for a step equals the step, so a torn read shows up as a mismatch
+        bool consistent = view->step >= last_step && view->positions.size() == kParticles;
+        for (const idealgas::Particle::Vec& position : view->positions) {
+          consistent = consistent && position.x == idealgas::Scalar(view->step);
+        }
+        for (size_t frequency : view->speed_frequencies[0]) {
+          consistent = consistent && frequency == view->step;
+        }
+        if (!consistent) {
+          inconsistent_views++;
+        }
+        last_step = view->step;
+      }
+    });
+  }
+
+  for (size_t step = 1; step <= kSteps; step++) {
+    idealgas::SimulationSnapshot* snapshot = publisher.BeginPublish();
+    if (snapshot == nullptr) {
+      continue;
+    }
+    snapshot->step = step;
+    snapshot->positions.assign(kParticles, idealgas::Particle::Vec(step, 0));
+    snapshot->velocities.assign(kParticles, idealgas::Particle::Vec(0, step));
+    snapshot->speed_frequencies.assign(1, std::vector<size_t>(8, step));
+    publisher.EndPublish();
+  }
+  writing = false;
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+
+  REQUIRE(inconsistent_views == 0);
+  REQUIRE(publisher.Acquire().IsValid());
+}
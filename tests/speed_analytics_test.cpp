@@ -0,0 +1,93 @@
+#include <core/speed_analytics.h>
+
+#include <random>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**
+ * Generates Particles with 2D Maxwell-Boltzmann velocities: normal components of variance kT / m
+ */
+std::vector<idealgas::Particle> GenerateMaxwellBoltzmann(std::mt19937& generator, size_t count,
+                                                         double temperature, double mass) {
+  std::normal_distribution<double> component(0, std::sqrt(temperature / mass));
+  std::vector<idealgas::Particle> particles;
+  for (size_t i = 0; i < count; i++) {
+    particles.emplace_back(0, glm::vec2(0, 0),
+                           glm::vec2(component(generator), component(generator)),
+                           1, mass);
+  }
+  return particles;
+}
+
+}  // namespace
+
+TEST_CASE("Maxwell-Boltzmann fit", "[analytics]") {
+  std::mt19937 generator(1);
+  idealgas::SpeedAnalyticsSettings settings;
+  settings.window_size = 50;
+
+  SECTION("Maxwell-Boltzmann speeds fit and are detected as equilibrated") {
+    idealgas::SpeedAnalytics analytics(1, settings);
+    for (size_t step = 0; step < 50; step++) {
+      analytics.Update(GenerateMaxwellBoltzmann(generator, 1000, 4, 2));
+    }
+
+    REQUIRE(analytics.GetFit(0).temperature == Approx(4).epsilon(0.1));
+    REQUIRE(analytics.GetFit(0).count == 1000);
+    REQUIRE(analytics.GetWindowedChiSquaredPerDof() < settings.max_chi_squared_per_dof);
+    REQUIRE(analytics.IsEquilibrated());
+    REQUIRE(analytics.GetEquilibriumStep() == 50);
+  }
+
+  SECTION("Equal speeds do not fit") {
+    std::vector<idealgas::Particle> particles;
+    for (size_t i = 0; i < 1000; i++) {
+      double angle = 0.01 * i;
+      particles.emplace_back(0, glm::vec2(0, 0), glm::vec2(std::cos(angle), std::sin(angle)),
+                             1, 1);
+    }
+
+    idealgas::SpeedAnalytics analytics(1, settings);
+    for (size_t step = 0; step < 100; step++) {
+      analytics.Update(particles);
+    }
+    REQUIRE(analytics.GetWindowedChiSquaredPerDof() > 10);
+    REQUIRE_FALSE(analytics.IsEquilibrated());
+  }
+
+  SECTION("Adaptive speed interval covers the thermal range") {
+    idealgas::SpeedAnalytics analytics(1, settings);
+    analytics.Update(GenerateMaxwellBoltzmann(generator, 10000, 2, 1));
+    // 3 * sqrt(2 * 2 / 1) / 8 = 0.75, rounded up to a multiple of 0.1
+    REQUIRE(analytics.GetAdaptiveSpeedInterval(0, 8) == Approx(0.8));
+  }
+
+  SECTION("A fit on a ThreadPool matches the serial fit exactly") {
+    std::vector<idealgas::Particle> particles = GenerateMaxwellBoltzmann(generator, 50000, 3, 1);
+    idealgas::ThreadPool thread_pool(4);
+    idealgas::SpeedAnalytics serial(1, settings);
+    idealgas::SpeedAnalytics parallel(1, settings);
+    serial.Update(particles);
+    parallel.Update(particles, &thread_pool);
+
+    REQUIRE(parallel.GetFit(0).count == 50000);
+    REQUIRE(parallel.GetFit(0).temperature == serial.GetFit(0).temperature);
+    REQUIRE(parallel.GetFit(0).chi_squared == serial.GetFit(0).chi_squared);
+    REQUIRE(parallel.GetWindowedChiSquaredPerDof() == serial.GetWindowedChiSquaredPerDof());
+  }
+}
+
+TEST_CASE("Headless run stops at equilibrium", "[analytics]") {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 5, 100, 200),
+          idealgas::ParticleConfig(1, "blue", 5, 50, 200)};
+  idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 600, 600, 4);
+  idealgas::SpeedAnalytics analytics(2);
+
+  size_t steps = idealgas::RunUntilEquilibrium(container, analytics, 20000);
+  REQUIRE(analytics.IsEquilibrated());
+  REQUIRE(steps == analytics.GetEquilibriumStep());
+  REQUIRE(steps < 20000);
+}
@@ -0,0 +1,147 @@
+#include <core/gas_container.h>
+
+#include <sstream>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Static geometry config", "[static-geometry]") {
+  idealgas::StaticGeometry static_geometry;
+
+  SECTION("Every shape is read") {
+    std::istringstream config("# effusion box\n"
+                              "segment 0 0 10 0\n"
+                              "\n"
+                              "circle 5 5 2\n"
+                              "polygon 0 0 4 0 4 4\n"
+                              "piston 0 10 10 10 0 -0.5 4\n");
+    REQUIRE(static_geometry.Load(config));
+    REQUIRE(static_geometry.GetObstacles().size() == 5);
+    REQUIRE(static_geometry.GetObstacles()[1].shape == idealgas::Obstacle::kCircle);
+    REQUIRE(static_geometry.GetObstacles()[1].radius == 2);
+    REQUIRE(static_geometry.GetPistons().size() == 1);
+    REQUIRE(static_geometry.GetPistons()[0].velocity.y == -0.5);
+  }
+
+  SECTION("Malformed lines are rejected") {
+    std::istringstream missing_value("segment 0 0 10\n");
+    REQUIRE_FALSE(static_geometry.Load(missing_value));
+    std::istringstream extra_value("circle 5 5 2 7\n");
+    REQUIRE_FALSE(static_geometry.Load(extra_value));
+    std::istringstream unknown_shape("triangle 0 0 1 1 2 2\n");
+    REQUIRE_FALSE(static_geometry.Load(unknown_shape));
+    std::istringstream two_corners("polygon 0 0 4 0\n");
+    REQUIRE_FALSE(static_geometry.Load(two_corners));
+    std::istringstream odd_coordinates("polygon 0 0 4 0 4 4 7\n");
+    REQUIRE_FALSE(static_geometry.Load(odd_coordinates));
+    REQUIRE(static_geometry.GetObstacles().empty());
+  }
+}
+
+TEST_CASE("Static geometry reflection", "[static-geometry]") {
+  idealgas::StaticGeometry static_geometry;
+  static_geometry.AddSegment(glm::dvec2(50, 0), glm::dvec2(50, 100));
+  static_geometry.AddCircle(glm::dvec2(20, 20), 5);
+  static_geometry.Bake(glm::dvec2(0, 0), 100, 100, 2);
+
+  SECTION("Particles moving into a segment bounce off it") {
+    idealgas::Particle particle(0, glm::vec2(48.5, 50), glm::vec2(1, 0.5), 2, 1);
+    REQUIRE(static_geometry.Collide(particle, nullptr) == 1);
+    REQUIRE(particle.GetVelocity() == idealgas::Particle::Vec(-1, 0.5));
+  }
+
+  SECTION("Particles moving away from a segment do not bounce") {
+    idealgas::Particle particle(0, glm::vec2(51.5, 50), glm::vec2(1, 0), 2, 1);
+    REQUIRE(static_geometry.Collide(particle, nullptr) == 0);
+    REQUIRE(particle.GetVelocity() == idealgas::Particle::Vec(1, 0));
+  }
+
+  SECTION("Particles bounce off circles along the line of centers") {
+    idealgas::Particle particle(0, glm::vec2(20, 26.5), glm::vec2(0.5, -1), 2, 1);
+    REQUIRE(static_geometry.Collide(particle, nullptr) == 1);
+    REQUIRE(particle.GetVelocity() == idealgas::Particle::Vec(0.5, 1));
+  }
+
+  SECTION("Particles far from every obstacle are untouched") {
+    idealgas::Particle particle(0, glm::vec2(80, 80), glm::vec2(-1, -1), 2, 1);
+    REQUIRE(static_geometry.Collide(particle, nullptr) == 0);
+  }
+}
+
+TEST_CASE("Static geometry in a GasContainer", "[static-geometry]") {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 3, 10, 100)};
+
+  SECTION("A partition keeps the two halves apart") {
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 200, 100, 2);
+    idealgas::StaticGeometry static_geometry;
+    static_geometry.AddSegment(glm::dvec2(100, 0), glm::dvec2(100, 100));
+    container.SetStaticGeometry(static_geometry);
+
+    std::vector<bool> starts_left;
+    for (const idealgas::Particle& particle : container.GetParticles()) {
+      starts_left.push_back(particle.GetPosition().x < 100);
+    }
+    for (size_t step = 0; step < 500; step++) {
+      container.Update();
+    }
+
+    // Particles placed across the partition may end up on either side
+    for (size_t i = 0; i < starts_left.size(); i++) {
+      double x = container.GetParticles()[i].GetPosition().x;
+      if (std::abs(x - 100) > 3) {
+        REQUIRE((x < 100) == starts_left[i]);
+      }
+    }
+    REQUIRE(container.GetCollisionCounts().obstacle_bounces > 0);
+  }
+
+  SECTION("A moving piston compresses and heats the gas") {
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 200, 200, 2);
+    idealgas::StaticGeometry static_geometry;
+    idealgas::Piston piston;
+    piston.start = glm::dvec2(0, 200);
+    piston.end = glm::dvec2(200, 200);
+    piston.velocity = glm::dvec2(0, -0.2);
+    piston.travel = 100;
+    static_geometry.AddPiston(piston);
+    container.SetStaticGeometry(static_geometry);
+
+    double initial_energy = container.GetKineticEnergy();
+    for (size_t step = 0; step < 500; step++) {
+      container.Update();
+    }
+    const idealgas::Piston& compressed = container.GetStaticGeometry().GetPistons()[0];
+    REQUIRE(compressed.moved == Approx(100));
+    REQUIRE(compressed.start.y == Approx(100));
+    REQUIRE(compressed.GetPressure() > 0);
+    REQUIRE(container.GetKineticEnergy() > initial_energy);
+
+    container.ResetPistonImpulses();
+    REQUIRE(container.GetStaticGeometry().GetPistons()[0].GetPressure() == 0);
+  }
+
+  SECTION("Shrinking the box cuts the geometry at the new walls") {
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 200, 200, 2);
+    idealgas::StaticGeometry static_geometry;
+    static_geometry.AddSegment(glm::dvec2(20, 50), glm::dvec2(180, 50));
+    static_geometry.AddSegment(glm::dvec2(150, 100), glm::dvec2(190, 100));
+    static_geometry.AddCircle(glm::dvec2(60, 150), 10);
+    static_geometry.AddCircle(glm::dvec2(120, 150), 10);
+    container.SetStaticGeometry(static_geometry);
+
+    REQUIRE(container.ResizeBox(glm::dvec2(100, 200)));
+    const std::vector<idealgas::Obstacle>& obstacles =
+            container.GetStaticGeometry().GetObstacles();
+    REQUIRE(obstacles.size() == 2);
+    REQUIRE(obstacles[0].start.x == 20);
+    REQUIRE(obstacles[0].end.x == Approx(100));
+    REQUIRE(obstacles[1].start.x == 60);
+
+    for (size_t step = 0; step < 200; step++) {
+      container.Update();
+    }
+    for (const idealgas::Particle& particle : container.GetParticles()) {
+      REQUIRE(particle.GetPosition().x <= 100);
+    }
+  }
+}
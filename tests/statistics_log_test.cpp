@@ -0,0 +1,148 @@
+#include <core/statistics_log.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+const char kLogPath[] = "statistics_log_test.bin";
+
+idealgas::StepStatistics CreateStatistics(uint64_t step) {
+  idealgas::StepStatistics statistics;
+  statistics.step = step;
+  statistics.kinetic_energy = 0.5 * step;
+  statistics.particle_collisions = 10 * step;
+  statistics.wall_bounces = 20 * step;
+  statistics.obstacle_bounces = 30 * step;
+  statistics.temperatures = {1.5 + step, 2.5 + step};
+  statistics.speed_intervals = {0.25, 0.75};
+  statistics.speed_frequencies = {{step, step + 1, step + 2}, {step * 2, 0, 7}};
+  return statistics;
+}
+
+}  // namespace
+
+TEST_CASE("Statistics log schema", "[statistics]") {
+  std::vector<idealgas::ColumnSchema> schema = idealgas::MakeStatisticsSchema(2, 3);
+  REQUIRE(schema.size() == 11);
+  REQUIRE(schema[0].name == "step");
+  REQUIRE(schema[0].type == idealgas::ColumnSchema::kUInt64);
+  REQUIRE(schema[1].name == "kinetic_energy");
+  REQUIRE(schema[1].type == idealgas::ColumnSchema::kFloat64);
+  REQUIRE(schema[4].name == "obstacle_bounces");
+  REQUIRE(schema[5].name == "temperature_0");
+  REQUIRE(schema[6].name == "speed_interval_0");
+  REQUIRE(schema[7].name == "speed_frequencies_0");
+  REQUIRE(schema[7].type == idealgas::ColumnSchema::kUInt64);
+  REQUIRE(schema[7].width == 3);
+  REQUIRE(schema[10].name == "speed_frequencies_1");
+
+  SECTION("The schema is read back from the file") {
+    {
+      idealgas::StatisticsWriter writer(kLogPath, 2, 3);
+      REQUIRE(writer.IsGood());
+    }
+    idealgas::StatisticsReader reader;
+    REQUIRE(reader.Read(kLogPath));
+    REQUIRE(reader.GetSchema().size() == schema.size());
+    for (size_t column = 0; column < schema.size(); column++) {
+      REQUIRE(reader.GetSchema()[column].name == schema[column].name);
+      REQUIRE(reader.GetSchema()[column].type == schema[column].type);
+      REQUIRE(reader.GetSchema()[column].width == schema[column].width);
+    }
+    REQUIRE(reader.GetRowGroupCount() == 0);
+    REQUIRE(reader.FindColumn("wall_bounces") == 3);
+    REQUIRE(reader.FindColumn("pressure") == schema.size());
+    std::remove(kLogPath);
+  }
+}
+
+TEST_CASE("Statistics log round trip", "[statistics]") {
+  {
+    // 7 rows in groups of 3
+    idealgas::StatisticsWriter writer(kLogPath, 2, 3, 3);
+    for (uint64_t step = 1; step <= 7; step++) {
+      writer.Append(CreateStatistics(step));
+    }
+    writer.Close();
+    REQUIRE(writer.IsGood());
+    writer.Append(CreateStatistics(8));
+  }
+
+  idealgas::StatisticsReader reader;
+  REQUIRE(reader.Read(kLogPath));
+  REQUIRE(reader.GetRowGroupCount() == 3);
+  REQUIRE(reader.GetRowCount(0) == 3);
+  REQUIRE(reader.GetRowCount(2) == 1);
+  REQUIRE(reader.GetRowCount() == 7);
+#ifndef _WIN32
+  REQUIRE(reader.IsMapped());
+#endif
+
+  uint64_t step = 1;
+  for (size_t group = 0; group < reader.GetRowGroupCount(); group++) {
+    const uint64_t* steps = reader.GetUInt64Column(group, reader.FindColumn("step"));
+    const double* energies = reader.GetFloat64Column(group, reader.FindColumn("kinetic_energy"));
+    const double* temperatures = reader.GetFloat64Column(group,
+                                                         reader.FindColumn("temperature_1"));
+    const uint64_t* frequencies = reader.GetUInt64Column(
+            group, reader.FindColumn("speed_frequencies_0"));
+    REQUIRE(reinterpret_cast<uintptr_t>(frequencies) % alignof(uint64_t) == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(energies) % alignof(double) == 0);
+
+    for (size_t row = 0; row < reader.GetRowCount(group); row++, step++) {
+      REQUIRE(steps[row] == step);
+      REQUIRE(energies[row] == 0.5 * step);
+      REQUIRE(temperatures[row] == 2.5 + step);
+      REQUIRE(frequencies[3 * row] == step);
+      REQUIRE(frequencies[3 * row + 2] == step + 2);
+    }
+  }
+  REQUIRE(step == 8);
+
+  // A column is only returned as its own type
+  REQUIRE(reader.GetFloat64Column(0, reader.FindColumn("step")) == nullptr);
+  REQUIRE(reader.GetUInt64Column(0, reader.FindColumn("kinetic_energy")) == nullptr);
+  std::remove(kLogPath);
+}
+
+TEST_CASE("Statistics log rejects damaged files", "[statistics]") {
+  {
+    idealgas::StatisticsWriter writer(kLogPath, 1, 4, 2);
+    for (uint64_t step = 1; step <= 5; step++) {
+      writer.Append(CreateStatistics(step));
+    }
+  }
+  std::ifstream input(kLogPath, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+  input.close();
+
+  idealgas::StatisticsReader reader;
+  REQUIRE(reader.Read(kLogPath));
+  REQUIRE(reader.GetRowCount() == 5);
+  REQUIRE_FALSE(reader.Read("missing_statistics_log.bin"));
+  REQUIRE_FALSE(reader.IsMapped());
+
+  SECTION("Truncated") {
+    std::ofstream(kLogPath, std::ios::binary) << contents.substr(0, contents.size() - 20);
+    REQUIRE_FALSE(reader.Read(kLogPath));
+  }
+
+  SECTION("Row groups past the footer") {
+    // The footer ends with 3 (offset, rows) entries, the footer offset and the magic,
+    // so this sets the top byte of the row count of the first group
+    std::string damaged = contents;
+    damaged[damaged.size() - 16 - 3 * 16 + 15] = 0x7f;
+    std::ofstream(kLogPath, std::ios::binary) << damaged;
+    REQUIRE_FALSE(reader.Read(kLogPath));
+  }
+
+  SECTION("Not a statistics log") {
+    std::ofstream(kLogPath, std::ios::binary) << std::string(contents.size(), 'x');
+    REQUIRE_FALSE(reader.Read(kLogPath));
+  }
+  std::remove(kLogPath);
+}
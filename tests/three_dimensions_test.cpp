@@ -0,0 +1,160 @@
+#include <core/observables.h>
+#include <core/speed_analytics.h>
+
+#include <random>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+std::vector<idealgas::ParticleConfig> MakeConfigs() {
+  return {idealgas::ParticleConfig(0, "red", 20, 100, 40),
+          idealgas::ParticleConfig(1, "blue", 10, 50, 40),
+          idealgas::ParticleConfig(2, "green", 4, 5, 40)};
+}
+
+}  // namespace
+
+TEST_CASE("3D Particles", "[particle][3d]") {
+  SECTION("Walls along z negate z velocity") {
+    idealgas::Particle3D particle(0, glm::vec3(5, 5, 9.5), glm::vec3(1, 2, 3), 1, 1);
+    REQUIRE_FALSE(particle.ProcessWallCollision(0, 10));
+    REQUIRE(particle.ProcessWallCollision(2, 10));
+    REQUIRE(particle.GetVelocity() == idealgas::Particle3D::Vec(1, 2, -3));
+  }
+
+  SECTION("Head on collision along z swaps equal masses' velocities") {
+    idealgas::Particle3D particle_a(0, glm::vec3(0, 0, 0), glm::vec3(0, 0, 1), 1, 1);
+    idealgas::Particle3D particle_b(0, glm::vec3(0, 0, 1.5), glm::vec3(0, 0, -1), 1, 1);
+    REQUIRE(idealgas::CheckCollision(particle_a, particle_b));
+    idealgas::CollideParticles(particle_a, particle_b);
+    REQUIRE(particle_a.GetVelocity().z == Approx(-1));
+    REQUIRE(particle_b.GetVelocity().z == Approx(1));
+    REQUIRE(particle_a.GetVelocity().x == 0);
+  }
+
+  SECTION("Particles apart along z do not collide") {
+    idealgas::Particle3D particle_a(0, glm::vec3(0, 0, 0), glm::vec3(0, 0, 1), 1, 1);
+    idealgas::Particle3D particle_b(0, glm::vec3(0, 0, 2.5), glm::vec3(0, 0, -1), 1, 1);
+    REQUIRE_FALSE(idealgas::CheckCollision(particle_a, particle_b));
+  }
+}
+
+TEST_CASE("3D neighbor list matches brute force", "[neighbor-list][3d]") {
+  idealgas::GasContainer3D brute_force(MakeConfigs(), glm::vec3(0), glm::dvec3(200), 3);
+  idealgas::GasContainer3D neighbor_listed(MakeConfigs(), glm::vec3(0), glm::dvec3(200), 3);
+  brute_force.SetNeighborSkin(0);
+  neighbor_listed.SetNeighborSkin(20);
+  neighbor_listed.SetTiledKernelThreshold(0);
+
+  SECTION("Every pair within reach is listed once, in ascending order") {
+    const std::vector<idealgas::Particle3D>& particles = neighbor_listed.GetParticles();
+    idealgas::NeighborList3D neighbor_list(2);
+    neighbor_list.Build(particles);
+    for (size_t i = 0; i < particles.size(); i++) {
+      std::vector<size_t> expected;
+      for (size_t j = i + 1; j < particles.size(); j++) {
+        glm::dvec3 displacement = glm::dvec3(particles[i].GetPosition()) -
+                                  glm::dvec3(particles[j].GetPosition());
+        double cutoff = double(particles[i].GetRadius()) + particles[j].GetRadius() + 2;
+        if (glm::dot(displacement, displacement) <= cutoff * cutoff) {
+          expected.push_back(j);
+        }
+      }
+      REQUIRE(std::vector<size_t>(neighbor_list.NeighborsBegin(i),
+                                  neighbor_list.NeighborsEnd(i)) == expected);
+    }
+    REQUIRE(neighbor_list.GetStats().level_count > 1);
+  }
+
+  SECTION("Trajectories are identical") {
+    for (size_t step = 0; step < 200; step++) {
+      brute_force.Update();
+      neighbor_listed.Update();
+    }
+    for (size_t i = 0; i < brute_force.GetParticles().size(); i++) {
+      REQUIRE(brute_force.GetParticles()[i].GetPosition() ==
+              neighbor_listed.GetParticles()[i].GetPosition());
+    }
+    REQUIRE(brute_force.GetCollisionCounts().particle_collisions > 0);
+    REQUIRE(neighbor_listed.GetNeighborListStats().rebuilds < 200);
+  }
+}
+
+TEST_CASE("3D gas container", "[gas-container][3d]") {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 5, 10, 100),
+          idealgas::ParticleConfig(1, "blue", 3, 2, 100)};
+  idealgas::GasContainer3D container(particle_configs, glm::vec3(10, 20, 30),
+                                     glm::dvec3(150, 200, 250), 7);
+  REQUIRE(container.GetParticles().size() == 200);
+  REQUIRE(container.GetBoxWidth() == 150);
+  REQUIRE(container.GetBoxHeight() == 200);
+
+  SECTION("Elastic collisions and walls conserve energy") {
+    double initial_energy = container.GetKineticEnergy();
+    for (size_t step = 0; step < 500; step++) {
+      container.Update();
+    }
+    REQUIRE(container.GetKineticEnergy() == Approx(initial_energy).epsilon(1e-4));
+    REQUIRE(container.GetCollisionCounts().particle_collisions > 0);
+    REQUIRE(container.GetCollisionCounts().wall_bounces > 0);
+  }
+
+  SECTION("A lone Particle bounces between the walls of every axis") {
+    std::vector<idealgas::ParticleConfig> lone_config {
+            idealgas::ParticleConfig(0, "red", 10, 1, 1)};
+    idealgas::GasContainer3D lone(lone_config, glm::vec3(0), glm::dvec3(40, 50, 60), 3);
+    for (size_t step = 0; step < 2000; step++) {
+      lone.Update();
+      const idealgas::Particle3D& particle = lone.GetParticles()[0];
+      for (int axis = 0; axis < 3; axis++) {
+        REQUIRE(particle.GetPosition()[axis] >= -particle.GetRadius());
+        REQUIRE(particle.GetPosition()[axis] <= lone.GetBoxSize()[axis] + particle.GetRadius());
+      }
+    }
+    REQUIRE(lone.GetCollisionCounts().wall_bounces >= 6);
+  }
+
+  SECTION("Static geometry is ignored") {
+    idealgas::StaticGeometry static_geometry;
+    static_geometry.AddCircle(glm::dvec2(50, 50), 10);
+    container.SetStaticGeometry(static_geometry);
+    REQUIRE(container.GetStaticGeometry().IsEmpty());
+  }
+}
+
+TEST_CASE("3D Maxwell-Boltzmann fit", "[analytics][3d]") {
+  std::mt19937 generator(2);
+  idealgas::SpeedAnalyticsSettings settings;
+  settings.window_size = 50;
+
+  SECTION("Maxwell-Boltzmann speeds fit with kT of two thirds the mean energy") {
+    std::normal_distribution<double> component(0, std::sqrt(4.0 / 2));
+    idealgas::SpeedAnalytics analytics(1, settings);
+    for (size_t step = 0; step < 50; step++) {
+      std::vector<idealgas::Particle3D> particles;
+      for (size_t i = 0; i < 1000; i++) {
+        particles.emplace_back(0, glm::vec3(0),
+                               glm::vec3(component(generator), component(generator),
+                                         component(generator)),
+                               1, 2);
+      }
+      analytics.Update(particles);
+    }
+
+    REQUIRE(analytics.GetFit(0).temperature == Approx(4).epsilon(0.1));
+    REQUIRE(analytics.GetWindowedChiSquaredPerDof() < settings.max_chi_squared_per_dof);
+    REQUIRE(analytics.IsEquilibrated());
+  }
+
+  SECTION("A 3D gas relaxes to equilibrium") {
+    std::vector<idealgas::ParticleConfig> particle_configs {
+            idealgas::ParticleConfig(0, "red", 4, 1, 400)};
+    idealgas::GasContainer3D container(particle_configs, glm::vec3(0), glm::dvec3(150), 5);
+    idealgas::SpeedAnalytics analytics(1, settings);
+    size_t steps = idealgas::RunUntilEquilibrium(container, analytics, 5000);
+    REQUIRE(analytics.IsEquilibrated());
+    REQUIRE(steps < 5000);
+  }
+}
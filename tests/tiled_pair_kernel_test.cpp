@@ -0,0 +1,143 @@
+#include <core/gas_container.h>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**
+ * @return Every pair within the sum of radii, found by the loop over all pairs
+ */
+template <int D>
+std::vector<std::pair<size_t, size_t>> FindTouchingPairs(
+        const std::vector<idealgas::BasicParticle<idealgas::Scalar, D>>& particles) {
+  std::vector<std::pair<size_t, size_t>> pairs;
+  for (size_t i = 0; i < particles.size(); i++) {
+    for (size_t j = i + 1; j < particles.size(); j++) {
+      if (glm::distance(particles[i].GetPosition(), particles[j].GetPosition()) <=
+          particles[i].GetRadius() + particles[j].GetRadius()) {
+        pairs.emplace_back(i, j);
+      }
+    }
+  }
+  return pairs;
+}
+
+/**
+ * Checks that the kernel finds every touching pair of a crowded gas spanning several tiles,
+ * in the order of the loop over all pairs
+ */
+template <int D>
+void CheckMatchesLoop() {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 8, 100, 500),
+          idealgas::ParticleConfig(1, "blue", 3, 50, 700)};
+  idealgas::BasicGasContainer<D> container(particle_configs, glm::vec<D, float>(0),
+                                           glm::vec<D, double>(D == 2 ? 400 : 120), 9);
+  const std::vector<idealgas::BasicParticle<idealgas::Scalar, D>>& particles =
+          container.GetParticles();
+
+  idealgas::BasicTiledPairKernel<D> kernel;
+  kernel.FindPairs(particles);
+  std::vector<std::pair<size_t, size_t>> expected = FindTouchingPairs<D>(particles);
+  REQUIRE(expected.size() > 100);
+
+  // Any extra pair is only just beyond touching
+  std::vector<std::pair<size_t, size_t>> touching;
+  for (const std::pair<size_t, size_t>& pair : kernel.GetPairs()) {
+    double distance = glm::distance(particles[pair.first].GetPosition(),
+                                    particles[pair.second].GetPosition());
+    double radii = particles[pair.first].GetRadius() + particles[pair.second].GetRadius();
+    REQUIRE(distance <= radii * 1.001);
+    if (distance <= radii) {
+      touching.push_back(pair);
+    }
+  }
+  REQUIRE(std::is_sorted(kernel.GetPairs().begin(), kernel.GetPairs().end()));
+  REQUIRE(touching == expected);
+}
+
+/**
+ * Checks that a gas stepped with the tiled kernel follows the neighbour list exactly
+ */
+template <int D>
+void CheckMatchesNeighborList(bool dense_gas_mode) {
+  std::vector<idealgas::ParticleConfig> particle_configs {
+          idealgas::ParticleConfig(0, "red", 4, 100, 200),
+          idealgas::ParticleConfig(1, "blue", 2, 50, 200)};
+  idealgas::BasicGasContainer<D> tiled(particle_configs, glm::vec<D, float>(0),
+                                       glm::vec<D, double>(D == 2 ? 300 : 90), 4);
+  idealgas::BasicGasContainer<D> neighbor_listed = tiled;
+  neighbor_listed.SetNeighborSkin(8);
+  neighbor_listed.SetTiledKernelThreshold(0);
+  tiled.SetDenseGasMode(dense_gas_mode);
+  neighbor_listed.SetDenseGasMode(dense_gas_mode);
+  REQUIRE(tiled.UsesTiledKernel());
+  REQUIRE_FALSE(neighbor_listed.UsesTiledKernel());
+
+  for (size_t step = 0; step < 100; step++) {
+    tiled.Update();
+    neighbor_listed.Update();
+  }
+  for (size_t i = 0; i < tiled.GetParticles().size(); i++) {
+    REQUIRE(tiled.GetParticles()[i].GetPosition() ==
+            neighbor_listed.GetParticles()[i].GetPosition());
+    REQUIRE(tiled.GetParticles()[i].GetVelocity() ==
+            neighbor_listed.GetParticles()[i].GetVelocity());
+  }
+  REQUIRE(tiled.GetCollisionCounts().particle_collisions ==
+          neighbor_listed.GetCollisionCounts().particle_collisions);
+  REQUIRE(tiled.GetCollisionCounts().particle_collisions > 0);
+  REQUIRE(tiled.GetNeighborListStats().updates == 0);
+}
+
+}  // namespace
+
+TEST_CASE("Tiled pair kernel finds every touching pair", "[tiled-kernel]") {
+  SECTION("2D") {
+    CheckMatchesLoop<2>();
+  }
+
+  SECTION("3D") {
+    CheckMatchesLoop<3>();
+  }
+
+  SECTION("No Particles") {
+    idealgas::TiledPairKernel kernel;
+    kernel.FindPairs(std::vector<idealgas::Particle>());
+    REQUIRE(kernel.GetPairs().empty());
+  }
+}
+
+TEST_CASE("Tiled pair kernel in a GasContainer", "[tiled-kernel][gas-container]") {
+  SECTION("Trajectories match the neighbour list") {
+    CheckMatchesNeighborList<2>(false);
+    CheckMatchesNeighborList<3>(false);
+  }
+
+  SECTION("Trajectories match the neighbour list in dense gas mode") {
+    CheckMatchesNeighborList<2>(true);
+    CheckMatchesNeighborList<3>(true);
+  }
+
+  SECTION("Selected below the threshold or without a skin") {
+    std::vector<idealgas::ParticleConfig> particle_configs {
+            idealgas::ParticleConfig(0, "red", 1, 1, 100)};
+    idealgas::GasContainer container(particle_configs, glm::vec2(0, 0), 100, 100, 1);
+    REQUIRE(container.UsesTiledKernel());
+
+    container.SetTiledKernelThreshold(100);
+    REQUIRE_FALSE(container.UsesTiledKernel());
+    container.SetTiledKernelThreshold(101);
+    REQUIRE(container.UsesTiledKernel());
+
+    // Setting the skin keeps the threshold
+    container.SetNeighborSkin(2);
+    REQUIRE(container.GetTiledKernelThreshold() == 101);
+    REQUIRE(container.UsesTiledKernel());
+    container.SetTiledKernelThreshold(0);
+    REQUIRE_FALSE(container.UsesTiledKernel());
+    container.SetNeighborSkin(0);
+    REQUIRE(container.UsesTiledKernel());
+    REQUIRE(container.GetTiledKernelThreshold() == 0);
+  }
+}